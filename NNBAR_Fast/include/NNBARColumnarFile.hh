@@ -0,0 +1,652 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARColumnarFile.hh
+/// \brief Definition of the NNBARColumnarFileWriter and NNBARColumnarFileReader classes
+
+#ifndef NNBAR_COLUMNAR_FILE_H
+#define NNBAR_COLUMNAR_FILE_H
+
+// This header does not depend on Geant4: it is shared by NNBAROutput, the
+// ROOT converter (nnbar_columnar.C) and the readers of the files.
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// The columnar output format.
+///
+/// A file holds the ntuples of NNBAROutput as columns. Every column is a
+/// jagged array (a vector of values per event), stored in chunks of events:
+/// per chunk and column, an offsets array (events + 1 entries, the values of
+/// event i are [offsets[i], offsets[i+1]) ) and the values, both contiguous,
+/// little-endian and aligned to 64 bytes, so a reader can map the file and
+/// loop over the values directly. The values of a chunk are stored plain, or
+/// encoded when it is smaller: a constant (one value), a dictionary (the
+/// distinct values and an u8 index per value) or, for the floating point
+/// columns declared with a range and a scale, fixed point (u16 or u32,
+/// value = minimum + scale * stored). Layout:
+///   header: "NNBARCOL", u32 version, u32 ntuples, per ntuple its name and
+///           u32 columns, per column its name, u32 type, u32 encoding and
+///           f64 minimum, maximum and scale of the fixed point
+///           (strings as u32 length and characters)
+///   chunks: per column the offsets (u64) and the values
+///   index:  u64 chunks, per chunk u64 first event, u64 events, and per
+///           column u64 offsets position, u64 values position, u64 values,
+///           u64 encoding and u64 stored entries (e.g. of the dictionary)
+///   trailer: u64 index position, "NNBARIDX"
+/// The files of version 1 (plain columns only, no encoding in the header and
+/// the index) are read as well.
+struct NNBARColumnarFormat {
+  /// The type of the values of a column.
+  enum Type : std::uint32_t { eInt32 = 1, eFloat64 = 2, eFloat32 = 3 };
+
+  /// The encoding of the values of a column in a chunk.
+  enum Encoding : std::uint32_t { ePlain = 0, eConstant = 1, eDictionary = 2, eFixed16 = 3, eFixed32 = 4 };
+
+  /// The version of the format.
+  static const std::uint32_t fVersion = 2;
+
+  /// The largest dictionary (the indices are u8).
+  static const std::size_t fMaxDictionary = 256;
+
+  /// The alignment of the arrays (in bytes).
+  static const std::uint64_t fAlignment = 64;
+
+  /// The size of a value of a type (in bytes).
+  static inline std::size_t SizeOf( Type aType ) {
+    switch ( aType ) {
+      case eInt32   : return 4;
+      case eFloat64 : return 8;
+      case eFloat32 : return 4;
+    }
+    return 0;
+  }
+
+  /// The type of a C++ type.
+  template< typename T > static Type TypeOf();
+
+  /// Checks if the host is little-endian.
+  static inline bool IsLittleEndian() {
+    const std::uint16_t one = 1;
+    return *reinterpret_cast< const unsigned char* >( &one ) == 1;
+  }
+
+  /// Reverses the bytes of an array of values (for big-endian hosts).
+  static inline void SwapBytes( char* aData, std::size_t aValues, std::size_t aSize ) {
+    for ( std::size_t i = 0; i < aValues; i++, aData += aSize ) {
+      for ( std::size_t j = 0; j < aSize / 2; j++ ) std::swap( aData[j], aData[aSize-1-j] );
+    }
+  }
+};
+
+template<> inline NNBARColumnarFormat::Type NNBARColumnarFormat::TypeOf< std::int32_t >() { return eInt32; }
+template<> inline NNBARColumnarFormat::Type NNBARColumnarFormat::TypeOf< double >() { return eFloat64; }
+template<> inline NNBARColumnarFormat::Type NNBARColumnarFormat::TypeOf< float >() { return eFloat32; }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+/// Writing of a columnar file.
+///
+/// The ntuples and columns are declared before Open(). The values of an
+/// event are given per column with Fill() (a column not filled has no values
+/// in the event) and the event is closed with EndEvent(). The events are kept
+/// in memory and written per chunk, each column with its smallest encoding.
+
+class NNBARColumnarFileWriter {
+  public:
+
+    NNBARColumnarFileWriter() : fEventsPerChunk( 1000 ), fPosition( 0 ), fEvents( 0 ), 
+      fChunkEvents( 0 ), fChunkBytes( 0 ), fSize( 0 ) {};
+
+    ~NNBARColumnarFileWriter() { Close(); };
+
+    /// Declares an ntuple.
+    /// @return The index of the ntuple.
+    inline std::size_t AddNtuple( const std::string& aName ) {
+      fNtuples.push_back( { aName, {} } );
+      return fNtuples.size() - 1;
+    };
+
+    /// Declares a column of the last declared ntuple.
+    /// @return The index of the column (counted over all the ntuples).
+    inline std::size_t AddColumn( const std::string& aName, NNBARColumnarFormat::Type aType ) {
+      fNtuples.back().fColumns.push_back( fColumns.size() );
+      fColumns.push_back( { aName, aType, NNBARColumnarFormat::ePlain, 0, 0, 0, {}, { 0 } } );
+      return fColumns.size() - 1;
+    };
+
+    /// Declares a floating point column of the last declared ntuple, stored in
+    /// fixed point: value = aMinimum + aScale * n, with n in u16 if the range
+    /// fits, in u32 otherwise. The values out of the range are clamped.
+    /// @return The index of the column (counted over all the ntuples).
+    std::size_t AddColumn( const std::string& aName, NNBARColumnarFormat::Type aType,
+                           double aMinimum, double aMaximum, double aScale ) {
+      std::size_t column = AddColumn( aName, aType );
+      if ( aType == NNBARColumnarFormat::eInt32  ||  aScale <= 0  ||  aMaximum <= aMinimum ) return column;
+      double steps = std::ceil( ( aMaximum - aMinimum ) / aScale );
+      if ( steps > 4294967295. ) return column;
+      fColumns[column].fEncoding = steps <= 65535 ? NNBARColumnarFormat::eFixed16 
+                                                  : NNBARColumnarFormat::eFixed32;
+      fColumns[column].fMinimum = aMinimum;
+      fColumns[column].fMaximum = aMaximum;
+      fColumns[column].fScale = aScale;
+      return column;
+    };
+
+    /// Opens the file and writes the header.
+    /// @param aFileName The name of the file.
+    /// @param aEventsPerChunk The number of events of a chunk.
+    /// @return False if the file cannot be opened.
+    bool Open( const std::string& aFileName, std::size_t aEventsPerChunk = 1000 ) {
+      fFile.open( aFileName, std::ios::binary | std::ios::trunc );
+      if ( ! fFile ) return false;
+      fEventsPerChunk = aEventsPerChunk > 0 ? aEventsPerChunk : 1;
+      fPosition = 0;
+      fEvents = 0;
+      fChunkEvents = 0;
+      fChunkBytes = 0;
+      fIndex.clear();
+      WriteBytes( "NNBARCOL", 8 );
+      WriteValue< std::uint32_t >( NNBARColumnarFormat::fVersion );
+      WriteValue< std::uint32_t >( fNtuples.size() );
+      for ( const auto& ntuple : fNtuples ) {
+        WriteString( ntuple.fName );
+        WriteValue< std::uint32_t >( ntuple.fColumns.size() );
+        for ( auto column : ntuple.fColumns ) {
+          WriteString( fColumns[column].fName );
+          WriteValue< std::uint32_t >( fColumns[column].fType );
+          WriteValue< std::uint32_t >( fColumns[column].fEncoding );
+          WriteValue< double >( fColumns[column].fMinimum );
+          WriteValue< double >( fColumns[column].fMaximum );
+          WriteValue< double >( fColumns[column].fScale );
+        }
+      }
+      Pad();
+      fSize = fPosition;
+      return true;
+    };
+
+    /// Checks if the file is open.
+    inline bool IsOpen() const { return fFile.is_open(); };
+
+    /// Adds the values of a column to the current event.
+    /// @param aColumn The index of the column.
+    /// @param aValues The values, of the type of the column.
+    /// @param aNumberOfValues The number of values.
+    inline void Fill( std::size_t aColumn, const void* aValues, std::size_t aNumberOfValues ) {
+      Column& column = fColumns[aColumn];
+      const char* values = static_cast< const char* >( aValues );
+      std::size_t bytes = aNumberOfValues * NNBARColumnarFormat::SizeOf( column.fType );
+      column.fValues.insert( column.fValues.end(), values, values + bytes );
+      fChunkBytes += bytes;
+    };
+
+    /// Closes the current event (and writes the chunk if complete).
+    inline void EndEvent() {
+      for ( auto& column : fColumns ) {
+        column.fOffsets.push_back( column.fValues.size() / NNBARColumnarFormat::SizeOf( column.fType ) );
+      }
+      fChunkBytes += fColumns.size() * sizeof( std::uint64_t );
+      fEvents++;
+      if ( ++fChunkEvents == fEventsPerChunk ) WriteChunk();
+      fSize = fPosition + fChunkBytes;
+    };
+
+    /// Gets the number of events written (or kept for the chunk).
+    inline std::uint64_t GetNumberOfEvents() const { return fEvents; };
+
+    /// Gets the size of the file at the last closed event, with the chunk
+    /// kept in memory counted unencoded (an upper estimate). Can be read from
+    /// another thread than the one writing.
+    inline std::uint64_t GetSize() const { return fSize; };
+
+    /// Writes the last chunk and the index, and closes the file.
+    void Close() {
+      if ( ! fFile.is_open() ) return;
+      if ( fChunkEvents > 0 ) WriteChunk();
+      std::uint64_t indexPosition = fPosition;
+      WriteValue< std::uint64_t >( fIndex.size() / ( 2 + 5 * fColumns.size() ) );
+      for ( auto value : fIndex ) WriteValue< std::uint64_t >( value );
+      WriteValue< std::uint64_t >( indexPosition );
+      WriteBytes( "NNBARIDX", 8 );
+      fFile.close();
+    };
+
+  private:
+
+    /// An ntuple: its name and the indices of its columns.
+    struct Ntuple {
+      std::string fName;
+      std::vector< std::size_t > fColumns;
+    };
+
+    /// A column and its values in the current chunk.
+    struct Column {
+      std::string fName;
+      NNBARColumnarFormat::Type fType;
+      /// ePlain, or the fixed point encoding of the column.
+      NNBARColumnarFormat::Encoding fEncoding;
+      double fMinimum;
+      double fMaximum;
+      double fScale;
+      std::vector< char > fValues;
+      std::vector< std::uint64_t > fOffsets;
+    };
+
+    /// Writes the events of the chunk.
+    void WriteChunk() {
+      fIndex.push_back( fEvents - fChunkEvents );
+      fIndex.push_back( fChunkEvents );
+      for ( auto& column : fColumns ) {
+        std::uint64_t values = column.fValues.size() / NNBARColumnarFormat::SizeOf( column.fType );
+        fIndex.push_back( fPosition );
+        WriteArray( reinterpret_cast< char* >( column.fOffsets.data() ), 
+                    column.fOffsets.size(), sizeof( std::uint64_t ) );
+        Pad();
+        fIndex.push_back( fPosition );
+        std::uint64_t entries = 0;
+        NNBARColumnarFormat::Encoding encoding = WriteValues( column, values, entries );
+        Pad();
+        fIndex.push_back( values );
+        fIndex.push_back( encoding );
+        fIndex.push_back( entries );
+        // The capacity is kept for the next chunk
+        column.fValues.clear();
+        column.fOffsets.assign( 1, 0 );
+      }
+      fChunkEvents = 0;
+      fChunkBytes = 0;
+    };
+
+    /// Writes the values of a column in the chunk with the smallest encoding.
+    /// @param aEntries The number of stored entries (set).
+    /// @return The encoding.
+    NNBARColumnarFormat::Encoding WriteValues( Column& aColumn, std::uint64_t aValues, 
+                                               std::uint64_t& aEntries ) {
+      std::size_t size = NNBARColumnarFormat::SizeOf( aColumn.fType );
+      char* data = aColumn.fValues.data();
+      std::size_t distinct = aValues > 1 ? FindDistinct( aColumn, aValues ) : 0;
+
+      if ( distinct == 1 ) {
+        aEntries = 1;
+        WriteArray( data, 1, size );
+        return NNBARColumnarFormat::eConstant;
+      }
+      if ( aColumn.fEncoding != NNBARColumnarFormat::ePlain ) {
+        aEntries = aValues;
+        if ( aColumn.fEncoding == NNBARColumnarFormat::eFixed16 ) {
+          WriteFixed< std::uint16_t >( aColumn, aValues );
+        } else {
+          WriteFixed< std::uint32_t >( aColumn, aValues );
+        }
+        return aColumn.fEncoding;
+      }
+      if ( distinct > 1  &&  distinct * size + aValues < aValues * size ) {
+        // The dictionary (sorted) and the index of every value
+        aEntries = distinct;
+        fIndices.resize( aValues );
+        for ( std::uint64_t i = 0; i < aValues; i++ ) {
+          fIndices[i] = std::lower_bound( fDistinct.begin(), fDistinct.end(), 
+                                          Key( data + i * size, size ) ) - fDistinct.begin();
+        }
+        for ( auto key : fDistinct ) {
+          std::memcpy( fKey, &key, size );
+          WriteArray( fKey, 1, size );
+        }
+        WriteBytes( reinterpret_cast< const char* >( fIndices.data() ), aValues );
+        return NNBARColumnarFormat::eDictionary;
+      }
+      aEntries = aValues;
+      WriteArray( data, aValues, size );
+      return NNBARColumnarFormat::ePlain;
+    };
+
+    /// Finds the distinct values of a column in the chunk (in fDistinct).
+    /// @return The number of distinct values, 0 if above fMaxDictionary.
+    std::size_t FindDistinct( const Column& aColumn, std::uint64_t aValues ) {
+      std::size_t size = NNBARColumnarFormat::SizeOf( aColumn.fType );
+      const char* data = aColumn.fValues.data();
+      fDistinct.clear();
+      for ( std::uint64_t i = 0; i < aValues; i++ ) {
+        std::uint64_t key = Key( data + i * size, size );
+        auto found = std::lower_bound( fDistinct.begin(), fDistinct.end(), key );
+        if ( found != fDistinct.end()  &&  *found == key ) continue;
+        if ( fDistinct.size() == NNBARColumnarFormat::fMaxDictionary ) return 0;
+        fDistinct.insert( found, key );
+      }
+      return fDistinct.size();
+    };
+
+    /// Writes the values of a column in the chunk in fixed point.
+    template< typename T > void WriteFixed( const Column& aColumn, std::uint64_t aValues ) {
+      double maximum = std::min( std::floor( ( aColumn.fMaximum - aColumn.fMinimum ) / aColumn.fScale + 0.5 ), 
+                                 double( T( -1 ) ) );
+      fFixed.resize( aValues * sizeof( T ) );
+      T* fixed = reinterpret_cast< T* >( fFixed.data() );
+      for ( std::uint64_t i = 0; i < aValues; i++ ) {
+        double value = aColumn.fType == NNBARColumnarFormat::eFloat32 ? 
+          reinterpret_cast< const float* >( aColumn.fValues.data() )[i] :
+          reinterpret_cast< const double* >( aColumn.fValues.data() )[i];
+        double step = std::floor( ( value - aColumn.fMinimum ) / aColumn.fScale + 0.5 );
+        fixed[i] = T( std::max( 0., std::min( step, maximum ) ) );
+      }
+      WriteArray( fFixed.data(), aValues, sizeof( T ) );
+    };
+
+    /// The bytes of a value as an integer (to compare and sort the values).
+    static inline std::uint64_t Key( const char* aValue, std::size_t aSize ) {
+      std::uint64_t key = 0;
+      std::memcpy( &key, aValue, aSize );
+      return key;
+    };
+
+    /// Writes an array in little-endian order.
+    void WriteArray( char* aData, std::size_t aValues, std::size_t aSize ) {
+      if ( ! NNBARColumnarFormat::IsLittleEndian() ) {
+        NNBARColumnarFormat::SwapBytes( aData, aValues, aSize );
+      }
+      WriteBytes( aData, aValues * aSize );
+    };
+
+    /// Writes a value in little-endian order.
+    template< typename T > void WriteValue( T aValue ) {
+      WriteArray( reinterpret_cast< char* >( &aValue ), 1, sizeof( T ) );
+    };
+
+    /// Writes a string (its length and characters).
+    void WriteString( const std::string& aString ) {
+      WriteValue< std::uint32_t >( aString.size() );
+      WriteBytes( aString.data(), aString.size() );
+    };
+
+    /// Writes bytes.
+    inline void WriteBytes( const char* aData, std::size_t aSize ) {
+      fFile.write( aData, aSize );
+      fPosition += aSize;
+    };
+
+    /// Pads the file to the alignment.
+    inline void Pad() {
+      static const char zeros[NNBARColumnarFormat::fAlignment] = {};
+      std::size_t padding = ( NNBARColumnarFormat::fAlignment - 
+                              fPosition % NNBARColumnarFormat::fAlignment ) % NNBARColumnarFormat::fAlignment;
+      WriteBytes( zeros, padding );
+    };
+
+    std::ofstream fFile;
+    std::vector< Ntuple > fNtuples;
+    std::vector< Column > fColumns;
+    std::size_t fEventsPerChunk;
+    std::uint64_t fPosition;
+    std::uint64_t fEvents;
+    std::size_t fChunkEvents;
+    /// The bytes of the values and offsets kept for the chunk.
+    std::size_t fChunkBytes;
+    /// The size of the file with the chunk, at the last closed event.
+    std::atomic< std::uint64_t > fSize;
+    /// The index: per chunk the first event, the events and per column the
+    /// positions of the offsets and values, the number of values, the
+    /// encoding and the number of stored entries.
+    std::vector< std::uint64_t > fIndex;
+    /// Buffers of the encoding (their capacity is kept between the chunks).
+    std::vector< std::uint64_t > fDistinct;
+    std::vector< std::uint8_t > fIndices;
+    std::vector< char > fFixed;
+    char fKey[8];
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+/// Reading of a columnar file.
+///
+/// The file is mapped to the memory: the offsets and the plain values of the
+/// columns are read in place, without a copy; the encoded values are decoded
+/// with GetValues() to a vector. Little-endian hosts only.
+
+class NNBARColumnarFileReader {
+  public:
+
+    /// A column of the file.
+    struct Column {
+      std::string fName;
+      std::size_t fNtuple;
+      NNBARColumnarFormat::Type fType;
+      /// ePlain, or the fixed point encoding of the column.
+      NNBARColumnarFormat::Encoding fEncoding;
+      /// The range and scale of the fixed point.
+      double fMinimum;
+      double fMaximum;
+      double fScale;
+    };
+
+    NNBARColumnarFileReader() : fData( nullptr ), fSize( 0 ), fVersion( 0 ), fChunks( 0 ) {};
+
+    ~NNBARColumnarFileReader() { Close(); };
+
+    /// Maps a file and reads its header and index.
+    /// @return False if the file cannot be mapped or is not a columnar file.
+    bool Open( const std::string& aFileName ) {
+      Close();
+      if ( ! NNBARColumnarFormat::IsLittleEndian() ) return false;
+      int descriptor = ::open( aFileName.c_str(), O_RDONLY );
+      if ( descriptor < 0 ) return false;
+      struct stat status;
+      if ( ::fstat( descriptor, &status ) == 0  &&  status.st_size >= 24 ) {
+        void* data = ::mmap( nullptr, status.st_size, PROT_READ, MAP_SHARED, descriptor, 0 );
+        if ( data != MAP_FAILED ) {
+          fData = static_cast< const char* >( data );
+          fSize = status.st_size;
+        }
+      }
+      ::close( descriptor );
+      if ( ! fData ) return false;
+      if ( std::memcmp( fData, "NNBARCOL", 8 ) != 0  ||  
+           std::memcmp( fData + fSize - 8, "NNBARIDX", 8 ) != 0 ) {
+        Close();
+        return false;
+      }
+      std::uint64_t position = 8;
+      fVersion = Read< std::uint32_t >( position );
+      if ( fVersion > NNBARColumnarFormat::fVersion ) {
+        Close();
+        return false;
+      }
+      std::uint32_t ntuples = Read< std::uint32_t >( position );
+      for ( std::uint32_t i = 0; i < ntuples; i++ ) {
+        fNtuples.push_back( ReadString( position ) );
+        std::uint32_t columns = Read< std::uint32_t >( position );
+        for ( std::uint32_t j = 0; j < columns; j++ ) {
+          std::string name = ReadString( position );
+          auto type = static_cast< NNBARColumnarFormat::Type >( Read< std::uint32_t >( position ) );
+          Column column = { name, i, type, NNBARColumnarFormat::ePlain, 0, 0, 0 };
+          if ( fVersion > 1 ) {
+            column.fEncoding = static_cast< NNBARColumnarFormat::Encoding >( Read< std::uint32_t >( position ) );
+            column.fMinimum = Read< double >( position );
+            column.fMaximum = Read< double >( position );
+            column.fScale = Read< double >( position );
+          }
+          fColumns.push_back( column );
+        }
+      }
+      std::uint64_t indexPosition = fSize - 16;
+      indexPosition = Read< std::uint64_t >( indexPosition );
+      fChunks = Read< std::uint64_t >( indexPosition );
+      fIndex = reinterpret_cast< const std::uint64_t* >( fData + indexPosition );
+      return true;
+    };
+
+    /// Unmaps the file.
+    void Close() {
+      if ( fData ) ::munmap( const_cast< char* >( fData ), fSize );
+      fData = nullptr;
+      fSize = 0;
+      fVersion = 0;
+      fChunks = 0;
+      fNtuples.clear();
+      fColumns.clear();
+    };
+
+    /// Gets the names of the ntuples.
+    inline const std::vector< std::string >& GetNtuples() const { return fNtuples; };
+
+    /// Gets the columns (of all the ntuples).
+    inline const std::vector< Column >& GetColumns() const { return fColumns; };
+
+    /// Finds a column by its name.
+    /// @return The index of the column, or -1 if not found.
+    inline long FindColumn( const std::string& aName ) const {
+      for ( std::size_t i = 0; i < fColumns.size(); i++ ) {
+        if ( fColumns[i].fName == aName ) return i;
+      }
+      return -1;
+    };
+
+    /// Gets the number of chunks.
+    inline std::uint64_t GetNumberOfChunks() const { return fChunks; };
+
+    /// Gets the first event of a chunk.
+    inline std::uint64_t GetFirstEvent( std::uint64_t aChunk ) const { return Entry( aChunk )[0]; };
+
+    /// Gets the number of events of a chunk.
+    inline std::uint64_t GetNumberOfEvents( std::uint64_t aChunk ) const { return Entry( aChunk )[1]; };
+
+    /// Gets the offsets of a column in a chunk (events + 1 entries).
+    inline const std::uint64_t* GetOffsets( std::uint64_t aChunk, std::size_t aColumn ) const {
+      return reinterpret_cast< const std::uint64_t* >( fData + Entry( aChunk, aColumn )[0] );
+    };
+
+    /// Gets the encoding of a column in a chunk.
+    inline NNBARColumnarFormat::Encoding GetEncoding( std::uint64_t aChunk, std::size_t aColumn ) const {
+      return fVersion > 1 ? static_cast< NNBARColumnarFormat::Encoding >( Entry( aChunk, aColumn )[3] ) 
+                          : NNBARColumnarFormat::ePlain;
+    };
+
+    /// Gets the values of a column in a chunk, in place. For the plain chunks
+    /// only (see GetEncoding()), T is the type of the column.
+    template< typename T > 
+    inline const T* GetValues( std::uint64_t aChunk, std::size_t aColumn ) const {
+      return reinterpret_cast< const T* >( fData + Entry( aChunk, aColumn )[1] );
+    };
+
+    /// Gets the values of a column in a chunk, decoded and converted to T.
+    /// @param aValues The values (resized to the number of values).
+    template< typename T >
+    void GetValues( std::uint64_t aChunk, std::size_t aColumn, std::vector< T >& aValues ) const {
+      const Column& column = fColumns[aColumn];
+      const char* data = fData + Entry( aChunk, aColumn )[1];
+      aValues.resize( GetNumberOfValues( aChunk, aColumn ) );
+      switch ( GetEncoding( aChunk, aColumn ) ) {
+        case NNBARColumnarFormat::ePlain :
+          for ( std::size_t i = 0; i < aValues.size(); i++ ) aValues[i] = Value< T >( data, i, column.fType );
+          break;
+        case NNBARColumnarFormat::eConstant :
+          std::fill( aValues.begin(), aValues.end(), Value< T >( data, 0, column.fType ) );
+          break;
+        case NNBARColumnarFormat::eDictionary : {
+          const std::uint8_t* indices = reinterpret_cast< const std::uint8_t* >( 
+            data + Entry( aChunk, aColumn )[4] * NNBARColumnarFormat::SizeOf( column.fType ) );
+          for ( std::size_t i = 0; i < aValues.size(); i++ ) aValues[i] = Value< T >( data, indices[i], column.fType );
+          break;
+        }
+        case NNBARColumnarFormat::eFixed16 : {
+          const std::uint16_t* fixed = reinterpret_cast< const std::uint16_t* >( data );
+          for ( std::size_t i = 0; i < aValues.size(); i++ ) aValues[i] = T( column.fMinimum + column.fScale * fixed[i] );
+          break;
+        }
+        case NNBARColumnarFormat::eFixed32 : {
+          const std::uint32_t* fixed = reinterpret_cast< const std::uint32_t* >( data );
+          for ( std::size_t i = 0; i < aValues.size(); i++ ) aValues[i] = T( column.fMinimum + column.fScale * fixed[i] );
+          break;
+        }
+      }
+    };
+
+    /// Gets the number of values of a column in a chunk.
+    inline std::uint64_t GetNumberOfValues( std::uint64_t aChunk, std::size_t aColumn ) const {
+      return Entry( aChunk, aColumn )[2];
+    };
+
+  private:
+
+    /// The number of index entries of a column in a chunk.
+    inline std::size_t ColumnEntries() const { return fVersion > 1 ? 5 : 3; };
+
+    /// The index entry of a chunk.
+    inline const std::uint64_t* Entry( std::uint64_t aChunk ) const {
+      return fIndex + aChunk * ( 2 + ColumnEntries() * fColumns.size() );
+    };
+
+    /// The index entry of a column in a chunk.
+    inline const std::uint64_t* Entry( std::uint64_t aChunk, std::size_t aColumn ) const {
+      return Entry( aChunk ) + 2 + ColumnEntries() * aColumn;
+    };
+
+    /// A value of an array of a type, converted to T.
+    template< typename T > 
+    static inline T Value( const char* aData, std::size_t aIndex, NNBARColumnarFormat::Type aType ) {
+      switch ( aType ) {
+        case NNBARColumnarFormat::eInt32   : return T( reinterpret_cast< const std::int32_t* >( aData )[aIndex] );
+        case NNBARColumnarFormat::eFloat64 : return T( reinterpret_cast< const double* >( aData )[aIndex] );
+        case NNBARColumnarFormat::eFloat32 : return T( reinterpret_cast< const float* >( aData )[aIndex] );
+      }
+      return T();
+    };
+
+    template< typename T > T Read( std::uint64_t& aPosition ) const {
+      T value;
+      std::memcpy( &value, fData + aPosition, sizeof( T ) );
+      aPosition += sizeof( T );
+      return value;
+    };
+
+    std::string ReadString( std::uint64_t& aPosition ) const {
+      std::uint32_t length = Read< std::uint32_t >( aPosition );
+      std::string value( fData + aPosition, length );
+      aPosition += length;
+      return value;
+    };
+
+    const char* fData;
+    std::size_t fSize;
+    std::uint32_t fVersion;
+    std::uint64_t fChunks;
+    const std::uint64_t* fIndex;
+    std::vector< std::string > fNtuples;
+    std::vector< Column > fColumns;
+};
+
+#endif
@@ -30,6 +30,7 @@
 #ifndef NNBAR_DETECTOR_CONSTRUCTION_H
 #define NNBAR_DETECTOR_CONSTRUCTION_H
 
+#include "NNBARFastSimModelTarget.hh"
 #include "NNBARFastSimModelTracker.hh"
 #include "NNBARFastSimModelEMCal.hh"
 #include "NNBARFastSimModelHCal.hh"
@@ -77,6 +78,24 @@ class NNBARDetectorConstruction : public G4VUserDetectorConstruction {
 
     /// Messenger of the magnetic field
     G4GlobalMagFieldMessenger* fMagFieldMessenger;
+
+  private:
+
+    /// Half-lengths of the inner (hollow) box of the TPC, passed to the
+    /// tracker fast simulation model.
+    G4ThreeVector fTPCInnerHalfSize;
+
+    /// Half-lengths of the outer box of the TPC.
+    G4ThreeVector fTPCOuterHalfSize;
+
+    /// Half-size of the inner surface of the scintillator (hadronic calorimeter).
+    G4double fCalorInnerHalfSize;
+
+    /// Half-size of the surface between the scintillator and the lead glass.
+    G4double fCalorMiddleHalfSize;
+
+    /// Half-size of the outer surface of the lead glass (electromagnetic calorimeter).
+    G4double fCalorOuterHalfSize;
 };
 
 #endif
@@ -31,11 +31,19 @@
 #define NNBAR_DETECTOR_PARAMETRSIATION_H
 
 #include "globals.hh"
+#include "G4ThreeVector.hh"
+#include <vector>
+
+class G4Physics2DVector;
 
 /// Definition of detector resolution and efficiency.
 ///
 /// A simple class used to provide the detector resolution and efficiency
 /// (dependent on the detector, parametrisation type and particle momentum).
+/// The NNBAR calorimeter response is tabulated as a function of the kinetic
+/// energy and of the cosine of the incidence angle on the calorimeter face,
+/// per hadron species for the hadronic calorimeter (see BuildEMCalTables()
+/// and BuildHCalTables()).
 
 class NNBARDetectorParametrisation {
   public:
@@ -51,25 +59,95 @@ class NNBARDetectorParametrisation {
     /// A detector type (tracking detector, electromagnetic calorimeter,
     ///                  hadronic calorimeter).
     enum Detector { eTRACKER, eEMCAL, eHCAL };
+
+    /// A face of the box calorimeter (the walls are parallel to the beam axis).
+    enum Face { eFacePlusX, eFaceMinusX, eFacePlusY, eFaceMinusY };
+
+    /// A hadron species with its own hadronic calorimeter response.
+    enum HadronSpecies { eProton, eNeutron, eChargedKaon, eNeutralKaon, eChargedPion,
+                         eNumberOfHadronSpecies };
+
+    /// Gets the hadron species of a particle (-1 if it has no dedicated response).
+    /// @param pdg A PDG code of the particle (antiparticles share the tables).
+    static G4int GetHadronSpecies( G4int pdg );
+
+    /// Gets the face of a calorimeter layer a position belongs to: the wall
+    /// whose inner or outer surface is the closest one.
+    /// @param aPosition A position (e.g. the entry point of a particle).
+    /// @param aInnerHalfSize A half-size of the inner surface of the layer.
+    /// @param aOuterHalfSize A half-size of the outer surface of the layer.
+    static G4int GetFace( const G4ThreeVector& aPosition, G4double aInnerHalfSize,
+                          G4double aOuterHalfSize );
+
+    /// Gets the normal of a face, pointing outwards (into the calorimeter).
+    /// @param aFace A face of the calorimeter.
+    static G4ThreeVector GetFaceNormal( G4int aFace );
+
+    /// Gets the mean stopping power of a heavy charged particle (Bethe formula
+    /// without shell and density corrections, floored near the Bragg peak).
+    /// @param aElectronDensity An electron density of the material.
+    /// @param aMeanExcitationEnergy A mean excitation energy of the material.
+    /// @param aMass A mass of the particle.
+    /// @param aCharge A charge of the particle (in units of eplus).
+    /// @param aKenergy A kinetic energy of the particle.
+    static G4double GetStoppingPower( G4double aElectronDensity, G4double aMeanExcitationEnergy,
+                                      G4double aMass, G4double aCharge, G4double aKenergy );
     
     /// Gets the resolution of a detector for a given particle.
     /// @param aDetector A detector type.
     /// @param aParametrisation A parametrisation type.
     /// @param aKenergy A particle momentum.
+    /// @param pdg A PDG code of the particle.
+    /// @param aCosTheta A cosine of the incidence angle (calorimeters only).
     G4double GetResolution( Detector aDetector, Parametrisation aParametrisation,
-                            G4double aKenergy, G4int pdg = 0 );
+                            G4double aKenergy, G4int pdg = 0, G4double aCosTheta = 1. );
     
 
      //Add for median (august 2023)
     G4double GetMedian( Detector aDetector, Parametrisation aParametrisation,
-                            G4double aKenergy, G4int pdg = 0 );
+                            G4double aKenergy, G4int pdg = 0, G4double aCosTheta = 1. );
 
     /// Gets the efficiency of a detector for a given particle.
     /// @param aDetector A detector type.
     /// @param aParametrisation A parametrisation type.
-    /// @param aMomentum A particle momentum.
+    /// @param aKenergy A particle kinetic energy (momentum for the EMCal).
+    /// @param pdg A PDG code of the particle.
+    /// @param aCosTheta A cosine of the incidence angle (calorimeters only).
     G4double GetEfficiency( Detector aDetector, Parametrisation aParametrisation,
-                            G4double aKenergy );
+                            G4double aKenergy, G4int pdg = 0, G4double aCosTheta = 1. );
+
+  private:
+
+    /// Fills the electromagnetic calorimeter tables (energies in GeV).
+    void BuildEMCalTables();
+
+    /// Fills the hadronic calorimeter tables (energies in GeV).
+    void BuildHCalTables();
+
+    /// Extends the response of one species at normal incidence to all the
+    /// incidence angles (the path in the scintillator scales as 1/cos(theta)).
+    void FillHCalTables( G4int aSpecies, const std::vector< G4double >& aEnergy,
+                         const std::vector< G4double >& aResolution,
+                         const std::vector< G4double >& aMedian,
+                         const std::vector< G4double >& aEfficiency );
+
+    /// Nodes in cos(theta) shared by all the tables.
+    static const std::vector< G4double > fCosThetaNodes;
+
+    /// Relative resolution of the electromagnetic calorimeter.
+    G4Physics2DVector* fEMCalResolution;
+
+    /// Median of the electromagnetic calorimeter response.
+    G4Physics2DVector* fEMCalMedian;
+
+    /// Relative resolution of the hadronic calorimeter per species.
+    G4Physics2DVector* fHCalResolution[eNumberOfHadronSpecies];
+
+    /// Median of the visible energy fraction per species.
+    G4Physics2DVector* fHCalMedian[eNumberOfHadronSpecies];
+
+    /// Detection efficiency per species.
+    G4Physics2DVector* fHCalEfficiency[eNumberOfHadronSpecies];
 };
 
 #endif
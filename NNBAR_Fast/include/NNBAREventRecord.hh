@@ -0,0 +1,250 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBAREventRecord.hh
+/// \brief Definition of the event records of NNBAROutput
+
+#ifndef NNBAR_EVENT_RECORD_H
+#define NNBAR_EVENT_RECORD_H
+
+#include "globals.hh"
+#include <utility>
+#include <vector>
+
+/// The columns of the output ntuples, one line per column:
+///   COLUMN( type, member of the record, name of the ntuple column )
+/// A column added here is a member of the record, reset with the record and
+/// bound to the ntuple by NNBAROutput::CreateNtuples(). The type is G4int,
+/// G4float or G4double, stored as is in the Root file. The calorimeter values
+/// (positions in mm inside the detector, times in ns, energies) are G4float,
+/// its precision is well below the resolutions of the calorimeters.
+
+/// The "MC" ntuple: one row per primary particle, the row is the particle ID
+/// (the primary index of the calorimeter deposits).
+#define NNBAR_MC_COLUMNS( COLUMN )                   \
+  COLUMN( G4int,    fParticleID, "particleID" )      \
+  COLUMN( G4int,    fPID,        "PID" )             \
+  COLUMN( G4double, fKE,         "MC_KE" )           \
+  COLUMN( G4double, fX,          "MC_X" )            \
+  COLUMN( G4double, fY,          "MC_Y" )            \
+  COLUMN( G4double, fZ,          "MC_Z" )
+
+/// The "Tracker" ntuple: one row per track.
+#define NNBAR_TRACKER_COLUMNS( COLUMN )              \
+  COLUMN( G4double, fRes,        "tracker_res" )     \
+  COLUMN( G4double, fEff,        "tracker_eff" )     \
+  COLUMN( G4double, fPX,         "tracker_pX" )      \
+  COLUMN( G4double, fPY,         "tracker_pY" )      \
+  COLUMN( G4double, fPZ,         "tracker_pZ" )
+
+/// The "EMCAL" ntuple: one row per deposit, and the spots of the library
+/// showers (linked to their deposit by the spot index). A deposit keeps the
+/// Geant4 track and parent IDs of its particle and the index of its primary
+/// (the row in "MC", -1 if unknown). The spots have rows
+/// of their own ("EMCALSpot") in the flat layout of NNBAROutput.
+#define NNBAR_EMCAL_COLUMNS( COLUMN )                \
+  NNBAR_EMCAL_DEPOSIT_COLUMNS( COLUMN )              \
+  NNBAR_EMCAL_SPOT_COLUMNS( COLUMN )
+
+#define NNBAR_EMCAL_DEPOSIT_COLUMNS( COLUMN )        \
+  COLUMN( G4int,    fPDG,        "emcal_PDG" )       \
+  COLUMN( G4int,    fTrackID,    "emcal_trackID" )   \
+  COLUMN( G4int,    fParentID,   "emcal_parentID" )  \
+  COLUMN( G4int,    fPrimary,    "emcal_primary" )   \
+  COLUMN( G4float,  fETruth,     "emcal_ETruth" )    \
+  COLUMN( G4float,  fRes,        "emcal_res" )       \
+  COLUMN( G4float,  fEff,        "emcal_eff" )       \
+  COLUMN( G4float,  fX,          "emcal_X" )         \
+  COLUMN( G4float,  fY,          "emcal_Y" )         \
+  COLUMN( G4float,  fZ,          "emcal_Z" )         \
+  COLUMN( G4float,  fE,          "emcal_E" )         \
+  COLUMN( G4float,  fTime,       "emcal_Time" )      \
+  COLUMN( G4int,    fNpe,        "emcal_Npe" )       \
+  COLUMN( G4int,    fFace,       "emcal_face" )      \
+  COLUMN( G4float,  fCosTheta,   "emcal_cosTheta" )
+
+#define NNBAR_EMCAL_SPOT_COLUMNS( COLUMN )           \
+  COLUMN( G4int,    fSpotIndex,  "emcal_spot_index" )\
+  COLUMN( G4float,  fSpotX,      "emcal_spot_X" )    \
+  COLUMN( G4float,  fSpotY,      "emcal_spot_Y" )    \
+  COLUMN( G4float,  fSpotZ,      "emcal_spot_Z" )    \
+  COLUMN( G4float,  fSpotE,      "emcal_spot_E" )
+
+/// The "HCAL" ntuple: one row per deposit, linked as the EMCAL deposits.
+#define NNBAR_HCAL_COLUMNS( COLUMN )                 \
+  COLUMN( G4int,    fPDG,        "hcal_PDG" )        \
+  COLUMN( G4int,    fTrackID,    "hcal_trackID" )    \
+  COLUMN( G4int,    fParentID,   "hcal_parentID" )   \
+  COLUMN( G4int,    fPrimary,    "hcal_primary" )    \
+  COLUMN( G4float,  fETruth,     "hcal_ETruth" )     \
+  COLUMN( G4float,  fRes,        "hcal_res" )        \
+  COLUMN( G4float,  fEff,        "hcal_eff" )        \
+  COLUMN( G4float,  fX,          "hcal_X" )          \
+  COLUMN( G4float,  fY,          "hcal_Y" )          \
+  COLUMN( G4float,  fZ,          "hcal_Z" )          \
+  COLUMN( G4float,  fE,          "hcal_E" )          \
+  COLUMN( G4float,  fTime,       "hcal_Time" )       \
+  COLUMN( G4int,    fNpe,        "hcal_Npe" )        \
+  COLUMN( G4float,  fEvis,       "hcal_Evis" )       \
+  COLUMN( G4int,    fFace,       "hcal_face" )       \
+  COLUMN( G4float,  fCosTheta,   "hcal_cosTheta" )
+
+/// The "Summary" ntuple: one row per event, the totals of the calorimeters
+/// over the deposits with energy (E > 0: the rows of the particles missed by
+/// the efficiency are neither counted nor used for the first time). The
+/// centroids are weighted with the energy; the first time, the sums and the
+/// centroids are 0 without deposits.
+#define NNBAR_SUMMARY_COLUMNS( COLUMN )                  \
+  COLUMN( G4int,    fEMCalN,         "emcal_n" )         \
+  COLUMN( G4double, fEMCalE,         "emcal_sumE" )      \
+  COLUMN( G4double, fEMCalX,         "emcal_centroidX" ) \
+  COLUMN( G4double, fEMCalY,         "emcal_centroidY" ) \
+  COLUMN( G4double, fEMCalZ,         "emcal_centroidZ" ) \
+  COLUMN( G4double, fEMCalTime,      "emcal_firstTime" ) \
+  COLUMN( G4int,    fHCalN,          "hcal_n" )          \
+  COLUMN( G4double, fHCalE,          "hcal_sumE" )       \
+  COLUMN( G4double, fHCalX,          "hcal_centroidX" )  \
+  COLUMN( G4double, fHCalY,          "hcal_centroidY" )  \
+  COLUMN( G4double, fHCalZ,          "hcal_centroidZ" )  \
+  COLUMN( G4double, fHCalTime,       "hcal_firstTime" )
+
+#define NNBAR_RECORD_DECLARE_COLUMN( aType, aMember, aName ) std::vector< aType > aMember;
+#define NNBAR_RECORD_RESET_COLUMN( aType, aMember, aName ) aMember.clear();
+#define NNBAR_RECORD_RESERVE_COLUMN( aType, aMember, aName ) aMember.reserve( aRows );
+#define NNBAR_RECORD_RESIZE_COLUMN( aType, aMember, aName ) aMember.resize( aRows );
+#define NNBAR_RECORD_VISIT_COLUMN( aType, aMember, aName ) aFunction( aName, aMember );
+#define NNBAR_RECORD_COUNT_COLUMN( aType, aMember, aName ) + 1
+
+/// Defines a struct-of-arrays record of an event: a vector per column. Reset()
+/// clears the columns but keeps their capacity, so after the first events
+/// filling a record does not allocate.
+#define NNBAR_EVENT_RECORD( aRecord, aColumns )                                 \
+  struct aRecord {                                                              \
+    aColumns( NNBAR_RECORD_DECLARE_COLUMN )                                     \
+    /** The number of columns. */                                               \
+    static constexpr std::size_t fNumberOfColumns = 0 aColumns( NNBAR_RECORD_COUNT_COLUMN ); \
+    /** Clears all the columns (the capacity is kept). */                       \
+    inline void Reset() { aColumns( NNBAR_RECORD_RESET_COLUMN ) }               \
+    /** Reserves the capacity of all the columns. */                            \
+    inline void Reserve( std::size_t aRows ) { aColumns( NNBAR_RECORD_RESERVE_COLUMN ) } \
+    /** Resizes all the columns (the new rows are 0). */                       \
+    inline void Resize( std::size_t aRows ) { aColumns( NNBAR_RECORD_RESIZE_COLUMN ) } \
+    /** Calls aFunction( name, column ) for all the columns. */                 \
+    template< typename F > inline void ForEachColumn( F&& aFunction ) {         \
+      aColumns( NNBAR_RECORD_VISIT_COLUMN ) }                                   \
+    template< typename F > inline void ForEachColumn( F&& aFunction ) const {   \
+      aColumns( NNBAR_RECORD_VISIT_COLUMN ) }                                   \
+    /** The memory used by the content of the columns (in bytes). */            \
+    inline std::size_t GetMemorySize() const {                                  \
+      std::size_t size = 0;                                                     \
+      ForEachColumn( [&size]( const char*, const auto& aColumn ) {              \
+        size += aColumn.size() * sizeof( aColumn[0] ); } );                     \
+      return size; }                                                            \
+  };
+
+#define NNBAR_SUMMARY_DECLARE_COLUMN( aType, aMember, aName ) aType aMember = 0;
+
+/// The summary of an event: a value per column.
+struct NNBAREventSummary {
+  NNBAR_SUMMARY_COLUMNS( NNBAR_SUMMARY_DECLARE_COLUMN )
+
+  /// Calls aFunction( name, value ) for all the columns.
+  template< typename F > inline void ForEachColumn( F&& aFunction ) {
+    NNBAR_SUMMARY_COLUMNS( NNBAR_RECORD_VISIT_COLUMN ) }
+  template< typename F > inline void ForEachColumn( F&& aFunction ) const {
+    NNBAR_SUMMARY_COLUMNS( NNBAR_RECORD_VISIT_COLUMN ) }
+};
+
+/// The event records of the ntuples of NNBAROutput.
+NNBAR_EVENT_RECORD( NNBARMCRecord,      NNBAR_MC_COLUMNS )
+NNBAR_EVENT_RECORD( NNBARTrackerRecord, NNBAR_TRACKER_COLUMNS )
+NNBAR_EVENT_RECORD( NNBAREMCalRecord,   NNBAR_EMCAL_COLUMNS )
+NNBAR_EVENT_RECORD( NNBARHCalRecord,    NNBAR_HCAL_COLUMNS )
+
+/// The records of all the ntuples of an event, the unit handed to the output
+/// writer (NNBAROutputWriter).
+struct NNBAROutputEvent {
+  NNBARMCRecord fMC;
+  NNBARTrackerRecord fTracker;
+  NNBAREMCalRecord fEMCal;
+  NNBARHCalRecord fHCal;
+
+  /// The Geant4 ID of the event.
+  G4int fEventID = 0;
+
+  /// The summary of the event (filled by NNBAROutput::SaveEvent()).
+  NNBAREventSummary fSummary;
+
+  /// The histogram fills of the event (histogram ID, value), replayed by the
+  /// output writer, the only user of the analysis manager during the run.
+  std::vector< std::pair< G4int, G4double > > fHistogramFills;
+
+  /// If the rows of the event are written (false for an event carrying its
+  /// histogram fills only).
+  G4bool fWritten = true;
+
+  /// Clears the records (the capacity is kept).
+  inline void ResetRecords() { fMC.Reset(); fTracker.Reset(); fEMCal.Reset(); fHCal.Reset(); }
+
+  /// Clears the records and the histogram fills (the capacity is kept).
+  inline void Reset() { ResetRecords(); fHistogramFills.clear(); fWritten = true; }
+
+  /// Calls aFunction( ntuple name, ntuple title, record ) for all the records,
+  /// in the order of the ntuples.
+  template< typename F > inline void ForEachRecord( F&& aFunction ) {
+    aFunction( "MC", "MC Truth", fMC );
+    aFunction( "Tracker", "Tracker", fTracker );
+    aFunction( "EMCAL", "EMCAL", fEMCal );
+    aFunction( "HCAL", "HCAL", fHCal );
+  }
+  template< typename F > inline void ForEachRecord( F&& aFunction ) const {
+    aFunction( "MC", "MC Truth", fMC );
+    aFunction( "Tracker", "Tracker", fTracker );
+    aFunction( "EMCAL", "EMCAL", fEMCal );
+    aFunction( "HCAL", "HCAL", fHCal );
+  }
+
+  /// Calls aFunction( table name, record index, record, first column, number
+  /// of columns ) for the tables of the flat layout: the columns of a table
+  /// have the same number of rows.
+  template< typename F > inline void ForEachTable( F&& aFunction ) const {
+    constexpr std::size_t deposits = 0 NNBAR_EMCAL_DEPOSIT_COLUMNS( NNBAR_RECORD_COUNT_COLUMN );
+    aFunction( "MC", 0, fMC, 0, NNBARMCRecord::fNumberOfColumns );
+    aFunction( "Tracker", 1, fTracker, 0, NNBARTrackerRecord::fNumberOfColumns );
+    aFunction( "EMCAL", 2, fEMCal, 0, deposits );
+    aFunction( "EMCALSpot", 2, fEMCal, deposits, NNBAREMCalRecord::fNumberOfColumns - deposits );
+    aFunction( "HCAL", 3, fHCal, 0, NNBARHCalRecord::fNumberOfColumns );
+  }
+
+  /// The memory used by the content of the records (in bytes).
+  inline std::size_t GetMemorySize() const {
+    return fMC.GetMemorySize() + fTracker.GetMemorySize() + 
+           fEMCal.GetMemorySize() + fHCal.GetMemorySize() +
+           fHistogramFills.size() * sizeof( fHistogramFills[0] );
+  }
+};
+
+#endif
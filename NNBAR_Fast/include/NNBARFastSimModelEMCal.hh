@@ -32,14 +32,23 @@
 
 #include "G4VFastSimulationModel.hh"
 #include "NNBARDetectorParametrisation.hh"
+#include "NNBARTriggerPolicy.hh"
+#include "NNBARSurrogateModel.hh"
+#include "NNBARLongitudinalProfile.hh"
 #include "G4Step.hh"
 
+class NNBARFastSimModelEMCalMessenger;
+
 /// Shortcut to the ordinary tracking for electromagnetic calorimeters.
 ///
 /// The fast simulation model describes what should be done instead of a
 /// normal tracking. Instead of the ordinary tracking, a particle deposits
 /// its energy at the entrance to the electromagnetic calorimeter and its value
-/// is smeared (by NNBARSmearer::SmearMomentum()). Based on G4 
+/// is smeared (by NNBARSmearer::SmearMomentum()). The part of the shower that
+/// leaks out of the back of the lead glass (NNBARLongitudinalProfile) is saved
+/// to the hadronic calorimeter ntuple. A particle missed (see the detection
+/// efficiency) keeps its row with no energy. Optionally, the shape of the deposit is
+/// taken from a frozen shower of NNBARShowerLibrary. Based on G4 
 /// examples/extended/parametrisations/Par01/include/Par01EMShowerModel.hh .
 /// @author Anna Zaborowska
 //Modified by Andre Nepomuceno
@@ -68,9 +77,15 @@ class NNBARFastSimModelEMCal : public G4VFastSimulationModel {
     /// Checks if this model should be applied to this particle type.
     /// @param aParticle A particle definition (type).
     virtual G4bool IsApplicable( const G4ParticleDefinition& aParticle );
+
+    /// The particle types of the model, also used by NNBARPhysicsList to
+    /// register the fast simulation process only where it can be applied.
+    /// @param aParticle A particle definition (type).
+    static G4bool AppliesTo( const G4ParticleDefinition& aParticle );
     
     /// Checks if the model should be applied, taking into account the
-    /// kinematics of a track.
+    /// kinematics of a track. The decision is taken by the trigger policy
+    /// (/NNBAR/emcal/trigger/).
     /// @param aFastTrack A track.
     virtual G4bool ModelTrigger( const G4FastTrack & aFastTrack );
     
@@ -81,7 +96,41 @@ class NNBARFastSimModelEMCal : public G4VFastSimulationModel {
     /// @param aFastStep A step.
     virtual void DoIt( const G4FastTrack& aFastTrack, G4FastStep& aFastStep );
 
+    /// Sets if showers from NNBARShowerLibrary are placed at the entry point.
+    inline void SetUseShowerLibrary( G4bool aUse ) { fUseShowerLibrary = aUse; };
+
+    /// Sets the half-sizes of the inner and outer surfaces of the calorimeter,
+    /// used to find the entry face. Their difference is the thickness along the
+    /// face normal used for the longitudinal leakage (zero disables the leakage).
+    inline void SetFaceHalfSizes( G4double aInnerHalfSize, G4double aOuterHalfSize ) {
+      fInnerHalfSize = aInnerHalfSize; fAbsorberThickness = aOuterHalfSize - aInnerHalfSize; };
+
+    /// Sets the mean number of photo-electrons per MeV of the Cherenkov light.
+    /// A positive value replaces the Gaussian smearing with a Poisson draw of
+    /// the photo-electrons, zero (default) disables the photo-electron model.
+    inline void SetPhotoelectronsPerMeV( G4double aYield ) { fPhotoelectronsPerMeV = aYield; };
+
+    /// Loads the weights of the surrogate network. Once loaded, the network
+    /// gives the response instead of NNBARDetectorParametrisation.
+    inline G4bool LoadSurrogate( const G4String& aFileName ) { return fSurrogate.Load( aFileName ); };
+
+    /// Compares the time per entry of the surrogate network and of the tables.
+    inline void BenchmarkSurrogate( G4int aEntries ) {
+      fSurrogate.Benchmark( fCalculateParametrisation, NNBARDetectorParametrisation::eEMCAL, aEntries ); };
+
   private:
+
+    /// Places the library shower closest to the incident particle at its entry
+    /// point and saves its spots to NNBAROutput.
+    /// @param aFastTrack A track.
+    /// @param aEnergy An energy of the shower (the fractions of the spots kept
+    ///                are scaled to it).
+    /// @param aCosTheta A cosine of the incidence angle on the entry face.
+    /// @param aMaximumDepth A depth beyond which the spots are dropped (the
+    ///                      leaked part of the shower), 0 for none.
+    /// @return False if the library has no suitable shower.
+    G4bool PlaceShower( const G4FastTrack& aFastTrack, G4double aEnergy, G4double aCosTheta,
+                        G4double aMaximumDepth = 0 );
     
     /// A pointer to NNBARDetectorParametrisation used to get the efficiency and
     /// resolution of the detector for a given particle and parametrisation type.
@@ -89,6 +138,34 @@ class NNBARFastSimModelEMCal : public G4VFastSimulationModel {
     
     /// A parametrisation type.
     NNBARDetectorParametrisation::Parametrisation fParametrisation;
+
+    /// If showers from the library are used. Default: false.
+    G4bool fUseShowerLibrary;
+
+    /// A messenger of the model (/NNBAR/emcal/).
+    NNBARFastSimModelEMCalMessenger* fMessenger;
+
+    /// Half-size of the inner surface of the calorimeter.
+    G4double fInnerHalfSize;
+
+    /// Thickness of the calorimeter along the face normal.
+    G4double fAbsorberThickness;
+
+    /// Longitudinal shower profile in the calorimeter material (filled at
+    /// the first call of DoIt()).
+    NNBARLongitudinalProfile fProfile;
+
+    /// Mean number of photo-electrons per MeV (0 if the model is not used).
+    G4double fPhotoelectronsPerMeV;
+
+    /// The kinematic trigger of the model.
+    NNBARTriggerPolicy fTriggerPolicy;
+
+    /// The decision of the last call of ModelTrigger(), used by DoIt().
+    NNBARTriggerPolicy::Decision fTriggerDecision;
+
+    /// The optional neural network response (replaces the tables when loaded).
+    NNBARSurrogateModel fSurrogate;
 };
 
 #endif
@@ -32,14 +32,24 @@
 
 #include "G4VFastSimulationModel.hh"
 #include "NNBARDetectorParametrisation.hh"
+#include "NNBARTriggerPolicy.hh"
+#include "NNBARSurrogateModel.hh"
+#include "NNBARScintillatorResponse.hh"
 #include "G4Step.hh"
 
+class NNBARFastSimModelHCalMessenger;
+
 /// Shortcut to the ordinary tracking for hadronic calorimeters.
 ///
 /// Fast simulation model describes what should be done instead of a
-/// normal tracking. Instead of the ordinary tracking, a particle deposits
+/// normal tracking. Instead of the ordinary tracking, a hadron deposits
 /// its energy at the entrance to the hadronic calorimeter and its value
-/// is smeared (by NNBARSmearer::SmearMomentum()). Based on G4 
+/// is smeared (by NNBARSmearer::SmearEnergy()) with the response of its
+/// species and incidence angle taken from NNBARDetectorParametrisation. Hadrons that are not
+/// detected (see the neutron detection efficiency) keep their row with no energy. Optionally,
+/// the Gaussian smearing is replaced by the scintillator response: Birks
+/// quenching (NNBARScintillatorResponse) followed by photostatistics. Without
+/// the smearing the row holds the kinetic energy of the hadron. Based on G4 
 /// examples/extended/parametrisations/Par01/include/Par01EMShowerModel.hh .
 /// @author Anna Zaborowska
 // Modified by Andre Nepomuceno
@@ -68,9 +78,15 @@ class NNBARFastSimModelHCal : public G4VFastSimulationModel {
     /// Checks if this model should be applied to this particle type.
     /// @param aParticle A particle definition (type).
     virtual G4bool IsApplicable( const G4ParticleDefinition& aParticle );
+
+    /// The particle types of the model, also used by NNBARPhysicsList to
+    /// register the fast simulation process only where it can be applied.
+    /// @param aParticle A particle definition (type).
+    static G4bool AppliesTo( const G4ParticleDefinition& aParticle );
     
     /// Checks if the model should be applied, taking into account the
-    /// kinematics of a track.
+    /// kinematics of a track. The decision is taken by the trigger policy
+    /// (/NNBAR/hcal/trigger/).
     /// @param aFastTrack A track.
     virtual G4bool ModelTrigger( const G4FastTrack& aFastTrack );
     
@@ -81,6 +97,26 @@ class NNBARFastSimModelHCal : public G4VFastSimulationModel {
     /// @param aFastStep A step.
     virtual void DoIt( const G4FastTrack& aFastTrack, G4FastStep& aFastStep );
 
+    /// Sets the number of photo-electrons per MeV of visible energy. A positive
+    /// value enables the scintillator response, zero (default) disables it.
+    inline void SetPhotoelectronsPerMeV( G4double aYield ) { fPhotoelectronsPerMeV = aYield; };
+
+    /// Sets Birks' constant of the scintillator (the tables are rebuilt).
+    inline void SetBirksConstant( G4double aBirksConstant ) { fBirksConstant = aBirksConstant; };
+
+    /// Sets the half-sizes of the inner and outer surfaces of the calorimeter,
+    /// used to find the entry face and the incidence angle.
+    inline void SetFaceHalfSizes( G4double aInnerHalfSize, G4double aOuterHalfSize ) {
+      fInnerHalfSize = aInnerHalfSize; fOuterHalfSize = aOuterHalfSize; };
+
+    /// Loads the weights of the surrogate network. Once loaded, the network
+    /// gives the response instead of NNBARDetectorParametrisation.
+    inline G4bool LoadSurrogate( const G4String& aFileName ) { return fSurrogate.Load( aFileName ); };
+
+    /// Compares the time per entry of the surrogate network and of the tables.
+    inline void BenchmarkSurrogate( G4int aEntries ) {
+      fSurrogate.Benchmark( fCalculateParametrisation, NNBARDetectorParametrisation::eHCAL, aEntries ); };
+
   private:
     
     /// A pointer to NNBARDetectorParametrisation used to get the efficiency and
@@ -89,6 +125,33 @@ class NNBARFastSimModelHCal : public G4VFastSimulationModel {
 
     /// A parametrisation type.
     NNBARDetectorParametrisation::Parametrisation fParametrisation;
+
+    /// A messenger of the model (/NNBAR/hcal/).
+    NNBARFastSimModelHCalMessenger* fMessenger;
+
+    /// Photo-electrons per MeV of visible energy (0 if the response is not used).
+    G4double fPhotoelectronsPerMeV;
+
+    /// Birks' constant of the scintillator.
+    G4double fBirksConstant;
+
+    /// Quenching tables (filled at the first use, for the envelope material).
+    NNBARScintillatorResponse fScintillatorResponse;
+
+    /// Half-size of the inner surface of the calorimeter.
+    G4double fInnerHalfSize;
+
+    /// Half-size of the outer surface of the calorimeter.
+    G4double fOuterHalfSize;
+
+    /// The kinematic trigger of the model.
+    NNBARTriggerPolicy fTriggerPolicy;
+
+    /// The decision of the last call of ModelTrigger(), used by DoIt().
+    NNBARTriggerPolicy::Decision fTriggerDecision;
+
+    /// The optional neural network response (replaces the tables when loaded).
+    NNBARSurrogateModel fSurrogate;
 };
 
 #endif
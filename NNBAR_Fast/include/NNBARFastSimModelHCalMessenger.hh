@@ -0,0 +1,80 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARFastSimModelHCalMessenger.hh
+/// \brief Definition of the NNBARFastSimModelHCalMessenger class
+
+#ifndef NNBAR_HCAL_FAST_SIM_MODEL_MESSENGER_H
+#define NNBAR_HCAL_FAST_SIM_MODEL_MESSENGER_H
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class NNBARFastSimModelHCal;
+class G4UIdirectory;
+class G4UIcmdWithADouble;
+class G4UIcmdWithAString;
+class G4UIcmdWithAnInteger;
+
+/// Messenger of the NNBARFastSimModelHCal.
+///
+/// Defines the commands of the /NNBAR/hcal/ directory. The model is created
+/// in each worker thread, so the commands are broadcast to all of them.
+
+class NNBARFastSimModelHCalMessenger : public G4UImessenger {
+  public:
+
+    /// A constructor.
+    /// @param aModel The model controlled by the messenger.
+    NNBARFastSimModelHCalMessenger( NNBARFastSimModelHCal* aModel );
+
+    virtual ~NNBARFastSimModelHCalMessenger();
+
+    /// Applies a command.
+    virtual void SetNewValue( G4UIcommand* aCommand, G4String aNewValue );
+
+  private:
+
+    /// The model controlled by the messenger.
+    NNBARFastSimModelHCal* fModel;
+
+    /// The /NNBAR/hcal/ directory.
+    G4UIdirectory* fDirectory;
+
+    /// The /NNBAR/hcal/photoelectronsPerMeV command.
+    G4UIcmdWithADouble* fPhotoelectronsCmd;
+
+    /// The /NNBAR/hcal/birksConstant command.
+    G4UIcmdWithADouble* fBirksCmd;
+
+    /// The /NNBAR/hcal/surrogate command.
+    G4UIcmdWithAString* fSurrogateCmd;
+
+    /// The /NNBAR/hcal/surrogateBenchmark command.
+    G4UIcmdWithAnInteger* fSurrogateBenchmarkCmd;
+};
+
+#endif
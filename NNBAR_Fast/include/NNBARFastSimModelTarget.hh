@@ -0,0 +1,103 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARFastSimModelTarget.hh
+/// \brief Definition of the NNBARFastSimModelTarget class
+
+#ifndef NNBAR_TARGET_FAST_SIM_MODEL_H
+#define NNBAR_TARGET_FAST_SIM_MODEL_H
+
+#include "G4VFastSimulationModel.hh"
+#include "G4Step.hh"
+#include <map>
+
+class G4PhysicsLogVector;
+class G4Material;
+
+/// Shortcut to the ordinary tracking for the carbon target foil.
+///
+/// The physics list has no electromagnetic processes, so the foil physics
+/// is applied analytically in one step: a photon converts into an e+e- pair
+/// with the probability 1 - exp(-7/9 x/X0), a charged particle loses the mean
+/// energy dE/dx x (from a table per particle type, filled at the first use)
+/// and is deflected by multiple scattering (Highland formula). The particle
+/// is then placed at the foil exit, along its initial direction.
+
+class NNBARFastSimModelTarget : public G4VFastSimulationModel {
+  public:
+
+    /// A constructor.
+    /// @param aModelName A name of the fast simulation model.
+    /// @param aEnvelope A region where the model can take over the ordinary tracking.
+    NNBARFastSimModelTarget( G4String aModelName, G4Region* aEnvelope );
+
+    /// A constructor.
+    /// @param aModelName A name of the fast simulation model.
+    NNBARFastSimModelTarget( G4String aModelName );
+
+    ~NNBARFastSimModelTarget();
+
+    /// Checks if this model should be applied to this particle type
+    /// (photons and charged particles).
+    /// @param aParticle A particle definition (type).
+    virtual G4bool IsApplicable( const G4ParticleDefinition& aParticle );
+
+    /// The particle types of the model, also used by NNBARPhysicsList to
+    /// register the fast simulation process only where it can be applied.
+    /// @param aParticle A particle definition (type).
+    static G4bool AppliesTo( const G4ParticleDefinition& aParticle );
+
+    /// Checks if the model should be applied, taking into account the
+    /// kinematics of a track.
+    /// @param aFastTrack A track.
+    virtual G4bool ModelTrigger( const G4FastTrack& aFastTrack );
+
+    /// Converts the photon or applies the energy loss and the deflection of the
+    /// charged particle, and moves it to the foil exit.
+    /// @param aFastTrack A track.
+    /// @param aFastStep A step.
+    virtual void DoIt( const G4FastTrack& aFastTrack, G4FastStep& aFastStep );
+
+  private:
+
+    /// Converts a photon into an e+e- pair at a random depth of its path.
+    void ConvertPhoton( const G4FastTrack& aFastTrack, G4FastStep& aFastStep, 
+                        G4double aPathLength );
+
+    /// Gets the stopping power table of a particle type (filled at the first use).
+    const G4PhysicsLogVector* GetStoppingPowerTable( const G4ParticleDefinition* aParticle,
+                                                     const G4Material* aMaterial );
+
+    /// Stopping power tables per particle type.
+    std::map< const G4ParticleDefinition*, G4PhysicsLogVector* > fStoppingPowerTables;
+
+    /// Number of bins and range of the stopping power tables.
+    static const G4int fNumberOfBins = 120;
+    static constexpr G4double fMinEnergy = 1e-2;  // MeV
+    static constexpr G4double fMaxEnergy = 1e5;   // MeV
+};
+
+#endif
@@ -32,9 +32,12 @@
 
 #include "G4VFastSimulationModel.hh"
 #include "NNBARDetectorParametrisation.hh"
+#include "NNBARTriggerPolicy.hh"
 #include "G4Step.hh"
 #include "G4Navigator.hh"
 
+class NNBARHelix;
+
 /// Shortcut to the ordinary tracking for tracking detectors.
 ///
 /// The fast simulation model describes what should be done instead of a
@@ -42,7 +45,9 @@
 /// at the entrance of the tracking detector is smeared 
 /// (by NNBARSmearer::SmearMomentum()) and the particle is placed at the
 /// tracking detector exit, at the place it would reach without the change
-/// of its momentum. Based on G4 
+/// of its momentum. In the uniform field of G4GlobalMagFieldMessenger the exit
+/// point is the closed-form intersection of the helix with the envelope
+/// surfaces (see NNBARHelix), so no navigation is needed. Based on G4 
 /// examples/extended/parametrisations/Par01/include/Par01EMShowerModel.hh .
 /// @author Anna Zaborowska
 ///Modified by Andre Nepomuceno
@@ -71,9 +76,15 @@ class NNBARFastSimModelTracker : public G4VFastSimulationModel {
     /// Checks if this model should be applied to this particle type.
     /// @param aParticle A particle definition (type).
     virtual G4bool IsApplicable( const G4ParticleDefinition& aParticle );
+
+    /// The particle types of the model, also used by NNBARPhysicsList to
+    /// register the fast simulation process only where it can be applied.
+    /// @param aParticle A particle definition (type).
+    static G4bool AppliesTo( const G4ParticleDefinition& aParticle );
     
     /// Checks if the model should be applied taking into account the kinematics
-    /// of a track.
+    /// of a track. The decision is taken by the trigger policy
+    /// (/NNBAR/tracker/trigger/).
     /// @param aFastTrack A track.
     virtual G4bool ModelTrigger( const G4FastTrack& aFastTrack );
     
@@ -85,7 +96,20 @@ class NNBARFastSimModelTracker : public G4VFastSimulationModel {
     /// @param aFastStep A step.
     virtual void DoIt( const G4FastTrack& aFastTrack, G4FastStep& aFastStep );
 
+    /// Sets the dimensions of the tracking detector envelope: a box shell,
+    /// open along z, centred in the envelope local frame.
+    /// @param aInnerHalfSize Half-lengths of the inner (hollow) box.
+    /// @param aOuterHalfSize Half-lengths of the outer box.
+    void SetEnvelopeDimensions( const G4ThreeVector& aInnerHalfSize,
+                                const G4ThreeVector& aOuterHalfSize );
+
   private:
+
+    /// Calculates the path length along the trajectory to the first envelope
+    /// surface crossed (outer box, inner box or the open ends).
+    /// @param aHelix A trajectory in the envelope local frame.
+    /// @return The path length, or -1 if the particle loops inside the envelope.
+    G4double ComputeExitStep( const NNBARHelix& aHelix ) const;
     
     /// A pointer to NNBARDetectorParametrisation used to get the efficiency and
     /// resolution of the tracking detector for a given particle and
@@ -94,6 +118,22 @@ class NNBARFastSimModelTracker : public G4VFastSimulationModel {
     
     /// A parametrisation type.
     NNBARDetectorParametrisation::Parametrisation fParametrisation;
+
+    /// Half-lengths of the inner (hollow) box of the envelope.
+    G4ThreeVector fInnerHalfSize;
+
+    /// Half-lengths of the outer box of the envelope.
+    G4ThreeVector fOuterHalfSize;
+
+    /// A maximal path length inside the envelope, beyond which the particle is
+    /// considered a looper and stopped.
+    G4double fMaxPathLength;
+
+    /// The kinematic trigger of the model.
+    NNBARTriggerPolicy fTriggerPolicy;
+
+    /// The decision of the last call of ModelTrigger(), used by DoIt().
+    NNBARTriggerPolicy::Decision fTriggerDecision;
 };
 
 #endif
@@ -0,0 +1,91 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARFullSimScorer.hh
+/// \brief Definition of the NNBARFullSimScorer class
+
+#ifndef NNBAR_FULL_SIM_SCORER_H
+#define NNBAR_FULL_SIM_SCORER_H
+
+#include "globals.hh"
+#include "G4ThreeVector.hh"
+#include <cfloat>
+#include <map>
+#include <utility>
+
+class G4Step;
+class G4Region;
+
+/// Scoring of the energy deposited in the fully simulated regions.
+///
+/// A thread-local class: in the hybrid mode the fast simulation models of a
+/// region switched to the full simulation (see NNBARRegionInformation) do not
+/// trigger, so the energy deposited by the steps in the region is summed here
+/// per primary particle and saved at the end of the event as one row of the
+/// calorimeter record of the region (NNBAROutput::SaveTrack). The position
+/// is the energy-weighted centroid of the deposits and the time is the
+/// earliest one. Enabled by /NNBAR/physics/fullSimRegion.
+
+class NNBARFullSimScorer {
+  public:
+
+    /// Allows the access to the NNBARFullSimScorer of the thread.
+    static NNBARFullSimScorer* Instance();
+
+    /// Enables or disables the scoring (all threads).
+    static void SetEnabled( G4bool aEnabled ) { fEnabled = aEnabled; };
+
+    /// Checks if the scoring is enabled.
+    static inline G4bool IsEnabled() { return fEnabled; };
+
+    /// Adds the energy deposited by a step in a fully simulated region (other
+    /// steps are ignored).
+    /// @param aStep The step.
+    void AddStep( const G4Step* aStep );
+
+    /// Saves the scored energy of the event and resets the sums.
+    void Flush();
+
+  private:
+
+    /// A default, private constructor (due to singleton pattern).
+    NNBARFullSimScorer();
+
+    /// Energy deposited in a region by the secondaries of a primary particle.
+    struct Deposit {
+      G4double fEnergy = 0;
+      G4ThreeVector fWeightedPosition;
+      G4double fTime = DBL_MAX;
+    };
+
+    /// If the scoring is enabled. Default: false.
+    static G4bool fEnabled;
+
+    /// Deposits of the event per region and primary index.
+    std::map< std::pair< const G4Region*, G4int >, Deposit > fDeposits;
+};
+
+#endif
@@ -0,0 +1,108 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARHelix.hh
+/// \brief Definition of the NNBARHelix class
+
+#ifndef NNBAR_HELIX_H
+#define NNBAR_HELIX_H
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+/// Analytic trajectory of a charged particle in a uniform magnetic field.
+///
+/// The helix is parametrised by the path length s measured from the starting
+/// point. It provides the position and direction at a given path length and
+/// the closed-form intersection with a plane, so that a fast simulation model
+/// can find the exit point of a detector without stepping through the field.
+/// In the absence of field (or for a neutral particle) the helix degenerates
+/// into a straight line.
+
+class NNBARHelix {
+  public:
+
+    /// A constructor.
+    /// @param aPosition A starting position.
+    /// @param aDirection A starting (unit) momentum direction.
+    /// @param aCharge A particle charge (in units of eplus).
+    /// @param aMomentum A particle momentum.
+    /// @param aField A magnetic field vector (uniform).
+    NNBARHelix( const G4ThreeVector& aPosition, const G4ThreeVector& aDirection,
+                G4double aCharge, G4double aMomentum, const G4ThreeVector& aField );
+
+    ~NNBARHelix();
+
+    /// Gets the position after a given path length.
+    /// @param aPathLength A path length along the helix.
+    G4ThreeVector GetPosition( G4double aPathLength ) const;
+
+    /// Gets the (unit) momentum direction after a given path length.
+    /// @param aPathLength A path length along the helix.
+    G4ThreeVector GetDirection( G4double aPathLength ) const;
+
+    /// Gets the first path length, within (aSMin, aSMax), at which the helix
+    /// crosses the plane aNormal*x = aOffset.
+    /// @param aNormal A normal of the plane.
+    /// @param aOffset A distance of the plane from the origin along aNormal.
+    /// @param aSMin A lower limit (excluded) of the path length.
+    /// @param aSMax An upper limit (excluded) of the path length.
+    /// @return The path length or -1 if the plane is not crossed.
+    G4double FirstCrossing( const G4ThreeVector& aNormal, G4double aOffset,
+                            G4double aSMin, G4double aSMax ) const;
+
+    /// Checks if the trajectory is a straight line (no field or neutral particle).
+    inline G4bool IsStraight() const { return fStraight; };
+
+  private:
+
+    /// A starting position.
+    G4ThreeVector fPosition;
+
+    /// A starting direction.
+    G4ThreeVector fDirection;
+
+    /// A unit vector along the magnetic field.
+    G4ThreeVector fFieldDirection;
+
+    /// A component of the starting direction perpendicular to the field.
+    G4ThreeVector fDirectionPerp;
+
+    /// fDirectionPerp x fFieldDirection.
+    G4ThreeVector fDirectionPerpCross;
+
+    /// A component of the starting direction along the field.
+    G4double fDirectionPar;
+
+    /// A signed curvature (rotation angle of the direction per unit path length).
+    G4double fKappa;
+
+    /// A flag indicating that the trajectory is a straight line.
+    G4bool fStraight;
+};
+
+#endif
+
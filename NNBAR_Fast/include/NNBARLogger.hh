@@ -0,0 +1,131 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARLogger.hh
+/// \brief Definition of the NNBARLogger class and of the logging macros
+
+#ifndef NNBAR_LOGGER_H
+#define NNBAR_LOGGER_H
+
+#include "globals.hh"
+#include <sstream>
+
+/// Highest log level compiled into the program (see NNBARLogger::Level).
+/// Messages above it are removed at compile time, so debug and trace
+/// statements cost nothing in production builds. Set from CMake with
+/// -DNNBAR_LOG_MAX_LEVEL=<level>.
+#ifndef NNBAR_LOG_MAX_LEVEL
+#define NNBAR_LOG_MAX_LEVEL 3
+#endif
+
+/// Logs a message (a stream expression) in a category at a given level.
+/// Example: NNBAR_LOG( NNBARLogger::eEMCal, NNBARLogger::eDebug, "E = " << E );
+#define NNBAR_LOG( aCategory, aLevel, aMessage )                              \
+  do {                                                                        \
+    if ( ( aLevel ) <= NNBAR_LOG_MAX_LEVEL  &&                                \
+         NNBARLogger::IsEnabled( aCategory, aLevel ) ) {                      \
+      NNBARLogger::Buffer( aCategory, aLevel ) << aMessage << '\n';           \
+      NNBARLogger::CheckBufferSize();                                         \
+    }                                                                         \
+  } while ( 0 )
+
+#define NNBAR_ERROR( aCategory, aMessage ) \
+  NNBAR_LOG( aCategory, NNBARLogger::eError, aMessage )
+#define NNBAR_WARNING( aCategory, aMessage ) \
+  NNBAR_LOG( aCategory, NNBARLogger::eWarning, aMessage )
+#define NNBAR_INFO( aCategory, aMessage ) \
+  NNBAR_LOG( aCategory, NNBARLogger::eInfo, aMessage )
+#define NNBAR_DEBUG( aCategory, aMessage ) \
+  NNBAR_LOG( aCategory, NNBARLogger::eDebug, aMessage )
+#define NNBAR_TRACE( aCategory, aMessage ) \
+  NNBAR_LOG( aCategory, NNBARLogger::eTrace, aMessage )
+
+/// Low-overhead logging.
+///
+/// Messages are written into a thread-local buffer instead of G4cout (which
+/// is serialised between threads in MT mode) and the buffer is printed in one
+/// go at the end of each event (NNBAREventAction) and run (NNBARRunAction).
+/// Each category has its own runtime level, set with /NNBAR/log/level.
+
+class NNBARLogger {
+  public:
+
+    /// A category of the messages.
+    enum Category { eGeneral, eTracker, eEMCal, eHCal, eOutput, eNumberOfCategories };
+
+    /// A level of the messages (a message is printed if its level is lower
+    /// or equal to the level of its category).
+    enum Level { eSilent = 0, eError = 1, eWarning = 2, eInfo = 3, eDebug = 4, eTrace = 5 };
+
+    /// Checks if messages of a category are printed at a given level.
+    /// @param aCategory A category.
+    /// @param aLevel A level.
+    static inline G4bool IsEnabled( Category aCategory, Level aLevel )
+      { return aLevel <= fLevels[aCategory]; };
+
+    /// Sets the runtime level of a category.
+    /// @param aCategory A category.
+    /// @param aLevel A level.
+    static void SetLevel( Category aCategory, Level aLevel );
+
+    /// Sets the runtime level of all the categories.
+    /// @param aLevel A level.
+    static void SetLevel( Level aLevel );
+
+    /// Gets the runtime level of a category.
+    /// @param aCategory A category.
+    static Level GetLevel( Category aCategory );
+
+    /// Gets the thread-local buffer, with the message prefix already written.
+    /// @param aCategory A category of the message.
+    /// @param aLevel A level of the message.
+    static std::ostringstream& Buffer( Category aCategory, Level aLevel );
+
+    /// Flushes the buffer early if it grew above its size limit.
+    static void CheckBufferSize();
+
+    /// Prints the content of the thread-local buffer to G4cout and clears it.
+    static void Flush();
+
+    /// Gets the name of a category.
+    /// @param aCategory A category.
+    static const char* GetCategoryName( Category aCategory );
+
+    /// Gets the name of a level.
+    /// @param aLevel A level.
+    static const char* GetLevelName( Level aLevel );
+
+  private:
+
+    /// Runtime levels of the categories (shared by all the threads).
+    static G4int fLevels[eNumberOfCategories];
+
+    /// A thread-local buffer of the messages.
+    static G4ThreadLocal std::ostringstream* fBuffer;
+};
+
+#endif
+
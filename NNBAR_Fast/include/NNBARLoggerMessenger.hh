@@ -0,0 +1,69 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARLoggerMessenger.hh
+/// \brief Definition of the NNBARLoggerMessenger class
+
+#ifndef NNBAR_LOGGER_MESSENGER_H
+#define NNBAR_LOGGER_MESSENGER_H
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class G4UIdirectory;
+class G4UIcommand;
+
+/// Messenger of the NNBARLogger.
+///
+/// Defines the command /NNBAR/log/level <category> <level> that sets the
+/// runtime level of a log category ("all" for every category). The levels
+/// are shared by all the threads, so the command is not broadcast.
+
+class NNBARLoggerMessenger : public G4UImessenger {
+  public:
+
+    /// A default constructor.
+    NNBARLoggerMessenger();
+
+    virtual ~NNBARLoggerMessenger();
+
+    /// Applies a command.
+    virtual void SetNewValue( G4UIcommand* aCommand, G4String aNewValue );
+
+  private:
+
+    /// The /NNBAR/ directory.
+    G4UIdirectory* fNNBARDirectory;
+
+    /// The /NNBAR/log/ directory.
+    G4UIdirectory* fLogDirectory;
+
+    /// The /NNBAR/log/level command.
+    G4UIcommand* fLevelCmd;
+};
+
+#endif
+
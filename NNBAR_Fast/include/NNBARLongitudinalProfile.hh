@@ -0,0 +1,104 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARLongitudinalProfile.hh
+/// \brief Definition of the NNBARLongitudinalProfile class
+
+#ifndef NNBAR_LONGITUDINAL_PROFILE_H
+#define NNBAR_LONGITUDINAL_PROFILE_H
+
+#include "globals.hh"
+#include <vector>
+
+class G4Material;
+
+/// Longitudinal profile of electromagnetic showers.
+///
+/// The energy deposited by a shower as a function of the depth t (in units
+/// of the radiation length X0) follows a gamma distribution,
+///   dE/dt = E b (bt)^(a-1) exp(-bt) / Gamma(a),
+/// with b = 0.5 and the maximum at t_max = (a-1)/b = ln(E/Ec) + C, where
+/// C = -0.5 for electrons and +0.5 for photons (PDG Review, "Passage of
+/// particles through matter"). The fraction contained up to a depth is the
+/// regularised incomplete gamma function P(a, bt). It is tabulated once per
+/// material on a grid of energies and depths and interpolated at runtime.
+
+class NNBARLongitudinalProfile {
+  public:
+
+    /// A default constructor.
+    NNBARLongitudinalProfile();
+
+    ~NNBARLongitudinalProfile();
+
+    /// Fills the tables for a material (radiation length and critical energy).
+    /// @param aMaterial A material of the calorimeter.
+    void Build( const G4Material* aMaterial );
+
+    /// Checks if the tables are filled.
+    inline G4bool IsBuilt() const { return fRadiationLength > 0; };
+
+    /// Gets the fraction of the shower energy deposited up to a depth.
+    /// @param aEnergy An energy of the incident particle.
+    /// @param aDepth A depth along the shower axis (length).
+    /// @param aPhoton True for photons, false for electrons and positrons.
+    G4double GetContainedFraction( G4double aEnergy, G4double aDepth, G4bool aPhoton ) const;
+
+    /// Gets the radiation length of the material.
+    inline G4double GetRadiationLength() const { return fRadiationLength; };
+
+    /// Computes the regularised lower incomplete gamma function P(a, x).
+    /// @param a A shape parameter (a > 0).
+    /// @param x An upper limit of the integral (x >= 0).
+    static G4double IncompleteGamma( G4double a, G4double x );
+
+  private:
+
+    /// Gets the shape parameter a of the profile.
+    G4double GetShape( G4double aEnergy, G4bool aPhoton ) const;
+
+    /// Number of energy nodes (log-spaced) and depth nodes (linear) of the tables.
+    static const G4int fNumberOfEnergyNodes = 51;
+    static const G4int fNumberOfDepthNodes = 201;
+
+    /// Range of log10(E/MeV) and of the depth (in X0) of the tables.
+    static constexpr G4double fLogEnergyMin = 0.;
+    static constexpr G4double fLogEnergyMax = 5.;
+    static constexpr G4double fMaxDepth = 40.;
+
+    /// Slope parameter b of the profile.
+    static constexpr G4double fBeta = 0.5;
+
+    /// Radiation length and critical energy of the material.
+    G4double fRadiationLength;
+    G4double fCriticalEnergy;
+
+    /// Tabulated contained fractions (energy node * depth nodes + depth node)
+    /// for electrons [0] and photons [1].
+    std::vector< G4double > fTable[2];
+};
+
+#endif
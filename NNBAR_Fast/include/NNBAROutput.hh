@@ -31,12 +31,40 @@
 #define NNBAR_OUTPUT_H
 
 #include "G4ThreeVector.hh"
+#include "G4AnalysisManager.hh"
 #include "globals.hh"
+#include "NNBAREventRecord.hh"
+#include "NNBARSkimFilter.hh"
+#include <chrono>
+#include <functional>
+#include <map>
+#include <set>
 #include <vector>
+
+class NNBAROutputWriter;
+class NNBARColumnarFileWriter;
+class NNBAROutputMessenger;
+
 /// Handling the saving to the file.
 ///
-/// A singleton class that manages creation, writing to and closing of the
-/// Root output file.
+/// A singleton class (one instance per thread) that manages creation, writing
+/// to and closing of the Root output file. The ntuple columns are bound to the
+/// buffers of the thread's instance. By default the rows are written by an
+/// output writer thread (NNBAROutputWriter), so the simulation does not wait
+/// on the serialisation of the file (/NNBAR/output/); the writer thread is
+/// then the only user of the analysis manager of the thread during the run
+/// and the histogram fills of an event are replayed by it. The ntuples are written
+/// to the Root file, to a columnar file (NNBARColumnarFile.hh) or to both.
+/// An optional skim expression (NNBARSkimFilter) selects the events written.
+/// The ntuples and columns written are chosen from macros, the ntuple IDs
+/// follow the booked ntuples; in the histogram-only mode no rows are written.
+/// In the flat layout, the Root ntuples have a row per deposit (particle,
+/// track, spot) with the event ID, and the "Events" ntuple gives the first row
+/// and the number of rows of each ntuple for each event. The "Summary" ntuple
+/// has a row per event with the totals of the calorimeters (NNBAREventSummary).
+/// The output can roll over to numbered shards after a number of events or a
+/// size: each shard is closed when full, so it can be analysed while the
+/// simulation goes on, and is listed in a manifest.
 /// @author Anna Zaborowska
 // Modified by Andre Nepomuceno
 
@@ -44,9 +72,21 @@ class NNBAROutput {
   public:
     
     /// Indicates to which ntuple to save the information.
-    enum SaveType { eNoSave, eSaveMC, eSaveTracker, eSaveEMCal, eSaveHCal };
+    enum SaveType { eNoSave, eSaveMC, eSaveTracker, eSaveEMCal, eSaveHCal, eSaveEMCalSpot };
+
+    /// The format of the ntuples: the Root file of G4AnalysisManager, the
+    /// columnar file (.nnbc, see NNBARColumnarFile.hh) or both. The histograms
+    /// are always written to the Root file.
+    enum Format { eRootFormat, eColumnarFormat, eBothFormats };
 
-    /// Allows the access to the unique NNBAROutput object.
+    /// The layout of the Root ntuples: a row per event with a vector per
+    /// column, or a row per deposit with scalar columns, the event ID, and the
+    /// "Events" ntuple with the first row and the number of rows of each
+    /// ntuple per event (the ntuples are not merged, the rows are those of the
+    /// file of the thread).
+    enum Layout { eVectorLayout, eFlatLayout };
+
+    /// Allows the access to the NNBAROutput object of the thread.
     /// @return A pointer to the NNBAROutput class.
     static NNBAROutput* Instance();
     
@@ -70,21 +110,27 @@ class NNBAROutput {
     void StartAnalysis( G4int runID );
     
     /// Calls the G4AnalysisManager::Instance(). 
-    /// It writes to the output file and close it.
+    /// It writes to the output file and close it, and reports the time spent
+    /// in the output during the run.
     void EndAnalysis();
     
     /// Creates Ntuples used to store information about particle (its ID, PDG code,
-    /// energy deposits, etc.). To be called for each event in NNBAREventAction.
+    /// energy deposits, etc.), with the columns bound to the buffers of the
+    /// thread. To be called at the beginning of each run in NNBARRunAction: the
+    /// ntuples are booked at the first run only, the analysis manager keeps them
+    /// for the following runs.
     void CreateNtuples();
     
     /// Creates histograms to combine information from all the events in the run.
-    /// To be called for each run in NNBARRunAction.
+    /// To be called for each run in NNBARRunAction (booked at the first run only).
     void CreateHistograms();
     
     /// Saves the information about the particle (track).
     /// @param aWhatToSave enum indicating what kind of information to store 
     ///                    (in which ntuple).
-    /// @param aPartID A unique ID within event (taken Geant TrackID).
+    /// @param aPartID A unique ID within event: the particle ID of the primary
+    ///                for the MC ntuple (the row of the particle), the Geant4
+    ///                track ID for the calorimeters.
     /// @param aPDG A PDG code of a particle.
     /// @param aVector A vector to be stored (particle momentum in tracker or
     ///                position of energy deposit in calorimeter).
@@ -92,18 +138,113 @@ class NNBAROutput {
     /// @param aEfficiency An efficiency of the detector that was used.
     /// @param aEnergy An energy deposit (for calorimeters only: 
     ///                NNBAROutput::SaveType::eEMCal or NNBAROutput::SaveType::eHCal).
+    /// @param aTime A time of the deposit.
+    /// @param aPhotoelectrons A number of photo-electrons (calorimeters only).
+    /// @param aVisibleEnergy A visible (quenched) energy (hadronic calorimeter only).
+    /// @param aFace An entry face, NNBARDetectorParametrisation::Face (calorimeters only).
+    /// @param aCosTheta A cosine of the incidence angle on the face (calorimeters only).
+    /// @param aParentID A Geant4 parent ID (calorimeters only).
+    /// @param aPrimary An index of the primary particle, NNBARTrackInformation 
+    ///                 (calorimeters only).
     void SaveTrack( SaveType aWhatToSave, G4int aPartID,  G4int aPDG, G4double aETruth,
                     G4ThreeVector aVector, G4double aResolution = 0,
-                    G4double aEfficiency = 1, G4double aEnergy = 0, G4double aTime = 0 ) ;
+                    G4double aEfficiency = 1, G4double aEnergy = 0, G4double aTime = 0,
+                    G4int aPhotoelectrons = 0, G4double aVisibleEnergy = 0,
+                    G4int aFace = -1, G4double aCosTheta = 0,
+                    G4int aParentID = 0, G4int aPrimary = -1 ) ;
+
+    /// Gets the number of rows of a calorimeter ntuple in the current event.
+    /// @param aWhatToSave eSaveEMCal or eSaveHCal.
+    G4int GetNumberOfDeposits( SaveType aWhatToSave ) const;
+
+    /// Overwrites the response of a calorimeter row saved earlier in the event
+    /// (for responses evaluated at the end of the event).
+    /// @param aWhatToSave eSaveEMCal or eSaveHCal.
+    /// @param aRow A row of the deposit in the current event.
+    /// @param aResolution A resolution of the detector that was used.
+    /// @param aEfficiency An efficiency of the detector that was used.
+    /// @param aEnergy An energy deposit.
+    void SetCalorimeterResponse( SaveType aWhatToSave, G4int aRow, G4double aResolution,
+                                 G4double aEfficiency, G4double aEnergy );
                     
-    void SaveEvent();
+    /// Writes the event (unless rejected by the skim) and clears the records.
+    /// @param aEventID The Geant4 ID of the event.
+    void SaveEvent( G4int aEventID );
     
-    /// Fills the histogram.
+    /// Fills the histogram (with the output writer thread, the fill is kept
+    /// in the event and replayed by the writer).
     /// @param HNo Number of a histogram (decided by the order of creation
     ///            in CreateHistograms(), the first one is 0).
     /// @param value A value to be filled into the histogram.
     void FillHistogram( G4int HNo, G4double value ) const;
 
+    /// Sets the format of the ntuples (from the next run).
+    inline void SetFormat( Format aFormat ) { fFormat = aFormat; };
+
+    /// Sets the compression of the Root file (from the next run).
+    /// @param aCodec "none" or "zlib" (the codecs of the Geant4 Root writer).
+    /// @param aLevel The compression level (1-9, 0 for none).
+    void SetCompression( const G4String& aCodec, G4int aLevel );
+
+    /// Sets the basket size of the Root ntuples, in bytes (0 for the default).
+    inline void SetBasketSize( G4int aBasketSize ) { fBasketSize = aBasketSize; };
+
+    /// Sets the number of entries of the Root ntuple baskets, after which
+    /// they are written (0 for the default).
+    inline void SetBasketEntries( G4int aBasketEntries ) { fBasketEntries = aBasketEntries; };
+
+    /// Stores a floating point column of the columnar file in fixed point (from
+    /// the next run): value = aMinimum + aScale * n, with n in 16 bits if the
+    /// range fits, in 32 bits otherwise. The values out of the range are clamped.
+    /// @param aColumn The name of the column (e.g. "emcal_X").
+    /// @param aMinimum The lower end of the range.
+    /// @param aMaximum The upper end of the range.
+    /// @param aScale The step of the values, 0 to store the column as is.
+    void SetFixedPoint( const G4String& aColumn, G4double aMinimum, G4double aMaximum, 
+                        G4double aScale );
+
+    /// Sets the skim expression selecting the events to write (compiled at
+    /// the beginning of the next run, see NNBARSkimFilter). An empty
+    /// expression writes all the events.
+    inline void SetSkim( const G4String& aExpression ) { fSkim.SetExpression( aExpression ); };
+
+    /// Enables or disables an ntuple (from the next run). The Root ntuples are
+    /// booked at the first run: an ntuple disabled then is not booked.
+    /// @param aNtuple The name of the ntuple (MC, Tracker, EMCAL, HCAL or Summary).
+    /// @param aEnabled If the ntuple is written.
+    void SetNtupleEnabled( const G4String& aNtuple, G4bool aEnabled );
+
+    /// Enables or disables a column. The Root ntuples get the columns enabled
+    /// at the first run, the columnar file at each run.
+    /// @param aColumn The name of the column (e.g. "emcal_spot_X").
+    /// @param aEnabled If the column is written.
+    void SetColumnEnabled( const G4String& aColumn, G4bool aEnabled );
+
+    /// Sets the histogram-only mode: no ntuple is booked or written, only the
+    /// histograms are saved (from the next run).
+    void SetHistogramsOnly( G4bool aHistogramsOnly );
+
+    /// Sets the layout of the Root ntuples (fixed at the first run, when the
+    /// ntuples are booked).
+    void SetLayout( Layout aLayout );
+
+    /// Sets the number of written events of a shard, per thread (from the next
+    /// run). The ntuples of the threads are merged only without shards, as
+    /// decided at the first run.
+    /// @param aEvents The number of events, 0 for no limit.
+    void SetShardEvents( G4int aEvents );
+
+    /// Sets the size of the files of a shard, per thread (from the next run).
+    /// @param aSize The size in bytes, 0 for no limit.
+    void SetShardSize( std::size_t aSize );
+
+    /// Sets if the rows are written by the output writer thread (from the next run).
+    inline void SetAsyncWriter( G4bool aAsync ) { fAsyncWriter = aAsync; };
+
+    /// Sets the memory limit of the events queued for the writer thread.
+    /// @param aLimit The limit in bytes.
+    void SetWriterMemoryLimit( std::size_t aLimit );
+
     ~NNBAROutput();
 
   protected:
@@ -112,42 +253,17 @@ class NNBAROutput {
     NNBAROutput();
 
   private:
+
+    using Clock = std::chrono::steady_clock;
   
-  std::vector<G4int> fParticleIDVec;
-  std::vector<G4int> fPIDVec;
-  std::vector<G4double> fMC_KEnergy;
-  std::vector<G4double> fMC_XVec;
-  std::vector<G4double> fMC_YVec;
-  std::vector<G4double> fMC_ZVec;
-
-  std::vector<G4double> fTrackerResVec;
-  std::vector<G4double> fTrackerEffVec;
-  std::vector<G4double> fTracker_pXVec;
-  std::vector<G4double> fTracker_pYVec;
-  std::vector<G4double> fTracker_pZVec;
-  
-  std::vector<G4int>    fEmcalPDGVec;
-  std::vector<G4double> fEmcalETruthVec;
-  std::vector<G4double> fEmcalResVec;
-  std::vector<G4double> fEmcalEffVec;
-  std::vector<G4double> fEmcalXVec;
-  std::vector<G4double> fEmcalYVec;
-  std::vector<G4double> fEmcalZVec;
-  std::vector<G4double> fEmcalEVec;
-  std::vector<G4double> fEmcalTimeVec;
-      
-  std::vector<G4int>    fHcalPDGVec;
-  std::vector<G4double> fHcalETruthVec;
-  std::vector<G4double> fHcalResVec;
-  std::vector<G4double> fHcalEffVec;
-  std::vector<G4double> fHcalXVec;
-  std::vector<G4double> fHcalYVec;
-  std::vector<G4double> fHcalZVec;
-  std::vector<G4double> fHcalEVec;
-  std::vector<G4double> fHcalTimeVec;
-
-    /// The pointer to the only NNBAROutput class object.
-    static NNBAROutput* fNNBAROutput;
+    /// The event bound to the ntuple columns (see NNBAREventRecord.hh).
+    NNBAROutputEvent fBoundEvent;
+
+    /// The event being filled: the bound one, or one of the writer thread.
+    NNBAROutputEvent* fEvent;
+
+    /// The pointer to the NNBAROutput class object of the thread.
+    static G4ThreadLocal NNBAROutput* fNNBAROutput;
 
     /// Current ntuple Id 
     static G4ThreadLocal G4int fCurrentNtupleId;
@@ -162,7 +278,237 @@ class NNBAROutput {
     /// match the same particle. It is set when Monte Carlo information is saved
     /// and checked for all the detectors.
     static G4ThreadLocal G4int fCurrentID;
-    
+
+    /// If the ntuples are booked.
+    G4bool fNtuplesCreated;
+
+    /// If the histograms are booked.
+    G4bool fHistogramsCreated;
+
+    /// Time spent in booking the ntuples (in seconds).
+    G4double fBookingTime;
+
+    /// Time spent in saving the events of the run (in seconds).
+    G4double fSaveTime;
+
+    /// Number of events saved in the run.
+    G4int fSavedEvents;
+
+    /// If the rows are written by the writer thread. Default: true.
+    G4bool fAsyncWriter;
+
+    /// The memory limit of the events queued for the writer thread.
+    std::size_t fWriterMemoryLimit;
+
+    /// The output writer thread (created at the first asynchronous run).
+    NNBAROutputWriter* fWriter;
+
+    /// The format of the ntuples. Default: Root.
+    Format fFormat;
+
+    /// The columnar file of the run (opened at the first event).
+    NNBARColumnarFileWriter* fColumnarWriter;
+
+    /// The name of the columnar file of the run (empty if it cannot be opened).
+    G4String fColumnarFileName;
+
+    /// Writes the rows of the bound event, in the simulation thread or in the
+    /// writer thread.
+    std::function< void() > fWriteRows;
+
+    /// Appends the bound event to the columnar file.
+    void WriteColumnar();
+
+    /// Adds the Root write time and the size of the Root files of the thread to
+    /// the totals; the master reports the size of the files and the throughput.
+    void ReportRootWrite();
+
+    /// The compression level of the Root file. Default: 1 (zlib).
+    G4int fCompressionLevel;
+
+    /// The basket size of the Root ntuples (0 for the default).
+    G4int fBasketSize;
+
+    /// The number of entries of the Root ntuple baskets (0 for the default).
+    G4int fBasketEntries;
+
+    /// Time spent in writing the Root rows and file in the run (in seconds).
+    G4double fRootWriteTime;
+
+    /// Size of the Root files (shards) of the thread closed in the run (in bytes).
+    std::size_t fRootWrittenSize;
+
+    /// Time spent in writing the Root output by all the threads in the run
+    /// (in seconds), reported by the master.
+    static G4double fTotalRootWriteTime;
+
+    /// Size of the Root files of all the threads in the run (in bytes),
+    /// reported by the master.
+    static std::size_t fTotalRootWrittenSize;
+
+    /// The range and scale of a column stored in fixed point.
+    struct FixedPoint {
+      G4double fMinimum;
+      G4double fMaximum;
+      G4double fScale;
+    };
+
+    /// The columns of the columnar file stored in fixed point.
+    std::map< G4String, FixedPoint > fFixedPoint;
+
+    /// The selection of the events to write.
+    NNBARSkimFilter fSkim;
+
+    /// Number of events rejected by the skim in the run.
+    G4int fRejectedEvents;
+
+    /// Numbers of events accepted and rejected by the skim in all the threads
+    /// in the run, reported by the master.
+    static G4int fTotalAcceptedEvents;
+    static G4int fTotalRejectedEvents;
+
+    /// Adds the skim counts of the thread to the totals; the master reports them.
+    void ReportSkim();
+
+    /// The names of the ntuples and columns not written.
+    std::set< G4String > fDisabledNtuples;
+    std::set< G4String > fDisabledColumns;
+
+    /// If only the histograms are saved. Default: false.
+    G4bool fHistogramsOnly;
+
+    /// The Root ntuple ID of each record (-1 if it is not booked).
+    std::vector< G4int > fNtupleIds;
+
+    /// If the records are written in the run.
+    std::vector< G4bool > fWrittenNtuples;
+
+    /// If the columns (of all the records) are in the columnar file of the run.
+    std::vector< G4bool > fColumnarColumns;
+
+    /// Warns that the Root ntuples are booked and the change does not apply
+    /// to them.
+    /// @param aMessage The consequence of the change.
+    void WarnBooked( const G4String& aMessage ) const;
+
+    /// Checks if a record has a booked Root ntuple.
+    /// @param aRecord The index of the record.
+    G4bool IsBooked( std::size_t aRecord ) const;
+
+    /// The names of the records (the ntuples of the vector layout).
+    std::vector< G4String > fRecordNames;
+
+    /// The layout of the next booking, and the one of the booked ntuples.
+    Layout fLayout;
+    Layout fBookedLayout;
+
+    /// A table of the flat layout (see NNBAROutputEvent::ForEachTable()).
+    struct FlatTable {
+      /// The ntuple ID (-1 if not booked).
+      G4int fNtupleId;
+      /// The IDs of the columns (-1 if not booked).
+      std::vector< G4int > fColumnIds;
+      /// The IDs of the first row and number of rows columns of "Events".
+      G4int fOffsetColumn;
+      G4int fCountColumn;
+      /// The rows written to the file in the run.
+      G4int fRows;
+    };
+
+    /// The tables of the flat layout.
+    std::vector< FlatTable > fFlatTables;
+
+    /// The ID of the "Events" ntuple of the flat layout.
+    G4int fEventsNtupleId;
+
+    /// Books the ntuples of the flat layout.
+    void CreateFlatNtuples();
+
+    /// Writes the rows of the bound event in the flat layout.
+    void WriteFlatRows( G4AnalysisManager* aManager );
+
+    /// If the summary is written in the run. Default: true.
+    G4bool fWriteSummary;
+
+    /// The ID of the "Summary" ntuple (-1 if not booked) and of its columns.
+    G4int fSummaryNtupleId;
+    std::vector< G4int > fSummaryColumnIds;
+
+    /// Books the "Summary" ntuple (in both layouts).
+    void CreateSummaryNtuple();
+
+    /// Writes the summary of the bound event.
+    void WriteSummaryRow( G4AnalysisManager* aManager );
+
+    /// Fills the summary of the event being filled, in a single pass over
+    /// the calorimeter records.
+    void Summarise();
+
+    /// Clears the event without writing its rows; with the writer thread, the
+    /// event is still handed over for its histogram fills.
+    void SkipEvent();
+
+    /// The number of events and the size (in bytes) of a shard (0 for no limit).
+    G4int fShardEvents;
+    std::size_t fShardSize;
+
+    /// If the output of the run is split in shards.
+    G4bool fSharded;
+
+    /// If the Root ntuples of the threads are merged (decided at the booking).
+    G4bool fMergedNtuples;
+
+    /// The name of the output without the extension.
+    G4String fBaseName;
+
+    /// The ID of the run.
+    G4int fRunID;
+
+    /// The index of the current shard.
+    G4int fShard;
+
+    /// The number of events written to the current shard, and the IDs of the
+    /// first and the last one.
+    G4int fShardWrittenEvents;
+    G4int fShardFirstEvent;
+    G4int fShardLastEvent;
+
+    /// The size of the Root file of the current shard, at its last check.
+    std::size_t fShardRootSize;
+
+    /// The number of events between the checks of the size of the Root file.
+    static const G4int fShardSizeCheckInterval = 100;
+
+    /// The run listed in the manifest (it is rewritten at each run).
+    static G4int fManifestRunID;
+
+    /// Gets the name of the output of the thread without the extension: the
+    /// base name with the index of the shard (the master of a multithreaded
+    /// run, which writes the merged histograms, keeps the base name).
+    G4String GetOutputName() const;
+
+    /// Gets the name of a file of the thread (with the thread ID of the workers).
+    /// @param aExtension The extension, with the dot.
+    G4String GetThreadFileName( const G4String& aExtension ) const;
+
+    /// Opens the Root file of the current shard (the columnar file is opened
+    /// at its first event).
+    void OpenShard();
+
+    /// Writes and closes the files of the current shard and lists them in the
+    /// manifest.
+    void CloseShard();
+
+    /// Checks if the current shard has reached its number of events or size.
+    /// The size is that counted by the columnar writer, plus that of the Root
+    /// file on disk (checked every fShardSizeCheckInterval events).
+    G4bool IsShardFull();
+
+    /// Appends the files of the current shard to the manifest.
+    void AddToManifest();
+
+    /// A messenger of the output (/NNBAR/output/).
+    NNBAROutputMessenger* fMessenger;
 };
 
 #endif
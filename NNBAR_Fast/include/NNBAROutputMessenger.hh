@@ -0,0 +1,112 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBAROutputMessenger.hh
+/// \brief Definition of the NNBAROutputMessenger class
+
+#ifndef NNBAR_OUTPUT_MESSENGER_H
+#define NNBAR_OUTPUT_MESSENGER_H
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class NNBAROutput;
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithABool;
+class G4UIcmdWithADouble;
+class G4UIcmdWithAString;
+class G4UIcmdWithAnInteger;
+
+/// Messenger of the NNBAROutput.
+///
+/// Defines the commands of the output (/NNBAR/output/). Each thread has its
+/// own NNBAROutput and messenger, the commands are broadcast to the workers.
+
+class NNBAROutputMessenger : public G4UImessenger {
+  public:
+
+    /// A constructor.
+    /// @param aOutput The output of the thread.
+    NNBAROutputMessenger( NNBAROutput* aOutput );
+
+    virtual ~NNBAROutputMessenger();
+
+    /// Applies a command.
+    virtual void SetNewValue( G4UIcommand* aCommand, G4String aNewValue );
+
+  private:
+
+    /// The output of the thread.
+    NNBAROutput* fOutput;
+
+    /// The /NNBAR/output/ directory.
+    G4UIdirectory* fDirectory;
+
+    /// The /NNBAR/output/asyncWriter command.
+    G4UIcmdWithABool* fAsyncWriterCmd;
+
+    /// The /NNBAR/output/writerMemoryLimit command.
+    G4UIcmdWithADouble* fWriterMemoryLimitCmd;
+
+    /// The /NNBAR/output/format command.
+    G4UIcmdWithAString* fFormatCmd;
+
+    /// The /NNBAR/output/compression command.
+    G4UIcommand* fCompressionCmd;
+
+    /// The /NNBAR/output/basketSize command.
+    G4UIcmdWithAnInteger* fBasketSizeCmd;
+
+    /// The /NNBAR/output/basketEntries command.
+    G4UIcmdWithAnInteger* fBasketEntriesCmd;
+
+    /// The /NNBAR/output/fixedPoint command.
+    G4UIcommand* fFixedPointCmd;
+
+    /// The /NNBAR/output/skim command.
+    G4UIcmdWithAString* fSkimCmd;
+
+    /// The /NNBAR/output/ntuple command.
+    G4UIcommand* fNtupleCmd;
+
+    /// The /NNBAR/output/column command.
+    G4UIcommand* fColumnCmd;
+
+    /// The /NNBAR/output/histogramsOnly command.
+    G4UIcmdWithABool* fHistogramsOnlyCmd;
+
+    /// The /NNBAR/output/layout command.
+    G4UIcmdWithAString* fLayoutCmd;
+
+    /// The /NNBAR/output/shardEvents command.
+    G4UIcmdWithAnInteger* fShardEventsCmd;
+
+    /// The /NNBAR/output/shardSize command.
+    G4UIcmdWithADouble* fShardSizeCmd;
+};
+
+#endif
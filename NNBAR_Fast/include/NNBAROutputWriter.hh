@@ -0,0 +1,155 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBAROutputWriter.hh
+/// \brief Definition of the NNBAROutputWriter class
+
+#ifndef NNBAR_OUTPUT_WRITER_H
+#define NNBAR_OUTPUT_WRITER_H
+
+#include "NNBAREventRecord.hh"
+#include "NNBARSPSCQueue.hh"
+#include "globals.hh"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// An output writer thread.
+///
+/// The simulation thread fills an event (NNBAROutputEvent) and submits it
+/// once complete; the writer thread moves it into the event bound to the
+/// ntuples and writes the rows, so the serialisation and compression of the
+/// output do not stall the simulation. The events are passed through
+/// lock-free queues (NNBARSPSCQueue) and recycled with their capacity: while
+/// the writer writes one event, the simulation fills the next one. The
+/// simulation thread waits only if the events in the queue use more memory
+/// than the limit (backpressure); the waiting time is reported. The idle
+/// writer and the waiting simulation thread sleep on condition variables,
+/// notified when an event is pushed or popped. The writer thread takes the
+/// Geant4 thread ID of the simulation thread it serves.
+
+class NNBAROutputWriter {
+  public:
+
+    /// A constructor.
+    /// @param aBoundEvent The event bound to the ntuple columns.
+    /// @param aWriteRow A function writing the rows of the bound event.
+    NNBAROutputWriter( NNBAROutputEvent& aBoundEvent, std::function< void() > aWriteRow );
+
+    /// A destructor. Writes the queued events.
+    ~NNBAROutputWriter();
+
+    /// Gets an empty event to be filled (simulation thread).
+    NNBAROutputEvent* Acquire();
+
+    /// Hands a complete event to the writer (simulation thread). Waits while
+    /// the queue is over the memory limit. The writer thread is started at the
+    /// first call after the construction or Stop().
+    /// @param aEvent An event obtained with Acquire().
+    void Submit( NNBAROutputEvent* aEvent );
+
+    /// Writes all the queued events and stops the writer thread.
+    void Stop();
+
+    /// Sets the memory limit of the queued events (in bytes).
+    inline void SetMemoryLimit( std::size_t aLimit ) { fMemoryLimit = aLimit; };
+
+    /// Gets the time the simulation thread waited on the writer (in seconds)
+    /// since the last reset.
+    inline G4double GetWaitTime() const { return fWaitTime; };
+
+    /// Gets the peak memory of the queued events (in bytes) since the last reset.
+    inline std::size_t GetPeakMemory() const { return fPeakMemory; };
+
+    /// Resets the waiting time and the peak memory.
+    inline void ResetStatistics() { fWaitTime = 0; fPeakMemory = 0; };
+
+  private:
+
+    using Clock = std::chrono::steady_clock;
+
+    /// The loop of the writer thread.
+    void Run();
+
+    /// Wakes up the threads waiting on a condition.
+    /// @param aCondition The condition.
+    void Notify( std::condition_variable& aCondition );
+
+    /// The maximum number of events in flight.
+    static const std::size_t fCapacity = 1024;
+
+    /// The event bound to the ntuple columns.
+    NNBAROutputEvent& fBoundEvent;
+
+    /// Writes the rows of the bound event.
+    std::function< void() > fWriteRow;
+
+    /// The events (owned by the writer, allocated by the simulation thread).
+    std::vector< std::unique_ptr< NNBAROutputEvent > > fEvents;
+
+    /// Complete events, from the simulation thread to the writer.
+    NNBARSPSCQueue< NNBAROutputEvent* > fQueue;
+
+    /// Written (empty) events, from the writer back to the simulation thread.
+    NNBARSPSCQueue< NNBAROutputEvent* > fFreeEvents;
+
+    /// The memory of the queued events (in bytes).
+    std::atomic< std::size_t > fQueuedMemory;
+
+    /// The memory limit of the queued events (in bytes).
+    std::size_t fMemoryLimit;
+
+    /// Set to stop the writer thread once the queue is empty.
+    std::atomic< G4bool > fStop;
+
+    /// The writer thread.
+    std::thread fThread;
+
+    /// The Geant4 thread ID of the simulation thread.
+    G4int fThreadId;
+
+    /// Guards the waits on the conditions below (the queues are lock-free).
+    std::mutex fMutex;
+
+    /// Signalled when an event is queued or the writer is stopped.
+    std::condition_variable fQueued;
+
+    /// Signalled when an event is written (its memory and the event are free).
+    std::condition_variable fWritten;
+
+    /// Time the simulation thread waited (in seconds).
+    G4double fWaitTime;
+
+    /// Peak memory of the queued events (in bytes).
+    std::size_t fPeakMemory;
+};
+
+#endif
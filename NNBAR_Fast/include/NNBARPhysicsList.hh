@@ -33,22 +33,57 @@
 #include "G4VUserPhysicsList.hh"
 #include "globals.hh"
 
+class NNBARPhysicsListMessenger;
+
 /// Construction of a physics list.
 ///
 /// A mandatory initialization class of the physics list. 
 /// For the purposes of fast simulation, only transportation, decays and
-/// parametrisation is used. Based on G4 
+/// parametrisation is used. In the hybrid mode (/NNBAR/physics/hybrid, or
+/// the constructor argument) the standard electromagnetic processes are
+/// registered as well, so that the regions switched to the full simulation
+/// (see NNBARRegionInformation) are tracked in detail. Based on G4 
 /// examples/extended/parametrisations/Par01/include/Par01PhysicsList.hh .
 /// @author Anna Zaborowska
 
 class NNBARPhysicsList : public G4VUserPhysicsList {
   public:
+
+    /// Registration of the fast simulation process: along and post step
+    /// (general, needed for parallel geometries) or post step only (discrete,
+    /// enough for the models placed in the mass geometry, as here).
+    enum Registration { eGeneralRegistration, eDiscreteRegistration };
     
     /// A default constructor. Sets the default cut value.
-    NNBARPhysicsList();
+    /// @param aHybrid If the electromagnetic processes are registered (hybrid mode).
+    NNBARPhysicsList( G4bool aHybrid = false );
 
     virtual ~NNBARPhysicsList();
 
+    /// Sets the hybrid mode. Used before the initialisation only.
+    inline void SetHybrid( G4bool aHybrid ) { fHybrid = aHybrid; };
+
+    /// Checks if the physics list is in the hybrid mode.
+    inline G4bool IsHybrid() const { return fHybrid; };
+
+    /// Sets the registration of the fast simulation process. Used before the
+    /// initialisation only.
+    inline void SetFastSimRegistration( Registration aRegistration ) { 
+      fFastSimRegistration = aRegistration; };
+
+    /// Sets if the fast simulation process is registered only for the particle
+    /// types of the models. Used before the initialisation only.
+    inline void SetFastSimApplicableOnly( G4bool aApplicableOnly ) {
+      fFastSimApplicableOnly = aApplicableOnly; };
+
+    /// Sets if the overhead of the fast simulation process is measured
+    /// (NNBARProcessTimer). Used before the initialisation only.
+    inline void SetFastSimTiming( G4bool aTiming ) { fFastSimTiming = aTiming; };
+
+    /// Checks if any hadronic process is registered (for neutrons, protons
+    /// or charged pions). Used after the initialisation only.
+    static G4bool HasHadronicProcesses();
+
   protected:
     
     /// Constructs particles: bosons, leptons, mesons, baryons and ions.
@@ -76,7 +111,9 @@ class NNBARPhysicsList : public G4VUserPhysicsList {
     /// Constructs light ions.
     virtual void ConstructIons();
 
-    /// Creates a G4FastSimulationManagerProcess object for all the particle types.
+    /// Creates a G4FastSimulationManagerProcess object for all the particle types
+    /// (or for the types of the models only), registered as set by
+    /// SetFastSimRegistration().
     void AddParameterisation();
 
     /// Adds decay process.
@@ -86,6 +123,30 @@ class NNBARPhysicsList : public G4VUserPhysicsList {
     /// G4CoupledTransportation is used to allow the calculation of the expected
     /// position of the particle within a G4VFastSimulationModel.
     virtual void AddTransportation();
+
+    /// Adds the standard electromagnetic processes (hybrid mode only).
+    virtual void ConstructEM();
+
+  private:
+
+    /// Checks if any of the fast simulation models applies to a particle type.
+    static G4bool IsParametrised( const G4ParticleDefinition& aParticle );
+
+    /// If the electromagnetic processes are registered. Default: false.
+    G4bool fHybrid;
+
+    /// The registration of the fast simulation process. Default: general.
+    Registration fFastSimRegistration;
+
+    /// If the fast simulation process is registered for the particle types of
+    /// the models only. Default: false.
+    G4bool fFastSimApplicableOnly;
+
+    /// If the overhead of the fast simulation process is measured. Default: false.
+    G4bool fFastSimTiming;
+
+    /// A messenger of the physics list (/NNBAR/physics/).
+    NNBARPhysicsListMessenger* fMessenger;
 };
 
 #endif
@@ -0,0 +1,90 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARPhysicsListMessenger.hh
+/// \brief Definition of the NNBARPhysicsListMessenger class
+
+#ifndef NNBAR_PHYSICS_LIST_MESSENGER_H
+#define NNBAR_PHYSICS_LIST_MESSENGER_H
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class NNBARPhysicsList;
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithABool;
+class G4UIcmdWithAString;
+
+/// Messenger of the NNBARPhysicsList.
+///
+/// Defines the commands of the hybrid fast/full simulation (/NNBAR/physics/):
+/// the hybrid mode itself (before the initialisation, see the -p option of
+/// the main program), the simulation mode of a region and the accounting of
+/// the time per region (NNBARRegionTimer), and the registration of the fast
+/// simulation process with the measurement of its overhead (NNBARProcessTimer). The regions and the timer settings
+/// are shared by all the threads, so the commands are not broadcast.
+
+class NNBARPhysicsListMessenger : public G4UImessenger {
+  public:
+
+    /// A constructor.
+    /// @param aPhysicsList The physics list.
+    NNBARPhysicsListMessenger( NNBARPhysicsList* aPhysicsList );
+
+    virtual ~NNBARPhysicsListMessenger();
+
+    /// Applies a command.
+    virtual void SetNewValue( G4UIcommand* aCommand, G4String aNewValue );
+
+  private:
+
+    /// The physics list.
+    NNBARPhysicsList* fPhysicsList;
+
+    /// The /NNBAR/physics/ directory.
+    G4UIdirectory* fDirectory;
+
+    /// The /NNBAR/physics/hybrid command.
+    G4UIcmdWithABool* fHybridCmd;
+
+    /// The /NNBAR/physics/fullSimRegion command.
+    G4UIcommand* fFullSimRegionCmd;
+
+    /// The /NNBAR/physics/regionTiming command.
+    G4UIcmdWithABool* fRegionTimingCmd;
+
+    /// The /NNBAR/physics/fastSimRegistration command.
+    G4UIcmdWithAString* fRegistrationCmd;
+
+    /// The /NNBAR/physics/fastSimApplicableOnly command.
+    G4UIcmdWithABool* fApplicableOnlyCmd;
+
+    /// The /NNBAR/physics/fastSimTiming command.
+    G4UIcmdWithABool* fFastSimTimingCmd;
+};
+
+#endif
@@ -0,0 +1,126 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARProcessTimer.hh
+/// \brief Definition of the NNBARProcessTimer class
+
+#ifndef NNBAR_PROCESS_TIMER_H
+#define NNBAR_PROCESS_TIMER_H
+
+#include "G4WrapperProcess.hh"
+#include "globals.hh"
+#include <chrono>
+
+/// Measurement of the per-step overhead of a process.
+///
+/// Wraps a process (the G4FastSimulationManagerProcess, see
+/// NNBARPhysicsList::AddParameterisation()) and accounts the time spent in
+/// its step limitation and DoIt methods. The steps of all the particles are
+/// counted by NNBARSteppingAction, so the overhead per step of the different
+/// registrations of the process (general or discrete, all or applicable
+/// particles only) can be compared between runs. The accounts of the worker
+/// threads are merged at the end of the run and printed by the master; the
+/// cost of reading the clock is measured and subtracted.
+
+class NNBARProcessTimer : public G4WrapperProcess {
+  public:
+
+    /// A constructor.
+    /// @param aProcess The process to be timed.
+    NNBARProcessTimer( G4VProcess* aProcess );
+
+    virtual ~NNBARProcessTimer();
+
+    /// Times the post-step interaction length of the wrapped process.
+    virtual G4double PostStepGetPhysicalInteractionLength( const G4Track& aTrack,
+                                                           G4double aPreviousStepSize,
+                                                           G4ForceCondition* aCondition );
+
+    /// Times the along-step interaction length of the wrapped process.
+    virtual G4double AlongStepGetPhysicalInteractionLength( const G4Track& aTrack,
+                                                            G4double aPreviousStepSize,
+                                                            G4double aCurrentMinimumStep,
+                                                            G4double& aCurrentSafety,
+                                                            G4GPILSelection* aSelection );
+
+    /// Times the post-step action of the wrapped process.
+    virtual G4VParticleChange* PostStepDoIt( const G4Track& aTrack, const G4Step& aStep );
+
+    /// Times the along-step action of the wrapped process.
+    virtual G4VParticleChange* AlongStepDoIt( const G4Track& aTrack, const G4Step& aStep );
+
+    /// Enables or disables the step counting (set when the timer is created).
+    static void SetEnabled( G4bool aEnabled ) { fEnabled = aEnabled; };
+
+    /// Checks if the steps should be counted.
+    static inline G4bool IsEnabled() { return fEnabled; };
+
+    /// Counts a step of the thread (any particle).
+    static inline void CountStep() { fSteps++; };
+
+    /// Sets the description of the registration, printed in the report.
+    static void SetRegistration( const G4String& aRegistration ) { fRegistration = aRegistration; };
+
+    /// Merges the accounts of the thread; the master prints the merged report
+    /// and resets it.
+    /// @param aIsMaster If called by the master (or the only) thread.
+    static void EndOfRun( G4bool aIsMaster );
+
+  private:
+
+    using Clock = std::chrono::steady_clock;
+
+    /// Accounts the time since a start.
+    static inline void Account( Clock::time_point aStart ) {
+      fTime += std::chrono::duration< G4double >( Clock::now() - aStart ).count();
+      fCalls++;
+    };
+
+    /// Measures the time of a pair of clock readings (in seconds).
+    static G4double MeasureClockOverhead();
+
+    /// If the steps are counted.
+    static G4bool fEnabled;
+
+    /// The description of the registration.
+    static G4String fRegistration;
+
+    /// Time spent in the wrapped process by the thread (in seconds).
+    static G4ThreadLocal G4double fTime;
+
+    /// Calls of the wrapped process by the thread.
+    static G4ThreadLocal G4long fCalls;
+
+    /// Steps of the thread.
+    static G4ThreadLocal G4long fSteps;
+
+    /// Time, calls and steps merged from all the threads.
+    static G4double fMergedTime;
+    static G4long fMergedCalls;
+    static G4long fMergedSteps;
+};
+
+#endif
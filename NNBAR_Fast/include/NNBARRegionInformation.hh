@@ -0,0 +1,86 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARRegionInformation.hh
+/// \brief Definition of the NNBARRegionInformation class
+
+#ifndef NNBAR_REGION_INFORMATION_H
+#define NNBAR_REGION_INFORMATION_H
+
+#include "G4VUserRegionInformation.hh"
+#include "NNBAROutput.hh"
+#include "G4Region.hh"
+#include "globals.hh"
+
+/// Information attached to the detector regions.
+///
+/// Holds the simulation mode of a region. In the hybrid mode (see
+/// NNBARPhysicsList) a region can be switched to the full simulation: the
+/// fast simulation models of the region do not trigger and the particles
+/// are tracked with the electromagnetic processes. The energy deposited
+/// in a fully simulated region is scored by NNBARFullSimScorer and saved
+/// with the save type of the region.
+
+class NNBARRegionInformation : public G4VUserRegionInformation {
+  public:
+
+    /// A default constructor (fast simulation).
+    /// @param aSaveType Record of the energy deposited in the region when it is
+    ///                  fully simulated (eNoSave: not scored).
+    NNBARRegionInformation( NNBAROutput::SaveType aSaveType = NNBAROutput::eNoSave );
+
+    virtual ~NNBARRegionInformation();
+
+    /// Prints the simulation mode.
+    virtual void Print() const;
+
+    /// Sets if the region is fully simulated.
+    inline void SetFullSimulation( G4bool aFullSimulation ) { fFullSimulation = aFullSimulation; };
+
+    /// Checks if the region is fully simulated.
+    inline G4bool IsFullSimulation() const { return fFullSimulation; };
+
+    /// Gets the record of the energy deposited in the region.
+    inline NNBAROutput::SaveType GetSaveType() const { return fSaveType; };
+
+    /// Checks if a region is fully simulated (regions without the information
+    /// are not).
+    /// @param aRegion A region (e.g. the envelope of a fast simulation model).
+    static inline G4bool IsFullSimulation( const G4Region* aRegion ) {
+      auto info = static_cast< const NNBARRegionInformation* >( aRegion->GetUserInformation() );
+      return info  &&  info->fFullSimulation;
+    };
+
+  private:
+
+    /// If the region is fully simulated. Default: false.
+    G4bool fFullSimulation;
+
+    /// The record of the energy deposited in the region.
+    NNBAROutput::SaveType fSaveType;
+};
+
+#endif
@@ -0,0 +1,106 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARRegionTimer.hh
+/// \brief Definition of the NNBARRegionTimer class
+
+#ifndef NNBAR_REGION_TIMER_H
+#define NNBAR_REGION_TIMER_H
+
+#include "globals.hh"
+#include <chrono>
+#include <map>
+#include <unordered_map>
+
+class G4Region;
+
+/// Accounting of the processing time per detector region.
+///
+/// A thread-local class: every step is charged with the time elapsed since
+/// the previous step (or since the start of the track) and attributed to the
+/// region of its pre-step point, so the fast simulation steps and the fully
+/// simulated regions of the hybrid mode (see NNBARRegionInformation) can be
+/// compared. The accounts of the worker threads are merged at the end of the
+/// run and printed by the master. Disabled by default: the accounting reads
+/// the clock at every step.
+
+class NNBARRegionTimer {
+  public:
+
+    /// Allows the access to the NNBARRegionTimer of the thread.
+    static NNBARRegionTimer* Instance();
+
+    /// Enables or disables the accounting (all threads).
+    static void SetEnabled( G4bool aEnabled ) { fEnabled = aEnabled; };
+
+    /// Checks if the accounting is enabled.
+    static inline G4bool IsEnabled() { return fEnabled; };
+
+    /// Starts the clock for a new track.
+    inline void StartTrack() { fLastStamp = Clock::now(); };
+
+    /// Charges the time since the last stamp to a region.
+    /// @param aRegion The region of the step.
+    inline void Stamp( const G4Region* aRegion ) {
+      Clock::time_point now = Clock::now();
+      Account& account = fAccounts[aRegion];
+      account.fTime += std::chrono::duration< G4double >( now - fLastStamp ).count();
+      account.fSteps++;
+      fLastStamp = now;
+    };
+
+    /// Merges the accounts of the thread; the master prints the merged report
+    /// and resets it.
+    /// @param aIsMaster If called by the master (or the only) thread.
+    void EndOfRun( G4bool aIsMaster );
+
+  private:
+
+    /// A default, private constructor (due to singleton pattern).
+    NNBARRegionTimer();
+
+    using Clock = std::chrono::steady_clock;
+
+    /// Time (in seconds) and number of steps of a region.
+    struct Account {
+      G4double fTime = 0;
+      G4long fSteps = 0;
+    };
+
+    /// If the accounting is enabled.
+    static G4bool fEnabled;
+
+    /// Accounts of the thread.
+    std::unordered_map< const G4Region*, Account > fAccounts;
+
+    /// The last stamp.
+    Clock::time_point fLastStamp;
+
+    /// Accounts merged from all the threads (per region name).
+    static std::map< G4String, Account > fMergedAccounts;
+};
+
+#endif
@@ -0,0 +1,95 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARSPSCQueue.hh
+/// \brief Definition of the NNBARSPSCQueue class
+
+#ifndef NNBAR_SPSC_QUEUE_H
+#define NNBAR_SPSC_QUEUE_H
+
+#include "globals.hh"
+#include <atomic>
+#include <vector>
+
+/// A lock-free single-producer single-consumer queue.
+///
+/// A ring buffer of a fixed capacity: TryPush() is called by one thread only
+/// and TryPop() by one other thread only. Neither of them blocks, they fail if
+/// the queue is full or empty.
+
+template< typename T >
+class NNBARSPSCQueue {
+  public:
+
+    /// A constructor.
+    /// @param aCapacity The maximum number of elements in the queue.
+    explicit NNBARSPSCQueue( std::size_t aCapacity ) : 
+      fBuffer( aCapacity + 1 ), fHead( 0 ), fTail( 0 ) {};
+
+    /// Adds an element (producer only).
+    /// @return False if the queue is full.
+    inline G4bool TryPush( const T& aElement ) {
+      std::size_t tail = fTail.load( std::memory_order_relaxed );
+      std::size_t next = Next( tail );
+      if ( next == fHead.load( std::memory_order_acquire ) ) return false;
+      fBuffer[tail] = aElement;
+      fTail.store( next, std::memory_order_release );
+      return true;
+    };
+
+    /// Removes the oldest element (consumer only).
+    /// @return False if the queue is empty.
+    inline G4bool TryPop( T& aElement ) {
+      std::size_t head = fHead.load( std::memory_order_relaxed );
+      if ( head == fTail.load( std::memory_order_acquire ) ) return false;
+      aElement = fBuffer[head];
+      fHead.store( Next( head ), std::memory_order_release );
+      return true;
+    };
+
+    /// Checks if the queue is empty.
+    inline G4bool IsEmpty() const {
+      return fHead.load( std::memory_order_acquire ) == fTail.load( std::memory_order_acquire );
+    };
+
+  private:
+
+    /// The position following a position in the ring.
+    inline std::size_t Next( std::size_t aPosition ) const {
+      return aPosition + 1 == fBuffer.size() ? 0 : aPosition + 1;
+    };
+
+    /// The ring buffer (one slot is kept empty).
+    std::vector< T > fBuffer;
+
+    /// The position of the oldest element (written by the consumer).
+    alignas( 64 ) std::atomic< std::size_t > fHead;
+
+    /// The position of the next element (written by the producer).
+    alignas( 64 ) std::atomic< std::size_t > fTail;
+};
+
+#endif
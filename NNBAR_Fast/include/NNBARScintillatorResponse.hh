@@ -0,0 +1,105 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARScintillatorResponse.hh
+/// \brief Definition of the NNBARScintillatorResponse class
+
+#ifndef NNBAR_SCINTILLATOR_RESPONSE_H
+#define NNBAR_SCINTILLATOR_RESPONSE_H
+
+#include "NNBARDetectorParametrisation.hh"
+#include "globals.hh"
+#include <vector>
+
+class G4Material;
+
+/// Light output of the plastic scintillator.
+///
+/// The visible (electron-equivalent) energy follows Birks' law,
+///   dL/dE = 1 / ( 1 + kB dE/dx ),
+/// with the stopping power given by the Bethe formula in the scintillator
+/// material. For each hadron species the cumulative light F(T) of a particle
+/// slowing down from the kinetic energy T to rest is tabulated once, so that
+/// the light of a deposit Edep is F(T) - F(T - Edep). Neutral hadrons are seen
+/// through recoil protons (or heavier fragments) that stop in the scintillator,
+/// so they use the proton table evaluated at the deposited energy.
+
+class NNBARScintillatorResponse {
+  public:
+
+    /// A default constructor.
+    NNBARScintillatorResponse();
+
+    ~NNBARScintillatorResponse();
+
+    /// Fills the tables for a material.
+    /// @param aMaterial A material of the scintillator.
+    /// @param aBirksConstant Birks' constant kB (length/energy).
+    void Build( const G4Material* aMaterial, G4double aBirksConstant );
+
+    /// Checks if the tables are filled.
+    inline G4bool IsBuilt() const { return ! fTable[0].empty(); };
+
+    /// Gets the Birks constant used for the tables.
+    inline G4double GetBirksConstant() const { return fBirksConstant; };
+
+    /// Gets the visible energy of a deposit.
+    /// @param aSpecies A hadron species (NNBARDetectorParametrisation::HadronSpecies,
+    ///                 -1 for the other hadrons).
+    /// @param aKenergy A kinetic energy of the particle.
+    /// @param aDeposit A deposited energy (at most aKenergy).
+    G4double GetVisibleEnergy( G4int aSpecies, G4double aKenergy, G4double aDeposit ) const;
+
+  private:
+
+    /// Stopping power of a particle of unit charge in the scintillator.
+    /// @param aMass A mass of the particle.
+    /// @param aKenergy A kinetic energy of the particle.
+    inline G4double GetStoppingPower( G4double aMass, G4double aKenergy ) const {
+      return NNBARDetectorParametrisation::GetStoppingPower( fElectronDensity, 
+               fMeanExcitationEnergy, aMass, 1., aKenergy );
+    };
+
+    /// Interpolates the cumulative light table of a species.
+    G4double GetCumulativeLight( G4int aTable, G4double aKenergy ) const;
+
+    /// Number of (log-spaced) energy nodes of the tables and their range.
+    static const G4int fNumberOfNodes = 200;
+    static constexpr G4double fMinEnergy = 1e-3;  // MeV
+    static constexpr G4double fMaxEnergy = 1e4;   // MeV
+
+    /// Birks' constant.
+    G4double fBirksConstant;
+
+    /// Electron density and mean excitation energy of the material.
+    G4double fElectronDensity;
+    G4double fMeanExcitationEnergy;
+
+    /// Cumulative light F(T) at the nodes, per hadron species.
+    std::vector< G4double > fTable[NNBARDetectorParametrisation::eNumberOfHadronSpecies];
+};
+
+#endif
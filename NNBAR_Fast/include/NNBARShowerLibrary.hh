@@ -0,0 +1,146 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARShowerLibrary.hh
+/// \brief Definition of the NNBARShowerLibrary class
+
+#ifndef NNBAR_SHOWER_LIBRARY_H
+#define NNBAR_SHOWER_LIBRARY_H
+
+#include "globals.hh"
+#include <cstdint>
+#include <map>
+#include <vector>
+
+/// A library of frozen electromagnetic showers.
+///
+/// A singleton class giving access to showers pre-simulated with full Geant4
+/// in the lead glass of the electromagnetic calorimeter. The library file is
+/// memory-mapped (read-only), so all the threads share one copy of it. At load
+/// time a binned index in (log10 energy, cosine of the incidence angle) is built
+/// for each PDG code and FindShower() returns the nearest stored shower.
+///
+/// File format (little-endian, no padding):
+///  - Header: char[8] "NNBARSL1", uint32 version (1), uint32 number of showers,
+///            uint64 number of spots;
+///  - Shower records: float energy [MeV], float cos(theta), int32 PDG code,
+///                    uint32 index of the first spot, uint32 number of spots;
+///  - Spot records: float depth along the incidence direction [mm],
+///                  float two transverse coordinates [mm],
+///                  float fraction of the shower energy.
+
+class NNBARShowerLibrary {
+  public:
+
+    /// A single energy deposit of a shower.
+    struct Spot {
+      float fDepth;
+      float fTransverseU;
+      float fTransverseV;
+      float fEnergyFraction;
+    };
+
+    /// A shower stored in the library.
+    struct Shower {
+      float fEnergy;
+      float fCosTheta;
+      std::int32_t fPDG;
+      std::uint32_t fFirstSpot;
+      std::uint32_t fNumberOfSpots;
+    };
+
+    /// Allows the access to the unique NNBARShowerLibrary object.
+    /// @return A pointer to the NNBARShowerLibrary class.
+    static NNBARShowerLibrary* Instance();
+
+    ~NNBARShowerLibrary();
+
+    /// Maps the library file and builds the index. Loading the file that is
+    /// already loaded does nothing, so it can be requested by every thread.
+    /// @param aFileName A name of the library file.
+    /// @return True if the library is available.
+    G4bool Load( const G4String& aFileName );
+
+    /// Checks if a library is loaded.
+    inline G4bool IsLoaded() const { return fShowers != nullptr; };
+
+    /// Finds the stored shower closest to the given parameters.
+    /// @param aEnergy An energy of the incident particle.
+    /// @param aCosTheta A cosine of the incidence angle.
+    /// @param aPDG A PDG code of the incident particle (the charge conjugate
+    ///             is used if the particle itself is not in the library).
+    /// @return A pointer to the shower, or nullptr if no shower is available.
+    const Shower* FindShower( G4double aEnergy, G4double aCosTheta, G4int aPDG ) const;
+
+    /// Gets the spots of a shower.
+    /// @param aShower A shower found with FindShower().
+    inline const Spot* GetSpots( const Shower* aShower ) const
+      { return fSpots + aShower->fFirstSpot; };
+
+  protected:
+
+    /// A default, protected constructor (due to singleton pattern).
+    NNBARShowerLibrary();
+
+  private:
+
+    /// Unmaps the library file and clears the index.
+    void Unload();
+
+    /// Builds the binned index of the showers.
+    void BuildIndex();
+
+    /// Gets the energy bin of a value of log10(E/MeV).
+    G4int GetEnergyBin( G4double aLogEnergy ) const;
+
+    /// Gets the angle bin of a value of cos(theta).
+    G4int GetAngleBin( G4double aCosTheta ) const;
+
+    /// Number of bins in log10(E) and in cos(theta) of the index.
+    static const G4int fNumberOfEnergyBins = 24;
+    static const G4int fNumberOfAngleBins = 10;
+
+    /// A name of the loaded file.
+    G4String fFileName;
+
+    /// The mapped file and its size.
+    void* fMapping;
+    std::size_t fMappingSize;
+
+    /// The shower and spot records (inside the mapped file).
+    const Shower* fShowers;
+    const Spot* fSpots;
+    std::uint32_t fNumberOfShowers;
+
+    /// Range of log10(E/MeV) covered by the index.
+    G4double fLogEnergyMin;
+    G4double fLogEnergyMax;
+
+    /// Shower indices per PDG code and per bin (energy bin * angle bins + angle bin).
+    std::map< G4int, std::vector< std::vector< std::uint32_t > > > fIndex;
+};
+
+#endif
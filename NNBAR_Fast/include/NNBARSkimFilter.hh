@@ -0,0 +1,156 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARSkimFilter.hh
+/// \brief Definition of the NNBARSkimFilter class
+
+#ifndef NNBAR_SKIM_FILTER_H
+#define NNBAR_SKIM_FILTER_H
+
+#include "globals.hh"
+#include "NNBAREventRecord.hh"
+#include <vector>
+
+/// Selection of the events saved by NNBAROutput.
+///
+/// An expression on the event records, e.g. "nEMCal >= 2 && sum(emcal_E) > 150",
+/// is compiled at the beginning of the run into a program in reverse Polish
+/// notation, evaluated in NNBAROutput::SaveEvent() before the event is written.
+/// The rejected events are not serialised.
+///
+/// The expressions have numbers, the counts of rows of the ntuples (nMC,
+/// nTracker, nEMCal, nHCal; nEMCal and nHCal count the deposits with energy
+/// only, not the particles missed by the efficiency, and nMC the particles,
+/// not the unfilled rows below a particle ID), the functions of a column sum(), min(), max() and
+/// count() (the number of values; sum, min and max of no values are 0), the
+/// arithmetic operators + - * /, the comparisons < <= > >= == != and the
+/// logical operators && || ! with the precedence of C++, and parentheses.
+/// The values are in the units of the output (mm, ns, MeV).
+
+class NNBARSkimFilter {
+  public:
+
+    NNBARSkimFilter();
+
+    ~NNBARSkimFilter() {};
+
+    /// Sets the expression (compiled by Compile()). An empty expression
+    /// accepts all the events.
+    inline void SetExpression( const G4String& aExpression ) { fExpression = aExpression; fProgram.clear(); };
+
+    /// Gets the expression.
+    inline const G4String& GetExpression() const { return fExpression; };
+
+    /// Compiles the expression for the columns of the event records.
+    /// @param aEvent An event, defining the columns.
+    /// @return False (and a warning is issued) if the expression is not valid,
+    ///         then all the events are accepted.
+    G4bool Compile( const NNBAROutputEvent& aEvent );
+
+    /// Checks if the compiled expression selects events.
+    inline G4bool IsActive() const { return ! fProgram.empty(); };
+
+    /// Evaluates the compiled expression for an event.
+    /// @return True if the event is accepted.
+    G4bool Accept( const NNBAROutputEvent& aEvent );
+
+  private:
+
+    /// An operation of the program.
+    enum Operation { eNumber, eSum, eMin, eMax, eCount, eCountAbove, eNegate, eAdd, eSubtract, eMultiply, 
+                     eDivide, eLess, eLessEqual, eGreater, eGreaterEqual, eEqual, eNotEqual,
+                     eAnd, eOr, eNot };
+
+    /// An instruction: the operation, and the number (the threshold of
+    /// eCountAbove) or the column it uses.
+    struct Instruction {
+      Operation fOperation;
+      G4double fNumber;
+      std::size_t fColumn;
+    };
+
+    /// The values of a column in the event (the type is the index of
+    /// G4int, G4float, G4double).
+    struct Values {
+      const void* fData;
+      std::size_t fSize;
+      G4int fType;
+    };
+
+    /// The parser of the expression (recursive descent, appending the
+    /// instructions to fProgram). The functions return false at an error,
+    /// described in fError.
+    G4bool ParseOr();
+    G4bool ParseAnd();
+    G4bool ParseNot();
+    G4bool ParseComparison();
+    G4bool ParseSum();
+    G4bool ParseProduct();
+    G4bool ParseUnary();
+    G4bool ParsePrimary();
+
+    /// Skips the spaces and checks if the next characters are aToken (and
+    /// consumes them if so).
+    G4bool Next( const char* aToken );
+
+    /// Reads a name (letters, digits and underscores).
+    G4String ReadName();
+
+    /// Finds a column by its name.
+    /// @return The index of the column, or -1.
+    G4int FindColumn( const G4String& aName ) const;
+
+    /// Collects the values of the columns of an event in fValues.
+    void Collect( const NNBAROutputEvent& aEvent );
+
+    /// The function (eSum, eMin, eMax, eCount, eCountAbove) of the values of a column.
+    /// @param aThreshold The threshold of eCountAbove (the values above it are counted).
+    G4double Aggregate( Operation aOperation, const Values& aValues, G4double aThreshold ) const;
+
+    /// The expression.
+    G4String fExpression;
+
+    /// The compiled program.
+    std::vector< Instruction > fProgram;
+
+    /// The names of the columns and of the ntuples, and the instruction
+    /// counting the rows of each ntuple.
+    std::vector< G4String > fColumns;
+    std::vector< G4String > fNtuples;
+    std::vector< Instruction > fCounts;
+
+    /// The parsing state.
+    std::size_t fPosition;
+    G4String fError;
+
+    /// The values of the columns of the evaluated event.
+    std::vector< Values > fValues;
+
+    /// The stack of the evaluation.
+    std::vector< G4double > fStack;
+};
+
+#endif
@@ -74,6 +74,13 @@ class NNBARSmearer {
     /// @param aStandardDeviation The standard deviation of a Gaussian distribution.
     G4double Gauss( G4double aMean, G4double aStandardDeviation );
 
+    /// Returns a random number from a Poisson distribution. Small means are
+    /// sampled by inversion, large means with the PTRS transformed rejection
+    /// method (W. Hormann, Insurance Math. Econom. 12 (1993) 39) using a
+    /// table of log(k!).
+    /// @param aMean The mean of the Poisson distribution.
+    G4long Poisson( G4double aMean );
+
   protected:
     
     /// A default constructor.
@@ -91,6 +98,15 @@ class NNBARSmearer {
     
     /// CLHEP random engine used in gaussian smearing.
     CLHEP::RandGauss* fRandomGauss;
+
+    /// Mean above which Poisson() uses the PTRS method.
+    static constexpr G4double fPoissonInversionLimit = 10.;
+
+    /// Size of the table of log(k!) (larger k use std::lgamma).
+    static const G4int fLogFactorialTableSize = 256;
+
+    /// A table of log(k!).
+    G4double fLogFactorial[fLogFactorialTableSize];
 };
 
 #endif
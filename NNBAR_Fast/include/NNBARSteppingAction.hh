@@ -0,0 +1,56 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARSteppingAction.hh
+/// \brief Definition of the NNBARSteppingAction class
+
+#ifndef NNBAR_STEPPING_ACTION_H
+#define NNBAR_STEPPING_ACTION_H
+
+#include "G4UserSteppingAction.hh"
+#include "globals.hh"
+
+/// Stepping action.
+///
+/// Charges each step to its region in NNBARRegionTimer (when the per-region
+/// time accounting is enabled) and counts the steps for the overhead of the
+/// fast simulation process (NNBARProcessTimer). Scores the energy deposited
+/// in the fully simulated regions (NNBARFullSimScorer).
+/// The class needs to be set in G4RunManager::SetUserAction().
+
+class NNBARSteppingAction : public G4UserSteppingAction {
+  public:
+
+    /// A default constructor.
+    NNBARSteppingAction();
+
+    virtual ~NNBARSteppingAction();
+
+    /// Defines the actions at the end of each step.
+    virtual void UserSteppingAction( const G4Step* aStep );
+};
+
+#endif
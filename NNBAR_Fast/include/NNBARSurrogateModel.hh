@@ -0,0 +1,174 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARSurrogateModel.hh
+/// \brief Definition of the NNBARSurrogateModel class
+
+#ifndef NNBAR_SURROGATE_MODEL_H
+#define NNBAR_SURROGATE_MODEL_H
+
+#include "NNBAROutput.hh"
+#include "NNBARDetectorParametrisation.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+#include <vector>
+
+/// A calorimeter response given by a small neural network.
+///
+/// A multi-layer perceptron trained offline on the full simulation maps the
+/// features of a particle entering a calorimeter to its response: the median
+/// of the measured energy fraction, the relative resolution and the detection
+/// efficiency. It replaces the tables of NNBARDetectorParametrisation.
+///
+/// The fast simulation models only Add() the calorimeter entries; the network
+/// is evaluated once per event for all of them (FlushAll(), called at the end
+/// of the event before the output is saved) and the smeared energies are
+/// written to the rows already saved in NNBAROutput (with no energy for the
+/// particles missed, as with the tables). The inference runs on
+/// the CPU: the activations of a batch are stored neuron by neuron, so the
+/// inner loop over the entries is contiguous and vectorised by the compiler.
+///
+/// Input features (kNumberOfFeatures): a one-hot particle class (photon, e+-,
+/// mu+-, then the NNBARDetectorParametrisation::HadronSpecies and other
+/// hadrons), log10 of the kinetic energy in MeV, cos(theta) of the incidence
+/// on the face and the entry position in m.
+///
+/// Weight file format (text, whitespace separated):
+///  - "NNBARMLP 1", "features" and the number of features;
+///  - "normalisation" followed by the mean and the standard deviation of each
+///    feature (the network sees (x - mean)/std);
+///  - "layers" and the number of layers, then for each layer the number of
+///    inputs and outputs, an activation (relu, tanh or linear), the weights
+///    (output-major) and the biases.
+/// The last layer has 2 or 3 outputs: the median, log of the resolution and
+/// (optionally) the logit of the efficiency.
+
+class NNBARSurrogateModel {
+  public:
+
+    /// Number of input features.
+    static const G4int kNumberOfFeatures = 14;
+
+    /// A constructor.
+    /// @param aSaveType A calorimeter ntuple the entries are saved to.
+    /// @param aHistogram A histogram of the measured/true energy ratio.
+    NNBARSurrogateModel( NNBAROutput::SaveType aSaveType, G4int aHistogram );
+
+    ~NNBARSurrogateModel();
+
+    NNBARSurrogateModel( const NNBARSurrogateModel& ) = delete;
+    NNBARSurrogateModel& operator=( const NNBARSurrogateModel& ) = delete;
+
+    /// Loads the network from a weight file.
+    /// @param aFileName A name of the file.
+    /// @return False if the file cannot be read (the network is then unloaded).
+    G4bool Load( const G4String& aFileName );
+
+    /// Checks if a network is loaded.
+    inline G4bool IsLoaded() const { return ! fLayers.empty(); };
+
+    /// Adds a calorimeter entry to the batch of the event.
+    /// @param aPDG A PDG code of the particle.
+    /// @param aKenergy A kinetic energy of the particle.
+    /// @param aCosTheta A cosine of the incidence angle.
+    /// @param aPosition An entry position.
+    /// @param aRow A row of the entry in the NNBAROutput calorimeter ntuple.
+    void Add( G4int aPDG, G4double aKenergy, G4double aCosTheta, 
+              const G4ThreeVector& aPosition, G4int aRow );
+
+    /// Evaluates the network for the entries added in the event, smears their
+    /// energy and writes it to NNBAROutput.
+    void Flush();
+
+    /// Flushes all the surrogate models of the thread.
+    static void FlushAll();
+
+    /// Measures the time per entry of the network and of the tables of
+    /// NNBARDetectorParametrisation for random entries, and prints it.
+    /// @param aParametrisation The tables to compare with.
+    /// @param aDetector A calorimeter type.
+    /// @param aEntries A number of random entries.
+    void Benchmark( NNBARDetectorParametrisation* aParametrisation,
+                    NNBARDetectorParametrisation::Detector aDetector, G4int aEntries );
+
+  private:
+
+    /// An activation function of a layer.
+    enum Activation { eLinear, eReLU, eTanh };
+
+    /// A fully connected layer.
+    struct Layer {
+      G4int fInputs;
+      G4int fOutputs;
+      Activation fActivation;
+      std::vector< float > fWeights;
+      std::vector< float > fBiases;
+    };
+
+    /// A calorimeter entry waiting for the evaluation.
+    struct Entry {
+      G4int fPDG;
+      G4double fKenergy;
+      G4double fCosTheta;
+      G4ThreeVector fPosition;
+      G4int fRow;
+    };
+
+    /// Fills the (normalised) features of one entry.
+    /// @param aFeatures A pointer to the features of the first entry of the batch.
+    /// @param aStride A size of the batch (distance between two features).
+    void FillFeatures( const Entry& aEntry, float* aFeatures, std::size_t aStride ) const;
+
+    /// Evaluates the network for a batch.
+    /// @param aEntries A number of entries in the batch (at most kBatchSize).
+    /// The features are read from fInputBuffer, the outputs are left in fOutputBuffer.
+    void Evaluate( std::size_t aEntries );
+
+    /// Maximal number of entries evaluated at once (the activations stay in cache).
+    static const std::size_t kBatchSize = 256;
+
+    /// The calorimeter ntuple of the entries.
+    NNBAROutput::SaveType fSaveType;
+
+    /// The histogram of the measured/true energy ratio.
+    G4int fHistogram;
+
+    /// Mean and standard deviation of the features.
+    std::vector< float > fFeatureMean;
+    std::vector< float > fFeatureStd;
+
+    /// Layers of the network.
+    std::vector< Layer > fLayers;
+
+    /// Entries of the current event.
+    std::vector< Entry > fEntries;
+
+    /// Activations of a batch (neuron-major).
+    std::vector< float > fInputBuffer;
+    std::vector< float > fOutputBuffer;
+};
+
+#endif
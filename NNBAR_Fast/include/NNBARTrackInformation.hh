@@ -0,0 +1,71 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARTrackInformation.hh
+/// \brief Definition of the NNBARTrackInformation class
+
+#ifndef NNBAR_TRACK_INFORMATION_H
+#define NNBAR_TRACK_INFORMATION_H
+
+#include "G4VUserTrackInformation.hh"
+#include "G4Track.hh"
+#include "globals.hh"
+
+/// Information attached to the tracks.
+///
+/// Holds the index of the primary particle a track descends from (the
+/// particle ID of NNBARPrimaryParticleInformation, which is also the row of
+/// the particle in the MC ntuple). It is attached to the primaries and passed
+/// to their secondaries by NNBARTrackingAction, so the calorimeter deposits
+/// are saved with their primary.
+
+class NNBARTrackInformation : public G4VUserTrackInformation {
+  public:
+
+    /// A constructor.
+    /// @param aPrimaryIndex The index of the primary particle.
+    NNBARTrackInformation( G4int aPrimaryIndex );
+
+    virtual ~NNBARTrackInformation();
+
+    /// Prints the index of the primary.
+    virtual void Print() const;
+
+    /// Gets the index of the primary particle.
+    inline G4int GetPrimaryIndex() const { return fPrimaryIndex; };
+
+    /// Gets the index of the primary particle of a track.
+    /// @param aTrack A track.
+    /// @return The index, or -1 if unknown.
+    static G4int GetPrimaryIndex( const G4Track* aTrack );
+
+  private:
+
+    /// The index of the primary particle.
+    G4int fPrimaryIndex;
+};
+
+#endif
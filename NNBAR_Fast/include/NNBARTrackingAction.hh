@@ -48,13 +48,15 @@ class NNBARTrackingAction : public G4UserTrackingAction {
     virtual ~NNBARTrackingAction();
 
     /// Defines the actions at the start of processing the track.
-    /// It checks the pseudorapidity range and if the particle is a primary.
+    /// It checks the pseudorapidity range and if the particle is a primary,
+    /// and attaches the index of the primary (NNBARTrackInformation).
     virtual void  PreUserTrackingAction( const G4Track* track );
     
     /// Defines the actions at the end of processing the track. 
     /// It saves the information of MC data (PDG code, initial momentum),
     /// tracker (momentum), EMCal and HCal (energy deposit and its position)
-    /// as well as resolution and efficiency for all the detectors.
+    /// as well as resolution and efficiency for all the detectors. The
+    /// secondaries get the index of the primary of the track.
     virtual void  PostUserTrackingAction( const G4Track* track );
 };
 
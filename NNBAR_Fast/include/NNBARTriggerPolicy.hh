@@ -0,0 +1,158 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARTriggerPolicy.hh
+/// \brief Definition of the NNBARTriggerPolicy class
+
+#ifndef NNBAR_TRIGGER_POLICY_H
+#define NNBAR_TRIGGER_POLICY_H
+
+#include "globals.hh"
+#include "NNBAROutput.hh"
+#include <map>
+#include <unordered_map>
+
+class G4ParticleDefinition;
+class G4FastTrack;
+class G4FastStep;
+class NNBARTriggerPolicyMessenger;
+
+/// Kinematic trigger of a fast simulation model.
+///
+/// Decides in ModelTrigger() if a particle is parametrised. A particle is
+/// parametrised if its kinetic energy is above the threshold of its species
+/// (the default threshold unless a per-species rule is given). Below the
+/// threshold it is either left to the ordinary tracking or, in the direct
+/// deposit mode, killed with its kinetic energy deposited on the spot. The
+/// excluded species are always left to the ordinary tracking.
+///
+/// The rules are set from macros (see NNBARTriggerPolicyMessenger) and are
+/// compiled at the first decision after a change into a table keyed by the
+/// particle definition, so that a decision is one comparison for the common
+/// case of consecutive tracks of the same species.
+
+class NNBARTriggerPolicy {
+  public:
+
+    /// A decision of the trigger.
+    enum Decision { eTrack, eParametrise, eDirectDeposit };
+
+    /// A constructor.
+    /// @param aDirectory A UI directory of the commands (e.g. /NNBAR/emcal/trigger/).
+    NNBARTriggerPolicy( const G4String& aDirectory );
+
+    ~NNBARTriggerPolicy();
+
+    NNBARTriggerPolicy( const NNBARTriggerPolicy& ) = delete;
+    NNBARTriggerPolicy& operator=( const NNBARTriggerPolicy& ) = delete;
+
+    /// Decides what to do with a particle.
+    /// @param aDefinition A particle definition.
+    /// @param aKenergy A kinetic energy of the particle.
+    inline Decision Decide( const G4ParticleDefinition* aDefinition, G4double aKenergy );
+
+    /// Kills the particle and deposits its kinetic energy in the step
+    /// (the direct deposit mode). The unsmeared kinetic energy is saved as a
+    /// row of the calorimeter ntuple.
+    /// @param aFastTrack A track.
+    /// @param aFastStep A step.
+    /// @param aWhatToSave The ntuple of the deposit (eNoSave for none).
+    static void DepositDirectly( const G4FastTrack& aFastTrack, G4FastStep& aFastStep,
+                                 NNBAROutput::SaveType aWhatToSave );
+
+    /// Sets the default kinetic energy threshold. Default: 0 (all particles).
+    void SetThreshold( G4double aThreshold );
+
+    /// Sets the kinetic energy threshold of one species.
+    /// @param aPDG A PDG code of the species (antiparticles need their own rule).
+    /// @param aThreshold A threshold.
+    void SetSpeciesThreshold( G4int aPDG, G4double aThreshold );
+
+    /// Never parametrises a species: it is always tracked, also in the direct
+    /// deposit mode (a threshold set later for the species includes it again).
+    /// @param aPDG A PDG code of the species.
+    void ExcludeSpecies( G4int aPDG );
+
+    /// Removes all the per-species rules.
+    void ClearSpeciesRules();
+
+    /// Sets if particles below the threshold deposit their energy directly
+    /// instead of being tracked. Default: false.
+    void SetDirectDeposit( G4bool aDirectDeposit ) { fDirectDeposit = aDirectDeposit; };
+
+    /// Prints the rules.
+    void Print() const;
+
+  private:
+
+    /// Translates the per-species rules to the table keyed by the definition.
+    void Compile();
+
+    /// The default threshold.
+    G4double fThreshold;
+
+    /// If particles below the threshold deposit their energy directly.
+    G4bool fDirectDeposit;
+
+    /// A per-species rule: a threshold, or the exclusion of the species.
+    struct Rule {
+      G4double fThreshold;
+      G4bool fExcluded;
+    };
+
+    /// Per-species rules as given by the user (PDG code -> rule).
+    std::map< G4int, Rule > fSpeciesRules;
+
+    /// Compiled per-species rules.
+    std::unordered_map< const G4ParticleDefinition*, Rule > fCompiledRules;
+
+    /// If the rules changed since the last compilation.
+    G4bool fNeedsCompilation;
+
+    /// The species of the last decision and its rule.
+    const G4ParticleDefinition* fLastDefinition;
+    Rule fLastRule;
+
+    /// A messenger of the policy.
+    NNBARTriggerPolicyMessenger* fMessenger;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline NNBARTriggerPolicy::Decision 
+NNBARTriggerPolicy::Decide( const G4ParticleDefinition* aDefinition, G4double aKenergy ) {
+  if ( fNeedsCompilation ) Compile();
+  if ( aDefinition != fLastDefinition ) {
+    auto rule = fCompiledRules.find( aDefinition );
+    fLastRule = rule != fCompiledRules.end() ? rule->second : Rule{ fThreshold, false };
+    fLastDefinition = aDefinition;
+  }
+  if ( fLastRule.fExcluded ) return eTrack;
+  if ( aKenergy >= fLastRule.fThreshold ) return eParametrise;
+  return fDirectDeposit ? eDirectDeposit : eTrack;
+}
+
+#endif
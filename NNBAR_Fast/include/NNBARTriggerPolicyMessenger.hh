@@ -0,0 +1,90 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARTriggerPolicyMessenger.hh
+/// \brief Definition of the NNBARTriggerPolicyMessenger class
+
+#ifndef NNBAR_TRIGGER_POLICY_MESSENGER_H
+#define NNBAR_TRIGGER_POLICY_MESSENGER_H
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class NNBARTriggerPolicy;
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithABool;
+class G4UIcmdWithoutParameter;
+
+/// Messenger of a NNBARTriggerPolicy.
+///
+/// Defines the trigger commands of one fast simulation model in the given
+/// directory (e.g. /NNBAR/emcal/trigger/). The models are created in each
+/// worker thread, so the commands are broadcast to all of them.
+
+class NNBARTriggerPolicyMessenger : public G4UImessenger {
+  public:
+
+    /// A constructor.
+    /// @param aPolicy The policy controlled by the messenger.
+    /// @param aDirectory A directory of the commands (with the trailing slash).
+    NNBARTriggerPolicyMessenger( NNBARTriggerPolicy* aPolicy, const G4String& aDirectory );
+
+    virtual ~NNBARTriggerPolicyMessenger();
+
+    /// Applies a command.
+    virtual void SetNewValue( G4UIcommand* aCommand, G4String aNewValue );
+
+  private:
+
+    /// The policy controlled by the messenger.
+    NNBARTriggerPolicy* fPolicy;
+
+    /// The trigger directory.
+    G4UIdirectory* fDirectory;
+
+    /// The threshold command (default threshold).
+    G4UIcmdWithADoubleAndUnit* fThresholdCmd;
+
+    /// The species command (threshold of one species).
+    G4UIcommand* fSpeciesCmd;
+
+    /// The exclude command (never parametrise one species).
+    G4UIcmdWithAnInteger* fExcludeCmd;
+
+    /// The clearSpecies command.
+    G4UIcmdWithoutParameter* fClearSpeciesCmd;
+
+    /// The directDeposit command.
+    G4UIcmdWithABool* fDirectDepositCmd;
+
+    /// The print command.
+    G4UIcmdWithoutParameter* fPrintCmd;
+};
+
+#endif
@@ -45,15 +45,30 @@
 #include "NNBARDetectorConstruction.hh"
 #include "NNBARPhysicsList.hh"
 #include "NNBARActionInitialization.hh"
+#include "NNBARLoggerMessenger.hh"
 
 #include "G4VisExecutive.hh"
 #include "G4UIExecutive.hh"
 
 int main( int argc, char** argv ) {
 
+  // Command line: nnbar_main [-p <pre-init macro>] [macro]
+  // The pre-init macro is executed before the initialisation of the run
+  // manager (e.g. /NNBAR/physics/hybrid), the macro after it.
+  G4String preInitMacro;
+  G4String macro;
+  for ( G4int i = 1; i < argc; i++ ) {
+    G4String argument = argv[i];
+    if ( argument == "-p"  &&  i + 1 < argc ) {
+      preInitMacro = argv[++i];
+    } else {
+      macro = argument;
+    }
+  }
+
   // Instantiate G4UIExecutive if interactive mode
   G4UIExecutive* ui = nullptr;
-  if ( argc == 1 ) {
+  if ( macro.empty() ) {
     ui = new G4UIExecutive(argc, argv);
   }
 
@@ -63,6 +78,9 @@ int main( int argc, char** argv ) {
   auto* runManager = G4RunManagerFactory::CreateRunManager();
   runManager->SetNumberOfThreads(1);
 
+  // Commands of the logging subsystem (/NNBAR/log/)
+  NNBARLoggerMessenger* loggerMessenger = new NNBARLoggerMessenger;
+
   // Detector/mass geometry:
   G4VUserDetectorConstruction* detector = new NNBARDetectorConstruction();
   runManager->SetUserInitialization( detector );
@@ -76,6 +94,11 @@ int main( int argc, char** argv ) {
   //-------------------------------
   runManager->SetUserInitialization( new NNBARActionInitialization );
 
+  G4UImanager * UImanager = G4UImanager::GetUIpointer();
+  if ( ! preInitMacro.empty() ) {
+    UImanager->ApplyCommand( "/control/execute " + preInitMacro );
+  }
+
   // Initialize Run manager
   runManager->Initialize();
 
@@ -94,9 +117,7 @@ int main( int argc, char** argv ) {
     delete ui;
   } else {
     G4String command = "/control/execute ";
-    G4String fileName = argv[1];
-    G4UImanager * UImanager = G4UImanager::GetUIpointer();
-    UImanager->ApplyCommand( command+fileName );
+    UImanager->ApplyCommand( command+macro );
   }
 
   // Free the store: user actions, physics_list and detector_description are
@@ -105,6 +126,7 @@ int main( int argc, char** argv ) {
 
   delete visManager;
   delete runManager;
+  delete loggerMessenger;
 
   return 0;
 }
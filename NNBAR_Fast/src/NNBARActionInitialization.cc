@@ -32,6 +32,7 @@
 #include "NNBARRunAction.hh"
 #include "NNBAREventAction.hh"
 #include "NNBARTrackingAction.hh"
+#include "NNBARSteppingAction.hh"
 #include "G4UIcommand.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -68,6 +69,7 @@ void NNBARActionInitialization::Build() const {
   SetUserAction( new NNBARRunAction( fFileName ) );
   SetUserAction( new NNBAREventAction( fSmear ) );
   SetUserAction( new NNBARTrackingAction );
+  SetUserAction( new NNBARSteppingAction );
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
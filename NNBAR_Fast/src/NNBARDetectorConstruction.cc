@@ -29,6 +29,7 @@
 //  Adapted by A Nepomuceno - Winter 2025
 
 #include "NNBARDetectorConstruction.hh"
+#include "NNBARRegionInformation.hh"
 #include "G4ProductionCuts.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4RegionStore.hh"
@@ -57,7 +58,9 @@
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-NNBARDetectorConstruction::NNBARDetectorConstruction() {}
+NNBARDetectorConstruction::NNBARDetectorConstruction() : 
+  fMagFieldMessenger( nullptr ), fTPCInnerHalfSize( 0 ), fTPCOuterHalfSize( 0 ),
+  fCalorInnerHalfSize( 0 ), fCalorMiddleHalfSize( 0 ), fCalorOuterHalfSize( 0 ) {}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -112,6 +115,9 @@ G4VPhysicalVolume* NNBARDetectorConstruction::Construct() {
    G4Material* Carbon_target = new G4Material("Carbon_target" , density=3.52*g/cm3, 1);
    Carbon_target->AddElement(elC, 1);
    auto carbonMaterial = G4Material::GetMaterial("Carbon_target");
+
+   //TPC gas
+   auto tpcMaterial = nistManager->FindOrBuildMaterial("G4_Ar");
     
    
     //Dimensions
@@ -121,6 +127,7 @@ G4VPhysicalVolume* NNBARDetectorConstruction::Construct() {
     G4double  calorSizeXY    =  5.15*m;
     G4double  calorSizeZ     =  6.0*m;
     G4double  tubeThickness  =  2.*cm;
+    G4double  tpcThickness   =  30.*cm;
 
     auto calorThickness = scintThickness + absoThickness;
     auto worldSizeXY = 1.2 * calorSizeXY;
@@ -145,6 +152,11 @@ G4VPhysicalVolume* NNBARDetectorConstruction::Construct() {
    auto box1 = new G4Box("Box1", calorSizeXY/2., calorSizeXY/2., calorSizeZ/2.); 
    auto box2 = new G4Box("Box2",(calorSizeXY-absoThickness)/2., (calorSizeXY-absoThickness)/2., calorSizeZ/2.);
    auto box3 = new G4Box("Box3", (calorSizeXY-calorThickness)/2., (calorSizeXY-calorThickness)/2., calorSizeZ/2.);
+   // Faces of the calorimeters, used by the fast simulation models to find
+   // the entry face and the incidence angle
+   fCalorOuterHalfSize  = calorSizeXY/2.;
+   fCalorMiddleHalfSize = (calorSizeXY-absoThickness)/2.;
+   fCalorInnerHalfSize  = (calorSizeXY-calorThickness)/2.;
 
 //-----------Build Lead glass calorimeter---------------------------------
 
@@ -199,6 +211,29 @@ G4VPhysicalVolume* NNBARDetectorConstruction::Construct() {
    auto carbonLV = new G4LogicalVolume(carbonS,carbonMaterial,"CarbonLV");
    new G4PVPlacement(0,G4ThreeVector(0., 0., 0.),carbonLV,"CarbonPV",hollowLV,false,0,fCheckOverlaps);
 
+ //-----------Build TPC (tracker envelope)------------------------------------------
+ //Box shell lining the inner face of the calorimeters, open along z like them
+
+   fTPCOuterHalfSize = G4ThreeVector( (calorSizeXY-calorThickness)/2., 
+                                      (calorSizeXY-calorThickness)/2., calorSizeZ/2. );
+   fTPCInnerHalfSize = G4ThreeVector( fTPCOuterHalfSize.x() - tpcThickness,
+                                      fTPCOuterHalfSize.y() - tpcThickness, calorSizeZ/2. );
+   auto tpcOuterS = new G4Box("TPCOuter", fTPCOuterHalfSize.x(), fTPCOuterHalfSize.y(),
+                              fTPCOuterHalfSize.z());
+   auto tpcInnerS = new G4Box("TPCInner", fTPCInnerHalfSize.x(), fTPCInnerHalfSize.y(),
+                              fTPCInnerHalfSize.z());
+   auto tpcS = new G4SubtractionSolid("TPC", tpcOuterS, tpcInnerS);
+   auto tpcLV = new G4LogicalVolume(tpcS, tpcMaterial, "TPCLV");
+   new G4PVPlacement(
+                 0,                // no rotation
+                 G4ThreeVector(0., 0., 0.),
+                 tpcLV,            // its logical volume
+                 "TPC",            // its name
+                 hollowLV,         // its mother volume
+                 false,            // no boolean operation
+                 0,                // copy number
+                 fCheckOverlaps);  // checking overlaps
+
 
  //-----------Visualization for hollowLV (make it same color as background)----------
 //  auto black_color = new G4VisAttributes(G4Colour::Black()); 
@@ -216,6 +251,21 @@ G4VPhysicalVolume* NNBARDetectorConstruction::Construct() {
    G4Region* hadRegion = new G4Region("HAD_calo_region");   
    hadRegion->AddRootLogicalVolume(scintLV);
 
+   G4Region* trackerRegion = new G4Region("Tracker_region");
+   trackerRegion->AddRootLogicalVolume(tpcLV);
+
+   G4Region* targetRegion = new G4Region("Target_region");
+   targetRegion->AddRootLogicalVolume(carbonLV);
+
+   // Simulation mode of the regions, switched by /NNBAR/physics/fullSimRegion
+   // (the regions own their information); the energy deposited in the fully
+   // simulated calorimeters is saved as the calorimeter records
+   caloRegion->SetUserInformation( new NNBARRegionInformation( NNBAROutput::eSaveEMCal ) );
+   hadRegion->SetUserInformation( new NNBARRegionInformation( NNBAROutput::eSaveHCal ) );
+   for ( G4Region* region : { trackerRegion, targetRegion } ) {
+     region->SetUserInformation( new NNBARRegionInformation );
+   }
+
     return worldPV;
 }
 
@@ -227,16 +277,32 @@ void NNBARDetectorConstruction::ConstructSDandField() {
    G4RegionStore* regionStore = G4RegionStore::GetInstance();
    G4Region* caloRegion = regionStore->GetRegion("EM_calo_region");
    G4Region* hadRegion  = regionStore->GetRegion("HAD_calo_region"); 
+   G4Region* trackerRegion = regionStore->GetRegion("Tracker_region");
+   G4Region* targetRegion = regionStore->GetRegion("Target_region");
+
+  NNBARFastSimModelTarget* fastSimModelTarget
+      = new NNBARFastSimModelTarget( "fastSimModelTarget", targetRegion );
+  // Register the target fast simulation model for deleting
+    G4AutoDelete::Register(fastSimModelTarget);
+
+  NNBARFastSimModelTracker* fastSimModelTracker
+      = new NNBARFastSimModelTracker( "fastSimModelTracker", trackerRegion,
+                                      NNBARDetectorParametrisation::eNNBAR );
+  fastSimModelTracker->SetEnvelopeDimensions( fTPCInnerHalfSize, fTPCOuterHalfSize );
+  // Register the tracker fast simulation model for deleting
+    G4AutoDelete::Register(fastSimModelTracker);
   
   NNBARFastSimModelEMCal* fastSimModelEMCal
       = new NNBARFastSimModelEMCal( "fastSimModelEMCal", caloRegion,
                                     NNBARDetectorParametrisation::eNNBAR );
+  fastSimModelEMCal->SetFaceHalfSizes( fCalorMiddleHalfSize, fCalorOuterHalfSize );
   // Register the EM fast simulation model for deleting
     G4AutoDelete::Register(fastSimModelEMCal);
     
   NNBARFastSimModelHCal* fastSimModelHCal
       = new NNBARFastSimModelHCal( "fastSimModelHCal", hadRegion,
                                    NNBARDetectorParametrisation::eNNBAR );
+  fastSimModelHCal->SetFaceHalfSizes( fCalorInnerHalfSize, fCalorMiddleHalfSize );
     // Register the HAD fast simulation model for deleting
     G4AutoDelete::Register( fastSimModelHCal );
 
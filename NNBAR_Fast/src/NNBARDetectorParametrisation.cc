@@ -33,22 +33,224 @@
 #include "NNBARDetectorParametrisation.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4UnitsTable.hh"
+#include "G4PhysicalConstants.hh"
 #include "Randomize.hh"
+#include "G4Physics2DVector.hh"
+#include <vector>
 G4double p1 = 1.0; //probability for sorting double gaussian
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-NNBARDetectorParametrisation::NNBARDetectorParametrisation() {}
+const std::vector< G4double > NNBARDetectorParametrisation::fCosThetaNodes = 
+  { 0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 1.0 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-NNBARDetectorParametrisation::~NNBARDetectorParametrisation() {}
+NNBARDetectorParametrisation::NNBARDetectorParametrisation() {
+  BuildEMCalTables();
+  BuildHCalTables();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARDetectorParametrisation::~NNBARDetectorParametrisation() {
+  delete fEMCalResolution;
+  delete fEMCalMedian;
+  for ( G4int i = 0; i < eNumberOfHadronSpecies; i++ ) {
+    delete fHCalResolution[i];
+    delete fHCalMedian[i];
+    delete fHCalEfficiency[i];
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARDetectorParametrisation::BuildEMCalTables() {
+  // Response of the lead glass (kinetic energy in GeV) on logarithmic nodes,
+  // fine enough for the linear interpolation of the 1/sqrt(E) term.
+  // At oblique incidence the shower crosses more blocks and the constant term
+  // degrades, the longitudinal leakage being handled by the EMCal model itself.
+  // The median is flat until it is tuned against the full simulation.
+  const std::size_t nE = 41;
+  const G4double logEmin = std::log( 0.001 );
+  const G4double logEmax = std::log( 10. );
+  fEMCalResolution = new G4Physics2DVector( nE, fCosThetaNodes.size() );
+  fEMCalMedian     = new G4Physics2DVector( nE, fCosThetaNodes.size() );
+  for ( std::size_t i = 0; i < nE; i++ ) {
+    G4double energy = std::exp( logEmin + ( logEmax - logEmin ) * i / ( nE - 1 ) );
+    fEMCalResolution->PutX( i, energy );
+    fEMCalMedian->PutX( i, energy );
+    for ( std::size_t j = 0; j < fCosThetaNodes.size(); j++ ) {
+      G4double cosTheta = fCosThetaNodes[j];
+      if ( i == 0 ) {
+        fEMCalResolution->PutY( j, cosTheta );
+        fEMCalMedian->PutY( j, cosTheta );
+      }
+      fEMCalResolution->PutValue( i, j, 0.056/std::sqrt( energy ) + 0.011 
+                                        + 0.015 * ( 1. - cosTheta ) );
+      fEMCalMedian->PutValue( i, j, 1.0 );
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARDetectorParametrisation::FillHCalTables( G4int aSpecies, 
+                                                   const std::vector< G4double >& aEnergy,
+                                                   const std::vector< G4double >& aResolution,
+                                                   const std::vector< G4double >& aMedian,
+                                                   const std::vector< G4double >& aEfficiency ) {
+  // The values given are measured at normal incidence. At an angle theta the
+  // path in the scintillator is 1/cos(theta) longer:
+  //  - a particle punching through deposits proportionally more energy (up to
+  //    the fraction seen when it stops), with the relative fluctuations
+  //    reduced accordingly;
+  //  - the probability to interact (neutral hadrons) grows as 1-(1-eff)^(1/cos).
+  const std::size_t nE = aEnergy.size();
+  const std::size_t nC = fCosThetaNodes.size();
+  fHCalResolution[aSpecies] = new G4Physics2DVector( nE, nC );
+  fHCalMedian[aSpecies]     = new G4Physics2DVector( nE, nC );
+  fHCalEfficiency[aSpecies] = new G4Physics2DVector( nE, nC );
+  G4Physics2DVector* tables[3] = 
+    { fHCalResolution[aSpecies], fHCalMedian[aSpecies], fHCalEfficiency[aSpecies] };
+  for ( auto table : tables ) {
+    for ( std::size_t i = 0; i < nE; i++ ) table->PutX( i, aEnergy[i] );
+    for ( std::size_t j = 0; j < nC; j++ ) table->PutY( j, fCosThetaNodes[j] );
+  }
+  const G4double stopMedian = aMedian.front();
+  for ( std::size_t i = 0; i < nE; i++ ) {
+    for ( std::size_t j = 0; j < nC; j++ ) {
+      G4double pathFactor = 1. / fCosThetaNodes[j];
+      G4double median = aMedian[i];
+      G4double resolution = aResolution[i];
+      if ( median < stopMedian ) {
+        median = std::min( stopMedian, aMedian[i] * pathFactor );
+        resolution *= std::sqrt( aMedian[i] / median );
+      }
+      fHCalResolution[aSpecies]->PutValue( i, j, resolution );
+      fHCalMedian[aSpecies]->PutValue( i, j, median );
+      fHCalEfficiency[aSpecies]->PutValue( i, j, 
+        1. - std::pow( 1. - aEfficiency[i], pathFactor ) );
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARDetectorParametrisation::BuildHCalTables() {
+  // Response of the 30 cm plastic scintillator calorimeter at normal incidence
+  // (kinetic energy in GeV), extended to oblique incidence by FillHCalTables().
+  // Values outside the tabulated range are clamped to the first/last node.
+  //
+  // Protons stop in the scintillator below ~220 MeV, above that they punch
+  // through and only deposit dE/dx times the thickness.
+  std::vector< G4double > pE   = { 0.01, 0.05, 0.1,  0.2,  0.3,  0.5,  1.0,  2.0  };
+  std::vector< G4double > pRes = { 0.06, 0.06, 0.08, 0.10, 0.25, 0.35, 0.45, 0.50 };
+  std::vector< G4double > pMed = { 0.95, 0.93, 0.90, 0.85, 0.42, 0.22, 0.10, 0.06 };
+  std::vector< G4double > pEff = { 1.0,  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,  1.0  };
+  FillHCalTables( eProton, pE, pRes, pMed, pEff );
+
+  // Neutrons are seen through n-p elastic scattering and n-C reactions:
+  // only a fraction of the energy is visible and the detection efficiency
+  // follows the cross sections (with a light threshold at low energy).
+  std::vector< G4double > nE   = { 0.005, 0.01, 0.02, 0.05, 0.1,  0.2,  0.5,  1.0,  2.0  };
+  std::vector< G4double > nRes = { 0.60,  0.60, 0.60, 0.60, 0.60, 0.60, 0.60, 0.60, 0.60 };
+  std::vector< G4double > nMed = { 0.50,  0.50, 0.48, 0.45, 0.40, 0.35, 0.30, 0.25, 0.20 };
+  std::vector< G4double > nEff = { 0.20,  0.60, 0.65, 0.42, 0.32, 0.28, 0.30, 0.32, 0.34 };
+  FillHCalTables( eNeutron, nE, nRes, nMed, nEff );
+
+  // Charged kaons stop below ~120 MeV (same range as protons at equal beta*gamma)
+  std::vector< G4double > kE   = { 0.01, 0.05, 0.1,  0.15, 0.3,  0.5,  1.0,  2.0  };
+  std::vector< G4double > kRes = { 0.10, 0.10, 0.12, 0.25, 0.35, 0.45, 0.50, 0.50 };
+  std::vector< G4double > kMed = { 1.00, 0.95, 0.90, 0.60, 0.32, 0.20, 0.10, 0.06 };
+  std::vector< G4double > kEff = { 1.0,  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,  1.0  };
+  FillHCalTables( eChargedKaon, kE, kRes, kMed, kEff );
+
+  // K0L only interacts hadronically (about 0.3 interaction lengths)
+  std::vector< G4double > lE   = { 0.05, 0.1,  0.5,  2.0  };
+  std::vector< G4double > lRes = { 0.60, 0.60, 0.60, 0.60 };
+  std::vector< G4double > lMed = { 0.30, 0.30, 0.30, 0.30 };
+  std::vector< G4double > lEff = { 0.35, 0.32, 0.28, 0.28 };
+  FillHCalTables( eNeutralKaon, lE, lRes, lMed, lEff );
+
+  // Charged pions: constant FWHM resolution
+  std::vector< G4double > piE   = { 0.01, 2.0  };
+  std::vector< G4double > piRes = { 0.11, 0.11 };
+  std::vector< G4double > piMed = { 1.0,  1.0  };
+  std::vector< G4double > piEff = { 1.0,  1.0  };
+  FillHCalTables( eChargedPion, piE, piRes, piMed, piEff );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int NNBARDetectorParametrisation::GetHadronSpecies( G4int pdg ) {
+  switch ( std::abs( pdg ) ) {
+    case 2212 : return eProton;
+    case 2112 : return eNeutron;
+    case 321  : return eChargedKaon;
+    case 130  : return eNeutralKaon;
+    case 211  : return eChargedPion;
+    default   : return -1;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int NNBARDetectorParametrisation::GetFace( const G4ThreeVector& aPosition,
+                                             G4double aInnerHalfSize,
+                                             G4double aOuterHalfSize ) {
+  G4bool onX;
+  if ( aInnerHalfSize > 0 ) {
+    auto distance = [&]( G4double aCoordinate ) {
+      return std::min( std::abs( std::abs( aCoordinate ) - aInnerHalfSize ),
+                       std::abs( std::abs( aCoordinate ) - aOuterHalfSize ) );
+    };
+    onX = distance( aPosition.x() ) <= distance( aPosition.y() );
+  } else {
+    // Sizes unknown: the dominant transverse coordinate
+    onX = std::abs( aPosition.x() ) >= std::abs( aPosition.y() );
+  }
+  if ( onX ) return aPosition.x() >= 0 ? eFacePlusX : eFaceMinusX;
+  return aPosition.y() >= 0 ? eFacePlusY : eFaceMinusY;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreeVector NNBARDetectorParametrisation::GetFaceNormal( G4int aFace ) {
+  switch ( aFace ) {
+    case eFacePlusX  : return G4ThreeVector(  1., 0., 0. );
+    case eFaceMinusX : return G4ThreeVector( -1., 0., 0. );
+    case eFacePlusY  : return G4ThreeVector( 0.,  1., 0. );
+    default          : return G4ThreeVector( 0., -1., 0. );
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double NNBARDetectorParametrisation::GetStoppingPower( G4double aElectronDensity,
+                                                         G4double aMeanExcitationEnergy,
+                                                         G4double aMass, G4double aCharge,
+                                                         G4double aKenergy ) {
+  G4double gamma = 1. + aKenergy / aMass;
+  G4double beta2 = 1. - 1. / ( gamma * gamma );
+  G4double ratio = electron_mass_c2 / aMass;
+  G4double tMax = 2. * electron_mass_c2 * beta2 * gamma * gamma 
+                  / ( 1. + 2. * gamma * ratio + ratio * ratio );
+  G4double logTerm = 0.5 * std::log( 2. * electron_mass_c2 * beta2 * gamma * gamma * tMax
+                                     / ( aMeanExcitationEnergy * aMeanExcitationEnergy ) ) - beta2;
+  // The formula fails near the Bragg peak, where a simple floor is enough
+  // for the thin layers and the quenched light it is used for
+  logTerm = std::max( logTerm, 1. );
+  return twopi * classic_electr_radius * classic_electr_radius * electron_mass_c2 
+         * aElectronDensity * 2. * aCharge * aCharge / beta2 * logTerm;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 G4double NNBARDetectorParametrisation::GetResolution( Detector aDetector, 
                                                       Parametrisation aParam, 
-                                                      G4double aKenergy, G4int pdg ) {
+                                                      G4double aKenergy, G4int pdg,
+                                                      G4double aCosTheta ) {
 
 G4double res = 1.0;
 //-------------------------------------------------------------------------- 
@@ -72,11 +274,18 @@ G4double res = 1.0;
    else if ( aParam == eNNBAR ) {
     aKenergy /= GeV;  //aMomentum must be in GeV
          if (aDetector == NNBARDetectorParametrisation::eEMCAL ) {
-             if (abs(pdg) == 11 || pdg == 22 || abs(pdg) == 13 )  res = 0.056/std::sqrt(aKenergy) + 0.011;
+             if (abs(pdg) == 11 || pdg == 22 || abs(pdg) == 13 )  
+               res = fEMCalResolution->Value( aKenergy, aCosTheta );
          }
          
         if (aDetector == NNBARDetectorParametrisation::eHCAL ) {
-           if ( abs(pdg) == 211) res = 0.11;  //using FWHM
+           G4int species = GetHadronSpecies( pdg );
+           if ( species >= 0 ) {
+             res = fHCalResolution[species]->Value( aKenergy, aCosTheta );
+           } else {
+             // Other hadrons: generic sampling calorimeter response
+             res = std::sqrt( std::pow( 0.51/std::sqrt( aKenergy ),2) + std::pow( 0.07, 2 ) );
+           }
         }
        
          //if (aDetector == NNBARDetectorParametrisation::eTRACKER ) {
@@ -91,16 +300,18 @@ G4double res = 1.0;
 
 G4double NNBARDetectorParametrisation::GetMedian( Detector aDetector, 
                                                       Parametrisation aParam,
-                                                      G4double aKenergy,G4int pdg ) {
+                                                      G4double aKenergy,G4int pdg,
+                                                      G4double aCosTheta ) {
     G4double med = 1.0;
     if ( aParam == eNNBAR  ) { 
         aKenergy /= GeV;  //aMomentum in MeV
         if (aDetector == NNBARDetectorParametrisation::eEMCAL ) {
-           med = 1.0;
+           med = fEMCalMedian->Value( aKenergy, aCosTheta );
         }
    
        if (aDetector == NNBARDetectorParametrisation::eHCAL ) {
-         med = 1.0;
+         G4int species = GetHadronSpecies( pdg );
+         med = species >= 0 ? fHCalMedian[species]->Value( aKenergy, aCosTheta ) : 1.0;
        }
 
 //     if (aDetector == NNBARDetectorParametrisation::eTRACKER ) {
@@ -115,9 +326,11 @@ G4double NNBARDetectorParametrisation::GetMedian( Detector aDetector,
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 G4double NNBARDetectorParametrisation::GetEfficiency( Detector aDetector, 
-                                                      Parametrisation /*aParam*/,
-                                                      G4double /*aMomentum*/ ) {
-  // For the time being, we set the efficiency to 1.0
+                                                      Parametrisation aParam,
+                                                      G4double aKenergy, G4int pdg,
+                                                      G4double aCosTheta ) {
+  // For the time being, we set the efficiency to 1.0, except for the
+  // tabulated hadronic calorimeter response
   G4double eff = 1.0;
   switch ( aDetector ) {
     case NNBARDetectorParametrisation::eTRACKER :
@@ -128,6 +341,9 @@ G4double NNBARDetectorParametrisation::GetEfficiency( Detector aDetector,
       break;
     case NNBARDetectorParametrisation::eHCAL :
       eff = 1.0;
+      if ( aParam == eNNBAR  &&  GetHadronSpecies( pdg ) >= 0 ) {
+        eff = fHCalEfficiency[GetHadronSpecies( pdg )]->Value( aKenergy / GeV, aCosTheta );
+      }
       break;
   }
   return eff;
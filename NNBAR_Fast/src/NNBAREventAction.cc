@@ -31,6 +31,9 @@
 #include "NNBAREventInformation.hh"
 #include "NNBARRunAction.hh"
 #include "NNBAROutput.hh"
+#include "NNBARLogger.hh"
+#include "NNBARSurrogateModel.hh"
+#include "NNBARFullSimScorer.hh"
 #include "G4RunManager.hh"
 #include "G4Event.hh"
 #include "G4UnitsTable.hh"
@@ -56,13 +59,16 @@ NNBAREventAction::~NNBAREventAction() {}
 void NNBAREventAction::BeginOfEventAction( const G4Event* /*aEvent*/ ) {
   G4EventManager::GetEventManager()->SetUserInformation( 
                                               new NNBAREventInformation( fSmear ) );
-  NNBAROutput::Instance()->CreateNtuples();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void NNBAREventAction::EndOfEventAction( const G4Event* /*aEvent*/ ) {
-  NNBAROutput::Instance()->SaveEvent();
+void NNBAREventAction::EndOfEventAction( const G4Event* aEvent ) {
+  // The surrogate calorimeter responses are evaluated for the whole event
+  NNBARSurrogateModel::FlushAll();
+  if ( NNBARFullSimScorer::IsEnabled() ) NNBARFullSimScorer::Instance()->Flush();
+  NNBAROutput::Instance()->SaveEvent( aEvent->GetEventID() );
+  NNBARLogger::Flush();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
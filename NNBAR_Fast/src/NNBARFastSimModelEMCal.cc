@@ -28,10 +28,15 @@
 // Andre Nepomuceno - Winter 2025
 
 #include "NNBARFastSimModelEMCal.hh"
+#include "NNBARFastSimModelEMCalMessenger.hh"
+#include "NNBARShowerLibrary.hh"
 #include "NNBAREventInformation.hh"
 #include "NNBARPrimaryParticleInformation.hh"
+#include "NNBARTrackInformation.hh"
 #include "NNBARSmearer.hh"
 #include "NNBAROutput.hh"
+#include "NNBARLogger.hh"
+#include "NNBARRegionInformation.hh"
 
 #include "G4Track.hh"
 #include "G4Event.hh"
@@ -50,7 +55,9 @@
 #include "G4PionPlus.hh"
 #include "G4Proton.hh"
 #include "Randomize.hh"
+#include "G4PhysicalConstants.hh"
 
+#include "G4LogicalVolume.hh"
 #include "G4PathFinder.hh"
 #include "G4FieldTrack.hh"
 #include "G4FieldTrackUpdator.hh"
@@ -60,30 +67,56 @@
 
 NNBARFastSimModelEMCal::NNBARFastSimModelEMCal( G4String aModelName, 
   G4Region* aEnvelope, NNBARDetectorParametrisation::Parametrisation aType ) :
-  G4VFastSimulationModel( aModelName, aEnvelope ), fCalculateParametrisation(),
-  fParametrisation( aType ) {}
+  G4VFastSimulationModel( aModelName, aEnvelope ), fCalculateParametrisation( new NNBARDetectorParametrisation() ),
+  fParametrisation( aType ), fUseShowerLibrary( false ),
+  fMessenger( nullptr ), fInnerHalfSize( 0 ), fAbsorberThickness( 0 ), fProfile(),
+  fPhotoelectronsPerMeV( 0 ),
+  fTriggerPolicy( "/NNBAR/emcal/trigger/" ), fTriggerDecision( NNBARTriggerPolicy::eParametrise ),
+  fSurrogate( NNBAROutput::eSaveEMCal, 1 ) {
+  fMessenger = new NNBARFastSimModelEMCalMessenger( this );
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 NNBARFastSimModelEMCal::NNBARFastSimModelEMCal( G4String aModelName, 
                                                 G4Region* aEnvelope ) : 
-  G4VFastSimulationModel( aModelName, aEnvelope ), fCalculateParametrisation(),
-  fParametrisation( NNBARDetectorParametrisation::eNNBAR ) {}
+  G4VFastSimulationModel( aModelName, aEnvelope ), fCalculateParametrisation( new NNBARDetectorParametrisation() ),
+  fParametrisation( NNBARDetectorParametrisation::eNNBAR ), fUseShowerLibrary( false ),
+  fMessenger( nullptr ), fInnerHalfSize( 0 ), fAbsorberThickness( 0 ), fProfile(),
+  fPhotoelectronsPerMeV( 0 ),
+  fTriggerPolicy( "/NNBAR/emcal/trigger/" ), fTriggerDecision( NNBARTriggerPolicy::eParametrise ),
+  fSurrogate( NNBAROutput::eSaveEMCal, 1 ) {
+  fMessenger = new NNBARFastSimModelEMCalMessenger( this );
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 NNBARFastSimModelEMCal::NNBARFastSimModelEMCal( G4String aModelName ) :
-  G4VFastSimulationModel( aModelName ), fCalculateParametrisation(), 
-  fParametrisation( NNBARDetectorParametrisation::eNNBAR ) {}
+  G4VFastSimulationModel( aModelName ), fCalculateParametrisation( new NNBARDetectorParametrisation() ), 
+  fParametrisation( NNBARDetectorParametrisation::eNNBAR ), fUseShowerLibrary( false ),
+  fMessenger( nullptr ), fInnerHalfSize( 0 ), fAbsorberThickness( 0 ), fProfile(),
+  fPhotoelectronsPerMeV( 0 ),
+  fTriggerPolicy( "/NNBAR/emcal/trigger/" ), fTriggerDecision( NNBARTriggerPolicy::eParametrise ),
+  fSurrogate( NNBAROutput::eSaveEMCal, 1 ) {
+  fMessenger = new NNBARFastSimModelEMCalMessenger( this );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARFastSimModelEMCal::~NNBARFastSimModelEMCal() {
+  delete fMessenger;
+  delete fCalculateParametrisation;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-NNBARFastSimModelEMCal::~NNBARFastSimModelEMCal() {}
+G4bool NNBARFastSimModelEMCal::IsApplicable( const G4ParticleDefinition& aParticleType ) {
+  return AppliesTo( aParticleType );
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-G4bool NNBARFastSimModelEMCal::IsApplicable( 
-  const G4ParticleDefinition& aParticleType ) {
+G4bool NNBARFastSimModelEMCal::AppliesTo( const G4ParticleDefinition& aParticleType ) {
   // Applicable for electrons, positrons, and gammas
   return &aParticleType == G4Electron::Definition()    ||
          &aParticleType == G4Positron::Definition()    ||
@@ -94,18 +127,33 @@ G4bool NNBARFastSimModelEMCal::IsApplicable(
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-G4bool NNBARFastSimModelEMCal::ModelTrigger( const G4FastTrack& /*aFastTrack*/ ) {
-  return true;  // No kinematical restrictions to apply the parametrisation
+G4bool NNBARFastSimModelEMCal::ModelTrigger( const G4FastTrack& aFastTrack ) {
+  // Fully simulated region (hybrid mode)
+  if ( NNBARRegionInformation::IsFullSimulation( aFastTrack.GetEnvelope() ) ) return false;
+  const G4Track* track = aFastTrack.GetPrimaryTrack();
+  fTriggerDecision = fTriggerPolicy.Decide( track->GetDefinition(), track->GetKineticEnergy() );
+  return fTriggerDecision != NNBARTriggerPolicy::eTrack;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void NNBARFastSimModelEMCal::DoIt( const G4FastTrack& aFastTrack,
                                    G4FastStep& aFastStep ) {
-  //G4cout << " ________EMCal model triggered _________" << G4endl;
+  NNBAR_DEBUG( NNBARLogger::eEMCal, "EMCal model triggered by " 
+               << aFastTrack.GetPrimaryTrack()->GetDefinition()->GetParticleName() );
+
+  // Below the trigger threshold: no parametrisation, the energy stays here
+  if ( fTriggerDecision == NNBARTriggerPolicy::eDirectDeposit ) {
+    NNBARTriggerPolicy::DepositDirectly( aFastTrack, aFastStep, NNBAROutput::eSaveEMCal );
+    return;
+  }
 
   G4int pdgID = 0;
   pdgID = aFastTrack.GetPrimaryTrack()-> GetDefinition()->GetPDGEncoding();
+  // The deposits are linked to the track and to its primary particle
+  G4int trackID = aFastTrack.GetPrimaryTrack()->GetTrackID();
+  G4int parentID = aFastTrack.GetPrimaryTrack()->GetParentID();
+  G4int primary = NNBARTrackInformation::GetPrimaryIndex( aFastTrack.GetPrimaryTrack() );
     
   if ( abs(pdgID) != 13) {
  // Kill the parameterised particle at the entrance of the electromagnetic calorimeter
@@ -165,6 +213,24 @@ void NNBARFastSimModelEMCal::DoIt( const G4FastTrack& aFastTrack,
 
   G4ThreeVector Pos = aFastTrack.GetPrimaryTrack()->GetPosition();
   G4double time = aFastTrack.GetPrimaryTrack()->GetGlobalTime();
+
+  // Incidence angle on the face the particle enters
+  G4int face = NNBARDetectorParametrisation::GetFace( Pos, fInnerHalfSize, 
+                                                      fInnerHalfSize + fAbsorberThickness );
+  G4double cosTheta = std::abs( aFastTrack.GetPrimaryTrack()->GetMomentumDirection().dot( 
+                                NNBARDetectorParametrisation::GetFaceNormal( face ) ) );
+
+  // Longitudinal leakage of the shower out of the back of the calorimeter
+  // (muons are handled above)
+  G4double containedFraction = 1.0;
+  G4double leakageDepth = 0.0;
+  if ( abs(pdgID) != 13  &&  fAbsorberThickness > 0 ) {
+    if ( ! fProfile.IsBuilt() ) {
+      fProfile.Build( aFastTrack.GetEnvelopeLogicalVolume()->GetMaterial() );
+    }
+    leakageDepth = fAbsorberThickness / std::max( cosTheta, 1e-3 );
+    containedFraction = fProfile.GetContainedFraction( KE, leakageDepth, pdgID == 22 );
+  }
   
 //for debbuging
 //  if ( abs(pdgID) == 13)  Pos = G4ThreeVector(pathLength,0.0,0.0); //may 6
@@ -172,48 +238,171 @@ void NNBARFastSimModelEMCal::DoIt( const G4FastTrack& aFastTrack,
   NNBAREventInformation* info = (NNBAREventInformation*) 
                             G4EventManager::GetEventManager()->GetUserInformation();
                             
+    if ( info->GetDoSmearing()  &&  fSurrogate.IsLoaded()  &&  abs(pdgID) != 13 ) {
+      // Surrogate response: the entry is saved now and its response is filled
+      // at the end of the event, when the network is evaluated for all entries
+      NNBAROutput::Instance()->SaveTrack( NNBAROutput::eSaveEMCal, trackID, pdgID, KE/MeV, Pos/mm,
+                                          0, 1, 0, time/ns, 0, 0, face, cosTheta,
+                                          parentID, primary );
+      fSurrogate.Add( pdgID, KE, cosTheta, Pos, 
+                      NNBAROutput::Instance()->GetNumberOfDeposits( NNBAROutput::eSaveEMCal ) - 1 );
+      // The response is known at the end of the event only: it is saved to
+      // the ntuple then, nothing is deposited in the step
+      aFastStep.ProposeTotalEnergyDeposited( 0.0 );
+      return;
+    }
+
+    // The contained energy is saved to the EMCAL ntuple and the leaked one to
+    // the HCAL ntuple, with or without smearing
+    G4double res = 0.0;
+    G4double eff = 1.0;
+    G4double Esm = KE;
+    G4double Eleak = ( 1.0 - containedFraction ) * KE;
+    G4int Npe = 0;
     if ( info->GetDoSmearing() ) {
       // Smearing according to the electromagnetic calorimeter resolution taken from DetectorParametrisation
       G4ThreeVector Porg = aFastTrack.GetPrimaryTrack()->GetMomentum();
-      G4double res = fCalculateParametrisation->GetResolution( 
-               NNBARDetectorParametrisation::eEMCAL, fParametrisation, KE ,pdgID ); //p->pdgID
+      res = fCalculateParametrisation->GetResolution( 
+               NNBARDetectorParametrisation::eEMCAL, fParametrisation, KE ,pdgID, cosTheta ); //p->pdgID
     
       G4double med = fCalculateParametrisation->GetMedian( 
-               NNBARDetectorParametrisation::eEMCAL, fParametrisation, KE,pdgID ); //p->pdgID
-     // std::cout << med << std::endl;//
+               NNBARDetectorParametrisation::eEMCAL, fParametrisation, KE,pdgID, cosTheta ); //p->pdgID
+      NNBAR_TRACE( NNBARLogger::eEMCal, "median " << med << ", resolution " << res );
 
-      G4double eff = fCalculateParametrisation->GetEfficiency( 
+      eff = fCalculateParametrisation->GetEfficiency( 
                NNBARDetectorParametrisation::eEMCAL, fParametrisation, Porg.mag() );
 
-      G4double Esm;
-      Esm = std::abs( NNBARSmearer::Instance()->
-                        SmearEnergy( aFastTrack.GetPrimaryTrack(), res, med, KE ) );
+      if ( fPhotoelectronsPerMeV > 0 ) {
+        // Photostatistics of the Cherenkov light of the contained part of the
+        // shower replaces the Gaussian smearing
+        G4double meanNpe = fPhotoelectronsPerMeV * med * containedFraction * KE/MeV;
+        Npe = G4int( NNBARSmearer::Instance()->Poisson( meanNpe ) );
+        Eleak = ( 1.0 - containedFraction ) * med * KE;
+        Esm = Npe / fPhotoelectronsPerMeV * MeV + Eleak;
+        res = meanNpe > 0 ? 1.0 / std::sqrt( meanNpe ) : 0.0;
+      } else {
+        Esm = std::abs( NNBARSmearer::Instance()->
+                          SmearEnergy( aFastTrack.GetPrimaryTrack(), res, med, KE ) );
+        Eleak = ( 1.0 - containedFraction ) * Esm;
+      }
+
+      // A missed particle keeps its row, with no energy (as in the surrogate)
+      if ( G4UniformRand() > eff ) {
+        NNBAR_TRACE( NNBARLogger::eEMCal, "particle " << pdgID << " not detected (efficiency " 
+                     << eff << ")" );
+        Esm = 0.0;
+        Eleak = 0.0;
+        Npe = 0;
+      } else {
+   //Save histogram and trees
+        NNBAROutput::Instance()->FillHistogram( 1, (Esm/MeV) / (KE/MeV) );
+      }
+    }
 
+    //pdgID = aFastTrack.GetPrimaryTrack()-> GetDefinition()->GetPDGEncoding();
+    NNBAROutput::Instance()->SaveTrack( NNBAROutput::eSaveEMCal,
+                                       trackID,
+                                       pdgID,
+                                       KE/MeV,
+                                       Pos/mm,
+                                       res,
+                                       eff,
+                                       ( Esm - Eleak )/MeV,
+                                       time/ns,
+                                       Npe,
+                                       0,
+                                       face,
+                                       cosTheta,
+                                       parentID,
+                                       primary );
+
+    // The leaked energy is saved (at the exit point of the shower axis)
+    // to the hadronic calorimeter ntuple
+    if ( Eleak > 0 ) {
+      G4ThreeVector exitPos = Pos + 
+        leakageDepth * aFastTrack.GetPrimaryTrack()->GetMomentumDirection();
+      NNBAROutput::Instance()->SaveTrack( NNBAROutput::eSaveHCal,
+                                          trackID,
+                                          pdgID,
+                                          KE/MeV,
+                                          exitPos/mm,
+                                          res,
+                                          eff,
+                                          Eleak/MeV,
+                                          ( time + leakageDepth / c_light )/ns,
+                                          0,
+                                          0,
+                                          face,
+                                          cosTheta,
+                                          parentID,
+                                          primary );
+    }
 
-   //Save histogram and trees
-      NNBAROutput::Instance()->FillHistogram( 1, (Esm/MeV) / (KE/MeV) );
-  
-      //pdgID = aFastTrack.GetPrimaryTrack()-> GetDefinition()->GetPDGEncoding();
-      NNBAROutput::Instance()->SaveTrack( NNBAROutput::eSaveEMCal,
-                                         0,
-                                         pdgID,
-                                         KE/MeV,
-                                         Pos/mm,
-                                         res,
-                                         eff,
-                                         Esm/MeV,                                         
-                                         time/ns);
-
-      // The (smeared) energy of the particle is deposited in the step
-      // (which corresponds to the entrance of the electromagnetic calorimeter)
-      aFastStep.ProposeTotalEnergyDeposited( Esm );
-    } else {
-      // No smearing: simply setting the value of KE
-      // The (initial) energy of the particle is deposited in the step
-      // (which corresponds to the entrance of the electromagnetic calorimeter)
-      aFastStep.ProposeTotalEnergyDeposited( KE );
+    // Realistic shape of the contained deposit from the shower library (the
+    // spots beyond the back of the calorimeter are in the leaked energy)
+    if ( fUseShowerLibrary  &&  abs(pdgID) != 13  &&  Esm - Eleak > 0 ) {
+      PlaceShower( aFastTrack, Esm - Eleak, cosTheta, leakageDepth );
     }
 
+    // The contained energy of the particle is deposited in the step
+    // (which corresponds to the entrance of the electromagnetic calorimeter)
+    aFastStep.ProposeTotalEnergyDeposited( Esm - Eleak );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NNBARFastSimModelEMCal::PlaceShower( const G4FastTrack& aFastTrack, G4double aEnergy,
+                                            G4double aCosTheta, G4double aMaximumDepth ) {
+  const G4Track* track = aFastTrack.GetPrimaryTrack();
+  G4ThreeVector position = track->GetPosition();
+  G4ThreeVector direction = track->GetMomentumDirection();
+  G4int pdgID = track->GetDefinition()->GetPDGEncoding();
+
+  const NNBARShowerLibrary* library = NNBARShowerLibrary::Instance();
+  const NNBARShowerLibrary::Shower* shower = 
+    library->FindShower( track->GetKineticEnergy(), aCosTheta, pdgID );
+  if ( ! shower ) {
+    NNBAR_DEBUG( NNBARLogger::eEMCal, "No library shower for " << pdgID );
+    return false;
+  }
+  NNBAR_TRACE( NNBARLogger::eEMCal, "Library shower of " << shower->fEnergy 
+               << " MeV, cos(theta) " << shower->fCosTheta << " for " 
+               << track->GetKineticEnergy() / MeV << " MeV, cos(theta) " << aCosTheta );
+
+  // Transverse axes of the shower, randomly rotated around the incidence
+  // direction so that the same stored shower does not always look the same
+  G4ThreeVector axisU = direction.orthogonal().unit();
+  G4ThreeVector axisV = direction.cross( axisU );
+  G4double phi = twopi * G4UniformRand();
+  G4ThreeVector u = std::cos( phi ) * axisU + std::sin( phi ) * axisV;
+  G4ThreeVector v = direction.cross( u );
+
+  const NNBARShowerLibrary::Spot* spots = library->GetSpots( shower );
+  G4double time = track->GetGlobalTime();
+  // The fractions of the spots kept are scaled to the energy
+  auto isContained = [&]( const NNBARShowerLibrary::Spot& aSpot ) {
+    return aMaximumDepth <= 0  ||  aSpot.fDepth * mm <= aMaximumDepth;
+  };
+  G4double containedFraction = 0.0;
+  for ( std::uint32_t i = 0; i < shower->fNumberOfSpots; i++ ) {
+    if ( isContained( spots[i] ) ) containedFraction += spots[i].fEnergyFraction;
+  }
+  if ( ! ( containedFraction > 0 ) ) return false;
+  for ( std::uint32_t i = 0; i < shower->fNumberOfSpots; i++ ) {
+    if ( ! isContained( spots[i] ) ) continue;
+    G4ThreeVector spotPosition = position + spots[i].fDepth * mm * direction
+                               + spots[i].fTransverseU * mm * u + spots[i].fTransverseV * mm * v;
+    NNBAROutput::Instance()->SaveTrack( NNBAROutput::eSaveEMCalSpot,
+                                        0,
+                                        pdgID,
+                                        0,
+                                        spotPosition/mm,
+                                        0,
+                                        1,
+                                        spots[i].fEnergyFraction / containedFraction * aEnergy/MeV,
+                                        time/ns );
+  }
+  return true;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
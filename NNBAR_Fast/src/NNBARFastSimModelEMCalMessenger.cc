@@ -0,0 +1,111 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARFastSimModelEMCalMessenger.cc
+/// \brief Implementation of the NNBARFastSimModelEMCalMessenger class
+
+#include "NNBARFastSimModelEMCalMessenger.hh"
+#include "NNBARFastSimModelEMCal.hh"
+#include "NNBARShowerLibrary.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithAnInteger.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARFastSimModelEMCalMessenger::NNBARFastSimModelEMCalMessenger( NNBARFastSimModelEMCal* aModel ) 
+  : G4UImessenger(), fModel( aModel ) {
+  fDirectory = new G4UIdirectory( "/NNBAR/emcal/" );
+  fDirectory->SetGuidance( "Electromagnetic calorimeter fast simulation model control." );
+
+  fShowerLibraryCmd = new G4UIcmdWithAString( "/NNBAR/emcal/showerLibrary", this );
+  fShowerLibraryCmd->SetGuidance( "Load (memory-map) a frozen-shower library file." );
+  fShowerLibraryCmd->SetParameterName( "fileName", false );
+  fShowerLibraryCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fUseShowerLibraryCmd = new G4UIcmdWithABool( "/NNBAR/emcal/useShowerLibrary", this );
+  fUseShowerLibraryCmd->SetGuidance( "Place showers from the library at the entry point." );
+  fUseShowerLibraryCmd->SetGuidance( "Each shower spot is saved as an EMCal deposit." );
+  fUseShowerLibraryCmd->SetParameterName( "use", true );
+  fUseShowerLibraryCmd->SetDefaultValue( true );
+  fUseShowerLibraryCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fPhotoelectronsCmd = new G4UIcmdWithADouble( "/NNBAR/emcal/photoelectronsPerMeV", this );
+  fPhotoelectronsCmd->SetGuidance( "Mean number of Cherenkov photo-electrons per MeV." );
+  fPhotoelectronsCmd->SetGuidance( "A positive value replaces the Gaussian smearing with" );
+  fPhotoelectronsCmd->SetGuidance( "a Poisson draw of photo-electrons; 0 disables it." );
+  fPhotoelectronsCmd->SetParameterName( "yield", false );
+  fPhotoelectronsCmd->SetRange( "yield >= 0" );
+  fPhotoelectronsCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fSurrogateCmd = new G4UIcmdWithAString( "/NNBAR/emcal/surrogate", this );
+  fSurrogateCmd->SetGuidance( "Load the weights of the surrogate network (see NNBARSurrogateModel)." );
+  fSurrogateCmd->SetGuidance( "Once loaded, the network gives the response instead of the tables;" );
+  fSurrogateCmd->SetGuidance( "it is evaluated for all the entries of an event at once." );
+  fSurrogateCmd->SetParameterName( "fileName", false );
+  fSurrogateCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fSurrogateBenchmarkCmd = new G4UIcmdWithAnInteger( "/NNBAR/emcal/surrogateBenchmark", this );
+  fSurrogateBenchmarkCmd->SetGuidance( "Compare the time per entry of the surrogate network and" );
+  fSurrogateBenchmarkCmd->SetGuidance( "of the tables for random calorimeter entries." );
+  fSurrogateBenchmarkCmd->SetParameterName( "entries", true );
+  fSurrogateBenchmarkCmd->SetDefaultValue( 100000 );
+  fSurrogateBenchmarkCmd->SetRange( "entries > 0" );
+  fSurrogateBenchmarkCmd->AvailableForStates( G4State_Idle );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARFastSimModelEMCalMessenger::~NNBARFastSimModelEMCalMessenger() {
+  delete fSurrogateBenchmarkCmd;
+  delete fSurrogateCmd;
+  delete fPhotoelectronsCmd;
+  delete fUseShowerLibraryCmd;
+  delete fShowerLibraryCmd;
+  delete fDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARFastSimModelEMCalMessenger::SetNewValue( G4UIcommand* aCommand, G4String aNewValue ) {
+  if ( aCommand == fShowerLibraryCmd ) {
+    // The library is shared: only the first thread maps the file
+    NNBARShowerLibrary::Instance()->Load( aNewValue );
+  } else if ( aCommand == fUseShowerLibraryCmd ) {
+    fModel->SetUseShowerLibrary( fUseShowerLibraryCmd->GetNewBoolValue( aNewValue ) );
+  } else if ( aCommand == fPhotoelectronsCmd ) {
+    fModel->SetPhotoelectronsPerMeV( fPhotoelectronsCmd->GetNewDoubleValue( aNewValue ) );
+  } else if ( aCommand == fSurrogateCmd ) {
+    fModel->LoadSurrogate( aNewValue );
+  } else if ( aCommand == fSurrogateBenchmarkCmd ) {
+    fModel->BenchmarkSurrogate( fSurrogateBenchmarkCmd->GetNewIntValue( aNewValue ) );
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -30,17 +30,20 @@
 
 
 #include "NNBARFastSimModelHCal.hh"
+#include "NNBARFastSimModelHCalMessenger.hh"
 #include "NNBAREventInformation.hh"
 #include "NNBARPrimaryParticleInformation.hh"
+#include "NNBARTrackInformation.hh"
 #include "NNBARSmearer.hh"
 #include "NNBAROutput.hh"
+#include "NNBARLogger.hh"
+#include "NNBARRegionInformation.hh"
 
 #include "G4Track.hh"
 #include "G4Event.hh"
 #include "G4RunManager.hh"
 #include "G4AnalysisManager.hh"
-#include "G4PionMinus.hh"
-#include "G4PionPlus.hh"
+#include "G4LogicalVolume.hh"
 
 #include "Randomize.hh"
 #include "G4SystemOfUnits.hh"
@@ -49,48 +52,91 @@
 
 NNBARFastSimModelHCal::NNBARFastSimModelHCal( G4String aModelName, 
   G4Region* aEnvelope, NNBARDetectorParametrisation::Parametrisation aType ) :
-  G4VFastSimulationModel( aModelName, aEnvelope ), fCalculateParametrisation(),
-  fParametrisation( aType ) {}
+  G4VFastSimulationModel( aModelName, aEnvelope ), fCalculateParametrisation( new NNBARDetectorParametrisation() ),
+  fParametrisation( aType ), fMessenger( nullptr ),
+  fPhotoelectronsPerMeV( 0 ), fBirksConstant( 0.126*mm/MeV ), fScintillatorResponse(),
+  fInnerHalfSize( 0 ), fOuterHalfSize( 0 ),
+  fTriggerPolicy( "/NNBAR/hcal/trigger/" ), fTriggerDecision( NNBARTriggerPolicy::eParametrise ),
+  fSurrogate( NNBAROutput::eSaveHCal, 2 ) {
+  fMessenger = new NNBARFastSimModelHCalMessenger( this );
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 NNBARFastSimModelHCal::NNBARFastSimModelHCal( G4String aModelName, 
                                               G4Region* aEnvelope ) : 
-  G4VFastSimulationModel( aModelName, aEnvelope ), fCalculateParametrisation(),
-  fParametrisation( NNBARDetectorParametrisation::eNNBAR ) {}
+  G4VFastSimulationModel( aModelName, aEnvelope ), fCalculateParametrisation( new NNBARDetectorParametrisation() ),
+  fParametrisation( NNBARDetectorParametrisation::eNNBAR ), fMessenger( nullptr ),
+  fPhotoelectronsPerMeV( 0 ), fBirksConstant( 0.126*mm/MeV ), fScintillatorResponse(),
+  fInnerHalfSize( 0 ), fOuterHalfSize( 0 ),
+  fTriggerPolicy( "/NNBAR/hcal/trigger/" ), fTriggerDecision( NNBARTriggerPolicy::eParametrise ),
+  fSurrogate( NNBAROutput::eSaveHCal, 2 ) {
+  fMessenger = new NNBARFastSimModelHCalMessenger( this );
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 NNBARFastSimModelHCal::NNBARFastSimModelHCal( G4String aModelName ) :
-  G4VFastSimulationModel( aModelName ), fCalculateParametrisation(), 
-  fParametrisation( NNBARDetectorParametrisation::eNNBAR ) {}
+  G4VFastSimulationModel( aModelName ), fCalculateParametrisation( new NNBARDetectorParametrisation() ), 
+  fParametrisation( NNBARDetectorParametrisation::eNNBAR ), fMessenger( nullptr ),
+  fPhotoelectronsPerMeV( 0 ), fBirksConstant( 0.126*mm/MeV ), fScintillatorResponse(),
+  fInnerHalfSize( 0 ), fOuterHalfSize( 0 ),
+  fTriggerPolicy( "/NNBAR/hcal/trigger/" ), fTriggerDecision( NNBARTriggerPolicy::eParametrise ),
+  fSurrogate( NNBAROutput::eSaveHCal, 2 ) {
+  fMessenger = new NNBARFastSimModelHCalMessenger( this );
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-NNBARFastSimModelHCal::~NNBARFastSimModelHCal() {}
+NNBARFastSimModelHCal::~NNBARFastSimModelHCal() {
+  delete fMessenger;
+  delete fCalculateParametrisation;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 G4bool NNBARFastSimModelHCal::IsApplicable( const G4ParticleDefinition& aParticleType ) {
+  return AppliesTo( aParticleType );
+}
 
-    return &aParticleType == G4PionMinus::Definition()  ||
- 	   &aParticleType == G4PionPlus::Definition();
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NNBARFastSimModelHCal::AppliesTo( const G4ParticleDefinition& aParticleType ) {
+  // Applicable for all hadrons: there are no hadronic processes in the physics
+  // list, so a hadron that is not parametrised would just leave the detector
+  return aParticleType.GetParticleType() == "baryon"  ||
+         aParticleType.GetParticleType() == "meson";
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-G4bool NNBARFastSimModelHCal::ModelTrigger( const G4FastTrack& /*aFastTrack*/ ) {
-  return true;  // No kinematical restrictions to apply the parametrisation
+G4bool NNBARFastSimModelHCal::ModelTrigger( const G4FastTrack& aFastTrack ) {
+  // Fully simulated region (hybrid mode)
+  if ( NNBARRegionInformation::IsFullSimulation( aFastTrack.GetEnvelope() ) ) return false;
+  const G4Track* track = aFastTrack.GetPrimaryTrack();
+  fTriggerDecision = fTriggerPolicy.Decide( track->GetDefinition(), track->GetKineticEnergy() );
+  return fTriggerDecision != NNBARTriggerPolicy::eTrack;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void NNBARFastSimModelHCal::DoIt( const G4FastTrack& aFastTrack, 
                                   G4FastStep& aFastStep ) {
-  //G4cout << " ________HCal model triggered _________" << G4endl;
+  NNBAR_DEBUG( NNBARLogger::eHCal, "HCal model triggered by " 
+               << aFastTrack.GetPrimaryTrack()->GetDefinition()->GetParticleName() );
+
+  // Below the trigger threshold: no parametrisation, the energy stays here
+  if ( fTriggerDecision == NNBARTriggerPolicy::eDirectDeposit ) {
+    NNBARTriggerPolicy::DepositDirectly( aFastTrack, aFastStep, NNBAROutput::eSaveHCal );
+    return;
+  }
 
   G4int pdgID = 0;
   pdgID = aFastTrack.GetPrimaryTrack()-> GetDefinition()->GetPDGEncoding();
+  // The deposits are linked to the track and to its primary particle
+  G4int trackID = aFastTrack.GetPrimaryTrack()->GetTrackID();
+  G4int parentID = aFastTrack.GetPrimaryTrack()->GetParentID();
+  G4int primary = NNBARTrackInformation::GetPrimaryIndex( aFastTrack.GetPrimaryTrack() );
 
 
   // Kill the parameterised particle at the entrance of the hadronic calorimeter
@@ -99,46 +145,106 @@ void NNBARFastSimModelHCal::DoIt( const G4FastTrack& aFastTrack,
   G4double KE = aFastTrack.GetPrimaryTrack()->GetKineticEnergy();
   G4ThreeVector Pos = aFastTrack.GetPrimaryTrack()->GetPosition();
   G4double time = aFastTrack.GetPrimaryTrack()->GetGlobalTime();
+
+  // Incidence angle on the face the particle enters
+  G4int face = NNBARDetectorParametrisation::GetFace( Pos, fInnerHalfSize, fOuterHalfSize );
+  G4double cosTheta = std::abs( aFastTrack.GetPrimaryTrack()->GetMomentumDirection().dot( 
+                                NNBARDetectorParametrisation::GetFaceNormal( face ) ) );
    
 
    NNBAREventInformation* info = (NNBAREventInformation*) G4EventManager::GetEventManager()->GetUserInformation();
 
+    if ( info->GetDoSmearing()  &&  fSurrogate.IsLoaded() ) {
+      // Surrogate response: the entry is saved now and its response is filled
+      // at the end of the event, when the network is evaluated for all entries
+      NNBAROutput::Instance()->SaveTrack( NNBAROutput::eSaveHCal, trackID, pdgID, KE/MeV, Pos/mm,
+                                          0, 1, 0, time/ns, 0, 0, face, cosTheta,
+                                          parentID, primary );
+      fSurrogate.Add( pdgID, KE, cosTheta, Pos, 
+                      NNBAROutput::Instance()->GetNumberOfDeposits( NNBAROutput::eSaveHCal ) - 1 );
+      // The response is known at the end of the event only: it is saved to
+      // the ntuple then, nothing is deposited in the step
+      aFastStep.ProposeTotalEnergyDeposited( 0.0 );
+      return;
+    }
+
     if ( info->GetDoSmearing() ) {
       // Smearing according to the hadronic calorimeter resolution
       G4ThreeVector Porg = aFastTrack.GetPrimaryTrack()->GetMomentum();
       G4double res = fCalculateParametrisation->GetResolution( NNBARDetectorParametrisation::eHCAL, 
-                     fParametrisation, KE, pdgID );
+                     fParametrisation, KE, pdgID, cosTheta );
 
       G4double med = fCalculateParametrisation->GetMedian( 
-                     NNBARDetectorParametrisation::eHCAL, fParametrisation, KE , pdgID );
+                     NNBARDetectorParametrisation::eHCAL, fParametrisation, KE , pdgID, cosTheta );
       
       G4double eff = fCalculateParametrisation->GetEfficiency( NNBARDetectorParametrisation::eHCAL, 
-                     fParametrisation, KE );
+                     fParametrisation, KE, pdgID, cosTheta );
+
+      // Neutral hadrons are seen only if they interact in the scintillator. A
+      // missed particle keeps its row, with no energy (as in the surrogate)
+      if ( G4UniformRand() > eff ) {
+        NNBAR_TRACE( NNBARLogger::eHCal, "hadron " << pdgID << " not detected (efficiency " 
+                     << eff << ")" );
+        NNBAROutput::Instance()->SaveTrack( NNBAROutput::eSaveHCal, trackID, pdgID, KE/MeV, Pos/mm,
+                                            res, eff, 0, time/ns, 0, 0, face, cosTheta,
+                                            parentID, primary );
+        aFastStep.ProposeTotalEnergyDeposited( 0.0 );
+        return;
+      }
                      
       G4double Esm;
-      Esm = std::abs( NNBARSmearer::Instance()->
-                      SmearEnergy( aFastTrack.GetPrimaryTrack(), res , med, KE) );
-      //std::cout << "Reco E:" << Esm << std::endl;
+      G4double Evis = 0.0;
+      G4int Npe = 0;
+      if ( fPhotoelectronsPerMeV > 0 ) {
+        // Scintillator response: Birks quenching of the deposit, then photostatistics.
+        // The deposit is calibrated back with the mean light of this species.
+        if ( ! fScintillatorResponse.IsBuilt()  ||  
+             fScintillatorResponse.GetBirksConstant() != fBirksConstant ) {
+          fScintillatorResponse.Build( aFastTrack.GetEnvelopeLogicalVolume()->GetMaterial(),
+                                       fBirksConstant );
+        }
+        G4double Edep = med * KE;
+        G4double meanEvis = fScintillatorResponse.GetVisibleEnergy( 
+          NNBARDetectorParametrisation::GetHadronSpecies( pdgID ), KE, Edep );
+        G4double meanNpe = fPhotoelectronsPerMeV * meanEvis/MeV;
+        Npe = G4int( NNBARSmearer::Instance()->Poisson( meanNpe ) );
+        Evis = Npe / fPhotoelectronsPerMeV * MeV;
+        Esm = meanNpe > 0 ? Edep * Npe / meanNpe : 0.0;
+        res = meanNpe > 0 ? 1.0 / std::sqrt( meanNpe ) : 0.0;
+      } else {
+        Esm = std::abs( NNBARSmearer::Instance()->
+                        SmearEnergy( aFastTrack.GetPrimaryTrack(), res , med, KE) );
+      }
+      NNBAR_TRACE( NNBARLogger::eHCal, "reconstructed energy " << Esm / MeV << " MeV" );
 
 //Save histogram and trees
       NNBAROutput::Instance()->FillHistogram( 2, (Esm/MeV) / (KE/MeV) );
       
       pdgID = aFastTrack.GetPrimaryTrack()-> GetDefinition()->GetPDGEncoding();
       NNBAROutput::Instance()->SaveTrack( NNBAROutput::eSaveHCal,
-                                        0,
+                                        trackID,
                                         pdgID,
                                         KE/MeV,
                                         Pos/mm,
                                         res,
                                         eff,
                                         Esm/MeV,                                        
-                                        time/ns);
+                                        time/ns,
+                                        Npe,
+                                        Evis/MeV,
+                                        face,
+                                        cosTheta,
+                                        parentID,
+                                        primary );
       
       // The (smeared) energy of the particle is deposited in the step
       // (which corresponds to the entrance of the hadronic calorimeter)
       aFastStep.ProposeTotalEnergyDeposited( Esm );
     } else {
-      // No smearing: simply setting the value of Edep
+      // No smearing: the unsmeared row, as in the electromagnetic calorimeter
+      NNBAROutput::Instance()->SaveTrack( NNBAROutput::eSaveHCal, trackID, pdgID, KE/MeV, Pos/mm,
+                                          0, 1, KE/MeV, time/ns, 0, 0, face, cosTheta,
+                                          parentID, primary );
       // The (initial) energy of the particle is deposited in the step
       // (which corresponds to the entrance of the hadronic calorimeter)
       aFastStep.ProposeTotalEnergyDeposited( KE );
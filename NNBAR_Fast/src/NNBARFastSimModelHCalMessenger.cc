@@ -0,0 +1,100 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARFastSimModelHCalMessenger.cc
+/// \brief Implementation of the NNBARFastSimModelHCalMessenger class
+
+#include "NNBARFastSimModelHCalMessenger.hh"
+#include "NNBARFastSimModelHCal.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4SystemOfUnits.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARFastSimModelHCalMessenger::NNBARFastSimModelHCalMessenger( NNBARFastSimModelHCal* aModel ) 
+  : G4UImessenger(), fModel( aModel ) {
+  fDirectory = new G4UIdirectory( "/NNBAR/hcal/" );
+  fDirectory->SetGuidance( "Hadronic calorimeter fast simulation model control." );
+
+  fPhotoelectronsCmd = new G4UIcmdWithADouble( "/NNBAR/hcal/photoelectronsPerMeV", this );
+  fPhotoelectronsCmd->SetGuidance( "Photo-electrons per MeV of visible (electron-equivalent) energy." );
+  fPhotoelectronsCmd->SetGuidance( "A positive value enables the scintillator response (Birks" );
+  fPhotoelectronsCmd->SetGuidance( "quenching and photostatistics) instead of the Gaussian smearing." );
+  fPhotoelectronsCmd->SetParameterName( "yield", false );
+  fPhotoelectronsCmd->SetRange( "yield >= 0" );
+  fPhotoelectronsCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fBirksCmd = new G4UIcmdWithADouble( "/NNBAR/hcal/birksConstant", this );
+  fBirksCmd->SetGuidance( "Birks constant of the scintillator in mm/MeV (default 0.126)." );
+  fBirksCmd->SetParameterName( "kB", false );
+  fBirksCmd->SetRange( "kB >= 0" );
+  fBirksCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fSurrogateCmd = new G4UIcmdWithAString( "/NNBAR/hcal/surrogate", this );
+  fSurrogateCmd->SetGuidance( "Load the weights of the surrogate network (see NNBARSurrogateModel)." );
+  fSurrogateCmd->SetGuidance( "Once loaded, the network gives the response instead of the tables;" );
+  fSurrogateCmd->SetGuidance( "it is evaluated for all the entries of an event at once." );
+  fSurrogateCmd->SetParameterName( "fileName", false );
+  fSurrogateCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fSurrogateBenchmarkCmd = new G4UIcmdWithAnInteger( "/NNBAR/hcal/surrogateBenchmark", this );
+  fSurrogateBenchmarkCmd->SetGuidance( "Compare the time per entry of the surrogate network and" );
+  fSurrogateBenchmarkCmd->SetGuidance( "of the tables for random calorimeter entries." );
+  fSurrogateBenchmarkCmd->SetParameterName( "entries", true );
+  fSurrogateBenchmarkCmd->SetDefaultValue( 100000 );
+  fSurrogateBenchmarkCmd->SetRange( "entries > 0" );
+  fSurrogateBenchmarkCmd->AvailableForStates( G4State_Idle );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARFastSimModelHCalMessenger::~NNBARFastSimModelHCalMessenger() {
+  delete fSurrogateBenchmarkCmd;
+  delete fSurrogateCmd;
+  delete fBirksCmd;
+  delete fPhotoelectronsCmd;
+  delete fDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARFastSimModelHCalMessenger::SetNewValue( G4UIcommand* aCommand, G4String aNewValue ) {
+  if ( aCommand == fPhotoelectronsCmd ) {
+    fModel->SetPhotoelectronsPerMeV( fPhotoelectronsCmd->GetNewDoubleValue( aNewValue ) );
+  } else if ( aCommand == fBirksCmd ) {
+    fModel->SetBirksConstant( fBirksCmd->GetNewDoubleValue( aNewValue ) * mm/MeV );
+  } else if ( aCommand == fSurrogateCmd ) {
+    fModel->LoadSurrogate( aNewValue );
+  } else if ( aCommand == fSurrogateBenchmarkCmd ) {
+    fModel->BenchmarkSurrogate( fSurrogateBenchmarkCmd->GetNewIntValue( aNewValue ) );
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,226 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARFastSimModelTarget.cc
+/// \brief Implementation of the NNBARFastSimModelTarget class
+
+#include "NNBARFastSimModelTarget.hh"
+#include "NNBARDetectorParametrisation.hh"
+#include "NNBARLogger.hh"
+#include "NNBARRegionInformation.hh"
+
+#include "G4Track.hh"
+#include "G4DynamicParticle.hh"
+#include "G4Material.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VSolid.hh"
+#include "G4PhysicsLogVector.hh"
+#include "G4Gamma.hh"
+#include "G4Electron.hh"
+#include "G4Positron.hh"
+
+#include "Randomize.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARFastSimModelTarget::NNBARFastSimModelTarget( G4String aModelName, G4Region* aEnvelope ) :
+  G4VFastSimulationModel( aModelName, aEnvelope ) {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARFastSimModelTarget::NNBARFastSimModelTarget( G4String aModelName ) :
+  G4VFastSimulationModel( aModelName ) {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARFastSimModelTarget::~NNBARFastSimModelTarget() {
+  for ( auto& table : fStoppingPowerTables ) {
+    delete table.second;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NNBARFastSimModelTarget::IsApplicable( const G4ParticleDefinition& aParticleType ) {
+  return AppliesTo( aParticleType );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NNBARFastSimModelTarget::AppliesTo( const G4ParticleDefinition& aParticleType ) {
+  return &aParticleType == G4Gamma::Definition()  ||  aParticleType.GetPDGCharge() != 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NNBARFastSimModelTarget::ModelTrigger( const G4FastTrack& aFastTrack ) {
+  // No kinematical restrictions to apply the parametrisation, unless the
+  // target is fully simulated (hybrid mode)
+  return ! NNBARRegionInformation::IsFullSimulation( aFastTrack.GetEnvelope() );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARFastSimModelTarget::DoIt( const G4FastTrack& aFastTrack, 
+                                    G4FastStep& aFastStep ) {
+  const G4Track* track = aFastTrack.GetPrimaryTrack();
+  const G4Material* material = aFastTrack.GetEnvelopeLogicalVolume()->GetMaterial();
+  G4ThreeVector localPosition = aFastTrack.GetPrimaryTrackLocalPosition();
+  G4ThreeVector localDirection = aFastTrack.GetPrimaryTrackLocalDirection();
+
+  // Path through the foil along the initial direction
+  G4double pathLength = aFastTrack.GetEnvelopeSolid()->DistanceToOut( localPosition, 
+                                                                      localDirection );
+  G4double depth = pathLength / material->GetRadlen();
+  NNBAR_DEBUG( NNBARLogger::eGeneral, "Target model triggered by " 
+               << track->GetDefinition()->GetParticleName() << ", path " << pathLength / um 
+               << " um (" << depth << " X0)" );
+
+  if ( track->GetDefinition() == G4Gamma::Definition() ) {
+    if ( track->GetKineticEnergy() > 2. * electron_mass_c2  &&
+         G4UniformRand() < 1. - std::exp( -7. / 9. * depth ) ) {
+      ConvertPhoton( aFastTrack, aFastStep, pathLength );
+      return;
+    }
+  } else {
+    // Mean energy loss
+    G4double kineticEnergy = track->GetKineticEnergy();
+    G4double energyLoss = 
+      GetStoppingPowerTable( track->GetDefinition(), material )->Value( kineticEnergy ) 
+      * pathLength;
+    if ( energyLoss >= kineticEnergy ) {
+      // The particle stops in the foil
+      aFastStep.KillPrimaryTrack();
+      aFastStep.ProposePrimaryTrackPathLength( 0.0 );
+      aFastStep.ProposeTotalEnergyDeposited( kineticEnergy );
+      return;
+    }
+
+    // Multiple scattering: Highland formula for the width of the projected
+    // angle distribution (evaluated at the initial momentum)
+    G4double charge = track->GetDynamicParticle()->GetCharge() / eplus;
+    G4double momentum = track->GetMomentum().mag();
+    G4double beta = track->GetVelocity() / c_light;
+    G4double theta0 = 13.6 * MeV / ( beta * momentum ) * std::abs( charge ) * std::sqrt( depth )
+                      * ( 1. + 0.038 * std::log( depth * charge * charge / ( beta * beta ) ) );
+    theta0 = std::max( theta0, 0. );
+    G4double thetaX = G4RandGauss::shoot( 0., theta0 );
+    G4double thetaY = G4RandGauss::shoot( 0., theta0 );
+    G4ThreeVector axisU = localDirection.orthogonal().unit();
+    G4ThreeVector axisV = localDirection.cross( axisU );
+    G4ThreeVector newDirection = ( localDirection + std::tan( thetaX ) * axisU 
+                                   + std::tan( thetaY ) * axisV ).unit();
+
+    aFastStep.ProposePrimaryTrackFinalKineticEnergyAndDirection( kineticEnergy - energyLoss,
+                                                                 newDirection );
+    aFastStep.ProposeTotalEnergyDeposited( energyLoss );
+  }
+
+  // Place the particle at the foil exit
+  aFastStep.ProposePrimaryTrackFinalPosition( localPosition + pathLength * localDirection );
+  aFastStep.ProposePrimaryTrackPathLength( pathLength );
+  aFastStep.ProposePrimaryTrackFinalTime( track->GetGlobalTime() +
+                                          pathLength / track->GetVelocity() );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARFastSimModelTarget::ConvertPhoton( const G4FastTrack& aFastTrack, 
+                                             G4FastStep& aFastStep, G4double aPathLength ) {
+  const G4Track* track = aFastTrack.GetPrimaryTrack();
+  G4double photonEnergy = track->GetKineticEnergy();
+  G4ThreeVector localDirection = aFastTrack.GetPrimaryTrackLocalDirection();
+  G4double conversionLength = G4UniformRand() * aPathLength;
+  G4ThreeVector localPosition = aFastTrack.GetPrimaryTrackLocalPosition() 
+                                + conversionLength * localDirection;
+  G4double time = track->GetGlobalTime() + conversionLength / c_light;
+
+  // The Bethe-Heitler energy sharing is nearly flat at high energy: the
+  // electron takes a uniform fraction of the energy above the pair threshold,
+  // and both leptons keep the photon direction (opening angle ~ m_e/E)
+  G4double available = photonEnergy - 2. * electron_mass_c2;
+  G4double electronEnergy = G4UniformRand() * available;
+  G4DynamicParticle electron( G4Electron::Definition(), localDirection, electronEnergy );
+  G4DynamicParticle positron( G4Positron::Definition(), localDirection, 
+                              available - electronEnergy );
+
+  aFastStep.SetNumberOfSecondaryTracks( 2 );
+  aFastStep.CreateSecondaryTrack( electron, localPosition, time );
+  aFastStep.CreateSecondaryTrack( positron, localPosition, time );
+  aFastStep.KillPrimaryTrack();
+  aFastStep.ProposePrimaryTrackPathLength( conversionLength );
+  NNBAR_DEBUG( NNBARLogger::eGeneral, "Photon of " << photonEnergy / MeV 
+               << " MeV converted in the target" );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const G4PhysicsLogVector* NNBARFastSimModelTarget::GetStoppingPowerTable( 
+  const G4ParticleDefinition* aParticle, const G4Material* aMaterial ) {
+  auto it = fStoppingPowerTables.find( aParticle );
+  if ( it != fStoppingPowerTables.end() ) return it->second;
+
+  G4PhysicsLogVector* table = new G4PhysicsLogVector( fMinEnergy * MeV, fMaxEnergy * MeV, 
+                                                      fNumberOfBins );
+  G4double electronDensity = aMaterial->GetElectronDensity();
+  G4double excitationEnergy = aMaterial->GetIonisation()->GetMeanExcitationEnergy();
+  G4double mass = aParticle->GetPDGMass();
+  G4double charge = aParticle->GetPDGCharge() / eplus;
+  G4bool isLepton = aParticle == G4Electron::Definition()  ||  
+                    aParticle == G4Positron::Definition();
+  for ( std::size_t i = 0; i <= std::size_t( fNumberOfBins ); i++ ) {
+    G4double energy = table->Energy( i );
+    G4double dEdx;
+    if ( isLepton ) {
+      // Collision loss of electrons (Rohrlich-Carlson, without density effect)
+      // plus the mean radiative loss E/X0
+      G4double tau = energy / electron_mass_c2;
+      G4double gamma = tau + 1.;
+      G4double beta2 = 1. - 1. / ( gamma * gamma );
+      G4double f = 1. - beta2 + ( tau * tau / 8. - ( 2. * tau + 1. ) * std::log( 2. ) ) 
+                                / ( gamma * gamma );
+      G4double ratio = excitationEnergy / electron_mass_c2;
+      G4double collision = twopi * classic_electr_radius * classic_electr_radius 
+                           * electron_mass_c2 * electronDensity / beta2
+                           * std::max( std::log( tau * tau * ( tau + 2. ) / ( 2. * ratio * ratio ) )
+                                       + f, 1. );
+      dEdx = collision + energy / aMaterial->GetRadlen();
+    } else {
+      dEdx = NNBARDetectorParametrisation::GetStoppingPower( electronDensity, excitationEnergy,
+                                                             mass, charge, energy );
+    }
+    table->PutValue( i, dEdx );
+  }
+  fStoppingPowerTables[aParticle] = table;
+  NNBAR_INFO( NNBARLogger::eGeneral, "Target dE/dx table for " << aParticle->GetParticleName()
+              << " in " << aMaterial->GetName() << ": " 
+              << table->Value( 1.*GeV ) / ( MeV/cm ) << " MeV/cm at 1 GeV" );
+  return table;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -32,6 +32,9 @@
 #include "NNBARPrimaryParticleInformation.hh"
 #include "NNBARSmearer.hh"
 #include "NNBAROutput.hh"
+#include "NNBARHelix.hh"
+#include "NNBARLogger.hh"
+#include "NNBARRegionInformation.hh"
 
 #include "G4Track.hh"
 #include "G4Event.hh"
@@ -39,51 +42,71 @@
 #include "G4AnalysisManager.hh"
 
 #include "Randomize.hh"
+#include <cmath>
 
 #include "G4Electron.hh"
 #include "G4Positron.hh"
 #include "G4Gamma.hh"
 
-#include "G4PathFinder.hh"
-#include "G4FieldTrack.hh"
-#include "G4FieldTrackUpdator.hh"
+#include "G4TransportationManager.hh"
+#include "G4FieldManager.hh"
+#include "G4Field.hh"
+#include "G4VSolid.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 NNBARFastSimModelTracker::NNBARFastSimModelTracker( G4String aModelName, 
   G4Region* aEnvelope, NNBARDetectorParametrisation::Parametrisation aType ) :
-  G4VFastSimulationModel( aModelName, aEnvelope ), fCalculateParametrisation(),
-  fParametrisation( aType ) {}
+  G4VFastSimulationModel( aModelName, aEnvelope ), fCalculateParametrisation( new NNBARDetectorParametrisation() ),
+  fParametrisation( aType ), fInnerHalfSize( 0 ), fOuterHalfSize( 0 ),
+  fMaxPathLength( 20.0*m ),
+  fTriggerPolicy( "/NNBAR/tracker/trigger/" ), fTriggerDecision( NNBARTriggerPolicy::eParametrise ) {}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 NNBARFastSimModelTracker::NNBARFastSimModelTracker( G4String aModelName, 
                                                     G4Region* aEnvelope ) :
-  G4VFastSimulationModel( aModelName, aEnvelope ), fCalculateParametrisation(),
-  fParametrisation( NNBARDetectorParametrisation::eNNBAR ) {}
+  G4VFastSimulationModel( aModelName, aEnvelope ), fCalculateParametrisation( new NNBARDetectorParametrisation() ),
+  fParametrisation( NNBARDetectorParametrisation::eNNBAR ), fInnerHalfSize( 0 ),
+  fOuterHalfSize( 0 ), fMaxPathLength( 20.0*m ),
+  fTriggerPolicy( "/NNBAR/tracker/trigger/" ), fTriggerDecision( NNBARTriggerPolicy::eParametrise ) {}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 NNBARFastSimModelTracker::NNBARFastSimModelTracker( G4String aModelName ) :
-  G4VFastSimulationModel( aModelName ), fCalculateParametrisation(),
-  fParametrisation( NNBARDetectorParametrisation::eNNBAR ) {}
+  G4VFastSimulationModel( aModelName ), fCalculateParametrisation( new NNBARDetectorParametrisation() ),
+  fParametrisation( NNBARDetectorParametrisation::eNNBAR ), fInnerHalfSize( 0 ),
+  fOuterHalfSize( 0 ), fMaxPathLength( 20.0*m ),
+  fTriggerPolicy( "/NNBAR/tracker/trigger/" ), fTriggerDecision( NNBARTriggerPolicy::eParametrise ) {}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-NNBARFastSimModelTracker::~NNBARFastSimModelTracker() {}
+NNBARFastSimModelTracker::~NNBARFastSimModelTracker() {
+  delete fCalculateParametrisation;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-G4bool NNBARFastSimModelTracker::IsApplicable( const G4ParticleDefinition& 
-                                                                   aParticleType ) {
+G4bool NNBARFastSimModelTracker::IsApplicable( const G4ParticleDefinition& aParticleType ) {
+  return AppliesTo( aParticleType );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NNBARFastSimModelTracker::AppliesTo( const G4ParticleDefinition& aParticleType ) {
   return aParticleType.GetPDGCharge() != 0;  // Applicable for all charged particles
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-G4bool NNBARFastSimModelTracker::ModelTrigger( const G4FastTrack& /*aFastTrack*/ ) {
-  return true;  // No kinematical restrictions to apply the parametrisation
+G4bool NNBARFastSimModelTracker::ModelTrigger( const G4FastTrack& aFastTrack ) {
+  // Fully simulated region (hybrid mode)
+  if ( NNBARRegionInformation::IsFullSimulation( aFastTrack.GetEnvelope() ) ) return false;
+  const G4Track* track = aFastTrack.GetPrimaryTrack();
+  fTriggerDecision = fTriggerPolicy.Decide( track->GetDefinition(), track->GetKineticEnergy() );
+  return fTriggerDecision != NNBARTriggerPolicy::eTrack;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -91,34 +114,59 @@ G4bool NNBARFastSimModelTracker::ModelTrigger( const G4FastTrack& /*aFastTrack*/
 void NNBARFastSimModelTracker::DoIt( const G4FastTrack& aFastTrack,
                                      G4FastStep& aFastStep ) {
 
-  G4cout << " ________Tracker model triggered _________" << G4endl;
+  NNBAR_DEBUG( NNBARLogger::eTracker, "Tracker model triggered by " 
+               << aFastTrack.GetPrimaryTrack()->GetDefinition()->GetParticleName() );
+
+  // Below the trigger threshold: no parametrisation, the energy stays here
+  if ( fTriggerDecision == NNBARTriggerPolicy::eDirectDeposit ) {
+    NNBARTriggerPolicy::DepositDirectly( aFastTrack, aFastStep, NNBAROutput::eNoSave );
+    return;
+  }
 
   // Calculate the final position (at the outer boundary of the tracking detector)
   // of the particle with the momentum at the entrance of the tracking detector.
+  // The field is uniform, so the trajectory is a helix and its exit point is
+  // found analytically in the envelope local frame.
+  const G4Track* track = aFastTrack.GetPrimaryTrack();
+  G4ThreeVector field( 0 );
+  G4FieldManager* fieldManager = 
+    G4TransportationManager::GetTransportationManager()->GetFieldManager();
+  if ( fOuterHalfSize.x() > 0.  &&  fieldManager  &&  fieldManager->GetDetectorField() ) {
+    G4ThreeVector position = track->GetPosition();
+    G4double point[4] = { position.x(), position.y(), position.z(), track->GetGlobalTime() };
+    G4double value[6] = { 0., 0., 0., 0., 0., 0. };
+    fieldManager->GetDetectorField()->GetFieldValue( point, value );
+    field = aFastTrack.GetAffineTransformation()->
+              TransformAxis( G4ThreeVector( value[0], value[1], value[2] ) );
+  }
+  NNBARHelix helix( aFastTrack.GetPrimaryTrackLocalPosition(),
+                    aFastTrack.GetPrimaryTrackLocalDirection(),
+                    track->GetDynamicParticle()->GetCharge() / eplus,
+                    track->GetMomentum().mag(), field );
+
+  G4double pathLength = -1.0;
+  if ( fOuterHalfSize.x() > 0. ) {
+    pathLength = ComputeExitStep( helix );
+  } else {
+    // Envelope dimensions not set: straight line to the envelope boundary
+    pathLength = aFastTrack.GetEnvelopeSolid()->
+      DistanceToOut( aFastTrack.GetPrimaryTrackLocalPosition(),
+                     aFastTrack.GetPrimaryTrackLocalDirection() );
+  }
 
-  G4Track track = * aFastTrack.GetPrimaryTrack();
-  G4FieldTrack aFieldTrack( '0' );
-  G4FieldTrackUpdator::Update( &aFieldTrack, &track );
-
-  G4double retSafety = -1.0;
-  ELimited retStepLimited;
-  G4FieldTrack endTrack( 'a' );
-  G4double currentMinimumStep = 10.0*m;  // Temporary: change that to sth connected
-                                         // to particle momentum.
-  G4PathFinder* fPathFinder = G4PathFinder::GetInstance();
-  /*G4double lengthAlongCurve = */ 
-  fPathFinder->ComputeStep( aFieldTrack,
-                            currentMinimumStep,
-                            0,
-                            aFastTrack.GetPrimaryTrack()->GetCurrentStepNumber(),
-                            retSafety,
-                            retStepLimited,
-                            endTrack,
-                            aFastTrack.GetPrimaryTrack()->GetVolume() );
-
-  // Place the particle at the tracking detector exit 
-  // (at the place it would reach without the change of its momentum).
-  aFastStep.ProposePrimaryTrackFinalPosition( endTrack.GetPosition() );
+  if ( pathLength < 0. ) {
+    // The particle loops inside the tracking detector: stop it there
+    aFastStep.KillPrimaryTrack();
+    aFastStep.ProposePrimaryTrackPathLength( 0.0 );
+  } else {
+    // Place the particle at the tracking detector exit 
+    // (at the place it would reach without the change of its momentum).
+    aFastStep.ProposePrimaryTrackFinalPosition( helix.GetPosition( pathLength ) );
+    aFastStep.ProposePrimaryTrackFinalMomentumDirection( helix.GetDirection( pathLength ) );
+    aFastStep.ProposePrimaryTrackPathLength( pathLength );
+    aFastStep.ProposePrimaryTrackFinalTime( track->GetGlobalTime() +
+                                            pathLength / track->GetVelocity() );
+  }
 
   // Consider only primary tracks (do nothing else for secondary charged particles)
   G4ThreeVector Porg = aFastTrack.GetPrimaryTrack()->GetMomentum();
@@ -137,6 +185,13 @@ void NNBARFastSimModelTracker::DoIt( const G4FastTrack& aFastTrack,
       Psm = NNBARSmearer::Instance()->
                                  SmearMomentum( aFastTrack.GetPrimaryTrack(), res );
       NNBAROutput::Instance()->FillHistogram( 0, ((Psm.mag()/MeV) / (Porg.mag()/MeV)) );
+      NNBAROutput::Instance()->SaveTrack( NNBAROutput::eSaveTracker,
+                                          0,
+                                          track->GetDefinition()->GetPDGEncoding(),
+                                          track->GetKineticEnergy()/MeV,
+                                          Psm/MeV,
+                                          res,
+                                          eff );
       // Setting the values of Psm, res and eff
       ( (NNBARPrimaryParticleInformation*) ( const_cast< G4PrimaryParticle* >
           ( aFastTrack.GetPrimaryTrack()->GetDynamicParticle()->GetPrimaryParticle() )->
@@ -158,3 +213,59 @@ void NNBARFastSimModelTracker::DoIt( const G4FastTrack& aFastTrack,
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void NNBARFastSimModelTracker::SetEnvelopeDimensions( const G4ThreeVector& aInnerHalfSize,
+                                                      const G4ThreeVector& aOuterHalfSize ) {
+  fInnerHalfSize = aInnerHalfSize;
+  fOuterHalfSize = aOuterHalfSize;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double NNBARFastSimModelTracker::ComputeExitStep( const NNBARHelix& aHelix ) const {
+  // The particle starts on an envelope surface: skip the crossing at s = 0
+  const G4double sMin = 1.0*um;
+  const G4double tolerance = 1.0*um;
+  G4double sExit = fMaxPathLength;
+
+  // Walls along x (axis 0) and y (axis 1) of the inner and of the outer box.
+  // A plane crossing is an exit only if it lies within the face of the box.
+  for ( G4int axis = 0; axis < 2; axis++ ) {
+    const G4int other = 1 - axis;
+    for ( G4double sign : { -1., 1. } ) {
+      G4ThreeVector normal( 0., 0., 0. );
+      normal[axis] = sign;
+      for ( const G4ThreeVector* box : { &fInnerHalfSize, &fOuterHalfSize } ) {
+        G4double s = sMin;
+        while ( ( s = aHelix.FirstCrossing( normal, (*box)[axis], s, sExit ) ) > 0. ) {
+          G4ThreeVector position = aHelix.GetPosition( s );
+          if ( std::abs( position[other] ) <= (*box)[other] + tolerance  &&
+               std::abs( position.z() ) <= fOuterHalfSize.z() + tolerance ) {
+            sExit = s;
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  // Open ends of the shell along z
+  for ( G4double sign : { -1., 1. } ) {
+    G4ThreeVector normal( 0., 0., sign );
+    G4double s = sMin;
+    while ( ( s = aHelix.FirstCrossing( normal, fOuterHalfSize.z(), s, sExit ) ) > 0. ) {
+      G4ThreeVector position = aHelix.GetPosition( s );
+      G4bool inOuter = std::abs( position.x() ) <= fOuterHalfSize.x() + tolerance  &&
+                       std::abs( position.y() ) <= fOuterHalfSize.y() + tolerance;
+      G4bool inInner = std::abs( position.x() ) < fInnerHalfSize.x()  &&
+                       std::abs( position.y() ) < fInnerHalfSize.y();
+      if ( inOuter  &&  ! inInner ) {
+        sExit = s;
+        break;
+      }
+    }
+  }
+
+  return sExit < fMaxPathLength ? sExit : -1.0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,90 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARFullSimScorer.cc
+/// \brief Implementation of the NNBARFullSimScorer class
+
+#include "NNBARFullSimScorer.hh"
+#include "NNBARRegionInformation.hh"
+#include "NNBARTrackInformation.hh"
+#include "NNBAROutput.hh"
+
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Region.hh"
+#include "G4SystemOfUnits.hh"
+#include <algorithm>
+
+G4bool NNBARFullSimScorer::fEnabled = false;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARFullSimScorer* NNBARFullSimScorer::Instance() {
+  static G4ThreadLocal NNBARFullSimScorer* fullSimScorer = nullptr;
+  if ( ! fullSimScorer ) fullSimScorer = new NNBARFullSimScorer;
+  return fullSimScorer;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARFullSimScorer::NNBARFullSimScorer() : fDeposits() {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARFullSimScorer::AddStep( const G4Step* aStep ) {
+  G4double edep = aStep->GetTotalEnergyDeposit();
+  if ( edep <= 0 ) return;
+  const G4StepPoint* preStep = aStep->GetPreStepPoint();
+  const G4Region* region = preStep->GetPhysicalVolume()->GetLogicalVolume()->GetRegion();
+  auto info = static_cast< const NNBARRegionInformation* >( region->GetUserInformation() );
+  if ( ! info  ||  ! info->IsFullSimulation()  ||  
+       info->GetSaveType() == NNBAROutput::eNoSave ) return;
+
+  Deposit& deposit = fDeposits[ { region, NNBARTrackInformation::GetPrimaryIndex( aStep->GetTrack() ) } ];
+  G4ThreeVector position = 0.5 * ( preStep->GetPosition() + aStep->GetPostStepPoint()->GetPosition() );
+  deposit.fEnergy += edep;
+  deposit.fWeightedPosition += edep * position;
+  deposit.fTime = std::min( deposit.fTime, preStep->GetGlobalTime() );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARFullSimScorer::Flush() {
+  for ( const auto& entry : fDeposits ) {
+    const Deposit& deposit = entry.second;
+    auto info = static_cast< const NNBARRegionInformation* >( entry.first.first->GetUserInformation() );
+    // No single particle: the row has no track ID, PDG code nor true energy
+    NNBAROutput::Instance()->SaveTrack( info->GetSaveType(), -1, 0, 0,
+                                        deposit.fWeightedPosition / deposit.fEnergy / mm,
+                                        0, 1, deposit.fEnergy / MeV, deposit.fTime / ns,
+                                        0, 0, -1, 0, 0, entry.first.second );
+  }
+  fDeposits.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
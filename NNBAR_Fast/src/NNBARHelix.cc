@@ -0,0 +1,162 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARHelix.cc
+/// \brief Implementation of the NNBARHelix class
+
+#include "NNBARHelix.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+
+#include <algorithm>
+#include <cmath>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARHelix::NNBARHelix( const G4ThreeVector& aPosition, const G4ThreeVector& aDirection,
+                        G4double aCharge, G4double aMomentum, const G4ThreeVector& aField ) :
+  fPosition( aPosition ), fDirection( aDirection.unit() ), fFieldDirection( 0., 0., 1. ),
+  fDirectionPerp( 0 ), fDirectionPerpCross( 0 ), fDirectionPar( 0. ), fKappa( 0. ),
+  fStraight( true ) {
+  // Curvature from dp/ds = q * c_light * (d x B): the direction rotates around
+  // the field with kappa = q * c_light * |B| / p (radius = 1/|kappa| * sin(pitch))
+  if ( aMomentum > 0. && aCharge != 0. && aField.mag() > 0. ) {
+    fKappa = aCharge * c_light * aField.mag() / aMomentum;
+    // Below 1 rad over 1000 km the trajectory is a straight line for all purposes
+    fStraight = std::abs( fKappa ) < 1.e-9 / m;
+  }
+  if ( ! fStraight ) {
+    fFieldDirection = aField.unit();
+    fDirectionPar = fDirection.dot( fFieldDirection );
+    fDirectionPerp = fDirection - fDirectionPar * fFieldDirection;
+    fDirectionPerpCross = fDirectionPerp.cross( fFieldDirection );
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARHelix::~NNBARHelix() {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreeVector NNBARHelix::GetPosition( G4double aPathLength ) const {
+  if ( fStraight ) return fPosition + aPathLength * fDirection;
+  const G4double phi = fKappa * aPathLength;
+  return fPosition + ( fDirectionPar * aPathLength ) * fFieldDirection
+                   + ( std::sin( phi ) / fKappa ) * fDirectionPerp
+                   + ( ( 1. - std::cos( phi ) ) / fKappa ) * fDirectionPerpCross;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreeVector NNBARHelix::GetDirection( G4double aPathLength ) const {
+  if ( fStraight ) return fDirection;
+  const G4double phi = fKappa * aPathLength;
+  return ( fDirectionPar * fFieldDirection + std::cos( phi ) * fDirectionPerp
+           + std::sin( phi ) * fDirectionPerpCross ).unit();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double NNBARHelix::FirstCrossing( const G4ThreeVector& aNormal, G4double aOffset,
+                                    G4double aSMin, G4double aSMax ) const {
+  // Signed distance of the trajectory from the plane:
+  // f(s) = A + B*s + C*sin(kappa*s) + D*(1 - cos(kappa*s))
+  const G4double A = aNormal.dot( fPosition ) - aOffset;
+  if ( fStraight ) {
+    const G4double slope = aNormal.dot( fDirection );
+    if ( slope == 0. ) return -1.;
+    const G4double s = -A / slope;
+    return ( s > aSMin && s < aSMax ) ? s : -1.;
+  }
+  const G4double B = fDirectionPar * aNormal.dot( fFieldDirection );
+  const G4double C = aNormal.dot( fDirectionPerp ) / fKappa;
+  const G4double D = aNormal.dot( fDirectionPerpCross ) / fKappa;
+  const G4double rho = std::sqrt( C*C + D*D );
+
+  // Plane perpendicular to the field (or motion along the field): linear in s
+  if ( rho < 1.e-9*mm ) {
+    if ( B == 0. ) return -1.;
+    const G4double s = -A / B;
+    return ( s > aSMin && s < aSMax ) ? s : -1.;
+  }
+
+  // Plane parallel to the field: rho*sin(kappa*s - alpha) = -(A + D),
+  // two families of solutions repeating every turn
+  if ( std::abs( B ) < 1.e-12 ) {
+    const G4double rhs = -( A + D ) / rho;
+    if ( std::abs( rhs ) > 1. ) return -1.;
+    const G4double alpha = std::atan2( D, C );
+    const G4double beta = std::asin( rhs );
+    const G4double period = twopi / std::abs( fKappa );
+    G4double sFirst = -1.;
+    for ( G4double phi : { alpha + beta, alpha + pi - beta } ) {
+      G4double s = phi / fKappa;
+      s -= period * std::floor( ( s - aSMin ) / period );
+      if ( s <= aSMin ) s += period;
+      if ( s < aSMax && ( sFirst < 0. || s < sFirst ) ) sFirst = s;
+    }
+    return sFirst;
+  }
+
+  // General orientation: the oscillating part is bounded by 2*rho, so the roots
+  // lie where |A + B*s| <= 2*rho. Scan this window in quarter turns and refine
+  // the first sign change by bisection.
+  G4double sLo = ( -A - 2.*rho ) / B;
+  G4double sHi = ( -A + 2.*rho ) / B;
+  if ( sLo > sHi ) std::swap( sLo, sHi );
+  sLo = std::max( sLo, aSMin );
+  sHi = std::min( sHi, aSMax );
+  if ( sLo >= sHi ) return -1.;
+  auto distance = [&]( G4double s ) {
+    return A + B*s + C*std::sin( fKappa*s ) + D*( 1. - std::cos( fKappa*s ) );
+  };
+  const G4double quarterTurn = halfpi / std::abs( fKappa );
+  G4double s0 = sLo;
+  G4double f0 = distance( s0 );
+  while ( s0 < sHi ) {
+    G4double s1 = std::min( s0 + quarterTurn, sHi );
+    G4double f1 = distance( s1 );
+    if ( f0 * f1 < 0. ) {
+      for ( G4int i = 0; i < 60; i++ ) {
+        G4double sMid = 0.5 * ( s0 + s1 );
+        G4double fMid = distance( sMid );
+        if ( f0 * fMid <= 0. ) {
+          s1 = sMid;
+        } else {
+          s0 = sMid;
+          f0 = fMid;
+        }
+      }
+      return 0.5 * ( s0 + s1 );
+    }
+    s0 = s1;
+    f0 = f1;
+  }
+  return -1.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
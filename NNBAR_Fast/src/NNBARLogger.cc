@@ -0,0 +1,114 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARLogger.cc
+/// \brief Implementation of the NNBARLogger class
+
+#include "NNBARLogger.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int NNBARLogger::fLevels[NNBARLogger::eNumberOfCategories] = 
+  { NNBARLogger::eWarning, NNBARLogger::eWarning, NNBARLogger::eWarning,
+    NNBARLogger::eWarning, NNBARLogger::eWarning };
+G4ThreadLocal std::ostringstream* NNBARLogger::fBuffer = 0;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARLogger::SetLevel( Category aCategory, Level aLevel ) {
+  fLevels[aCategory] = aLevel;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARLogger::SetLevel( Level aLevel ) {
+  for ( G4int i = 0; i < eNumberOfCategories; i++ ) {
+    fLevels[i] = aLevel;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARLogger::Level NNBARLogger::GetLevel( Category aCategory ) {
+  return static_cast< Level >( fLevels[aCategory] );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::ostringstream& NNBARLogger::Buffer( Category aCategory, Level aLevel ) {
+  if ( ! fBuffer ) {
+    fBuffer = new std::ostringstream();
+  }
+  *fBuffer << "[" << GetCategoryName( aCategory ) << ":" << GetLevelName( aLevel ) << "] ";
+  return *fBuffer;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARLogger::CheckBufferSize() {
+  // Do not let a single verbose event hold an unbounded amount of memory
+  if ( fBuffer  &&  fBuffer->tellp() > 1048576 ) {
+    Flush();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARLogger::Flush() {
+  if ( ! fBuffer  ||  fBuffer->tellp() <= 0 ) return;
+  G4cout << fBuffer->str() << std::flush;
+  fBuffer->str( "" );
+  fBuffer->clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const char* NNBARLogger::GetCategoryName( Category aCategory ) {
+  switch ( aCategory ) {
+    case eGeneral : return "general";
+    case eTracker : return "tracker";
+    case eEMCal   : return "emcal";
+    case eHCal    : return "hcal";
+    case eOutput  : return "output";
+    default       : return "unknown";
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const char* NNBARLogger::GetLevelName( Level aLevel ) {
+  switch ( aLevel ) {
+    case eSilent  : return "silent";
+    case eError   : return "error";
+    case eWarning : return "warning";
+    case eInfo    : return "info";
+    case eDebug   : return "debug";
+    case eTrace   : return "trace";
+    default       : return "unknown";
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,101 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARLoggerMessenger.cc
+/// \brief Implementation of the NNBARLoggerMessenger class
+
+#include "NNBARLoggerMessenger.hh"
+#include "NNBARLogger.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARLoggerMessenger::NNBARLoggerMessenger() : G4UImessenger() {
+  fNNBARDirectory = new G4UIdirectory( "/NNBAR/" );
+  fNNBARDirectory->SetGuidance( "NNBAR fast simulation control." );
+
+  fLogDirectory = new G4UIdirectory( "/NNBAR/log/" );
+  fLogDirectory->SetGuidance( "Logging control." );
+
+  fLevelCmd = new G4UIcommand( "/NNBAR/log/level", this );
+  fLevelCmd->SetGuidance( "Set the runtime level of a log category." );
+  fLevelCmd->SetGuidance( "Levels above NNBAR_LOG_MAX_LEVEL are compiled out." );
+  G4UIparameter* category = new G4UIparameter( "category", 's', false );
+  category->SetParameterCandidates( "all general tracker emcal hcal output" );
+  fLevelCmd->SetParameter( category );
+  G4UIparameter* level = new G4UIparameter( "level", 's', false );
+  level->SetParameterCandidates( "silent error warning info debug trace" );
+  fLevelCmd->SetParameter( level );
+  fLevelCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+  fLevelCmd->SetToBeBroadcasted( false );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARLoggerMessenger::~NNBARLoggerMessenger() {
+  delete fLevelCmd;
+  delete fLogDirectory;
+  delete fNNBARDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARLoggerMessenger::SetNewValue( G4UIcommand* aCommand, G4String aNewValue ) {
+  if ( aCommand == fLevelCmd ) {
+    G4String categoryName, levelName;
+    std::istringstream is( aNewValue );
+    is >> categoryName >> levelName;
+
+    NNBARLogger::Level level = NNBARLogger::eSilent;
+    for ( G4int i = NNBARLogger::eSilent; i <= NNBARLogger::eTrace; i++ ) {
+      if ( levelName == NNBARLogger::GetLevelName( static_cast< NNBARLogger::Level >( i ) ) ) {
+        level = static_cast< NNBARLogger::Level >( i );
+      }
+    }
+    if ( level > NNBAR_LOG_MAX_LEVEL ) {
+      G4cout << "NNBARLoggerMessenger: level " << levelName 
+             << " is above the compiled-in maximum (NNBAR_LOG_MAX_LEVEL = " 
+             << NNBAR_LOG_MAX_LEVEL << "), these messages are not available." << G4endl;
+    }
+
+    if ( categoryName == "all" ) {
+      NNBARLogger::SetLevel( level );
+      return;
+    }
+    for ( G4int i = 0; i < NNBARLogger::eNumberOfCategories; i++ ) {
+      NNBARLogger::Category category = static_cast< NNBARLogger::Category >( i );
+      if ( categoryName == NNBARLogger::GetCategoryName( category ) ) {
+        NNBARLogger::SetLevel( category, level );
+      }
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
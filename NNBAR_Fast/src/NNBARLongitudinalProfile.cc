@@ -0,0 +1,144 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARLongitudinalProfile.cc
+/// \brief Implementation of the NNBARLongitudinalProfile class
+
+#include "NNBARLongitudinalProfile.hh"
+#include "NNBARLogger.hh"
+
+#include "G4Material.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cmath>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARLongitudinalProfile::NNBARLongitudinalProfile() : fRadiationLength( -1 ),
+  fCriticalEnergy( 0 ) {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARLongitudinalProfile::~NNBARLongitudinalProfile() {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARLongitudinalProfile::Build( const G4Material* aMaterial ) {
+  fRadiationLength = aMaterial->GetRadlen();
+  // Critical energy of solids, Ec = 610 MeV / (Z + 1.24), with the mean Z
+  // of the material (electrons per atom)
+  G4double meanZ = aMaterial->GetTotNbOfElectPerVolume() / aMaterial->GetTotNbOfAtomsPerVolume();
+  fCriticalEnergy = 610. * MeV / ( meanZ + 1.24 );
+
+  for ( G4int species = 0; species < 2; species++ ) {
+    fTable[species].resize( fNumberOfEnergyNodes * fNumberOfDepthNodes );
+    for ( G4int i = 0; i < fNumberOfEnergyNodes; i++ ) {
+      G4double energy = std::pow( 10., fLogEnergyMin + i * ( fLogEnergyMax - fLogEnergyMin ) 
+                                                       / ( fNumberOfEnergyNodes - 1 ) ) * MeV;
+      G4double shape = GetShape( energy, species == 1 );
+      for ( G4int j = 0; j < fNumberOfDepthNodes; j++ ) {
+        G4double depth = j * fMaxDepth / ( fNumberOfDepthNodes - 1 );
+        fTable[species][i * fNumberOfDepthNodes + j] = IncompleteGamma( shape, fBeta * depth );
+      }
+    }
+  }
+  NNBAR_INFO( NNBARLogger::eEMCal, "Longitudinal profile tables for " << aMaterial->GetName() 
+              << ": X0 = " << fRadiationLength / cm << " cm, Ec = " << fCriticalEnergy / MeV 
+              << " MeV" );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double NNBARLongitudinalProfile::GetShape( G4double aEnergy, G4bool aPhoton ) const {
+  G4double tMax = std::log( aEnergy / fCriticalEnergy ) + ( aPhoton ? 0.5 : -0.5 );
+  // Below the critical energy the profile becomes a falling exponential
+  return 1. + fBeta * std::max( 0., tMax );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double NNBARLongitudinalProfile::GetContainedFraction( G4double aEnergy, G4double aDepth,
+                                                         G4bool aPhoton ) const {
+  if ( ! IsBuilt() ) return 1.;
+  G4double depth = aDepth / fRadiationLength;
+  if ( depth <= 0. ) return 0.;
+  if ( depth >= fMaxDepth ) return 1.;
+
+  // Bilinear interpolation in (log10 E, t)
+  G4double x = ( std::log10( aEnergy / MeV ) - fLogEnergyMin ) / ( fLogEnergyMax - fLogEnergyMin ) 
+               * ( fNumberOfEnergyNodes - 1 );
+  x = std::max( 0., std::min( G4double( fNumberOfEnergyNodes - 1 ), x ) );
+  G4int i = std::min( G4int( x ), fNumberOfEnergyNodes - 2 );
+  G4double y = depth / fMaxDepth * ( fNumberOfDepthNodes - 1 );
+  G4int j = std::min( G4int( y ), fNumberOfDepthNodes - 2 );
+  G4double fx = x - i;
+  G4double fy = y - j;
+
+  const std::vector< G4double >& table = fTable[aPhoton ? 1 : 0];
+  const G4double* row = &table[i * fNumberOfDepthNodes + j];
+  const G4double* nextRow = row + fNumberOfDepthNodes;
+  return ( 1. - fx ) * ( ( 1. - fy ) * row[0] + fy * row[1] )
+         + fx * ( ( 1. - fy ) * nextRow[0] + fy * nextRow[1] );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double NNBARLongitudinalProfile::IncompleteGamma( G4double a, G4double x ) {
+  if ( x <= 0. ) return 0.;
+  G4double logPrefactor = a * std::log( x ) - x - std::lgamma( a );
+  if ( x < a + 1. ) {
+    // Series expansion
+    G4double term = 1. / a;
+    G4double sum = term;
+    for ( G4int n = 1; n < 500; n++ ) {
+      term *= x / ( a + n );
+      sum += term;
+      if ( std::abs( term ) < std::abs( sum ) * 1e-15 ) break;
+    }
+    return std::min( 1., sum * std::exp( logPrefactor ) );
+  }
+  // Continued fraction for the complement Q(a, x) (modified Lentz method)
+  const G4double tiny = 1e-300;
+  G4double b = x + 1. - a;
+  G4double c = 1. / tiny;
+  G4double d = 1. / b;
+  G4double h = d;
+  for ( G4int n = 1; n < 500; n++ ) {
+    G4double an = -n * ( n - a );
+    b += 2.;
+    d = an * d + b;
+    if ( std::abs( d ) < tiny ) d = tiny;
+    c = b + an / c;
+    if ( std::abs( c ) < tiny ) c = tiny;
+    d = 1. / d;
+    G4double delta = d * c;
+    h *= delta;
+    if ( std::abs( delta - 1. ) < 1e-15 ) break;
+  }
+  return std::max( 0., 1. - std::exp( logPrefactor ) * h );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
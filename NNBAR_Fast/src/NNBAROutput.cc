@@ -29,27 +29,70 @@
 
 #include "NNBAROutput.hh"
 #include "NNBAREventInformation.hh"
+#include "NNBARLogger.hh"
+#include "NNBAROutputWriter.hh"
+#include "NNBAROutputMessenger.hh"
+#include "NNBARColumnarFile.hh"
 #include <vector>
 #include "G4Event.hh"
 #include "G4RunManager.hh"
 #include "G4UnitsTable.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4AnalysisManager.hh"
+#include "G4Threading.hh"
+#include "G4Exception.hh"
+#include "G4AutoLock.hh"
+#include <sys/stat.h>
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <type_traits>
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-NNBAROutput* NNBAROutput::fNNBAROutput = 0;
+G4ThreadLocal NNBAROutput* NNBAROutput::fNNBAROutput = 0;
+G4double NNBAROutput::fTotalRootWriteTime = 0;
+std::size_t NNBAROutput::fTotalRootWrittenSize = 0;
+G4int NNBAROutput::fTotalAcceptedEvents = 0;
+G4int NNBAROutput::fTotalRejectedEvents = 0;
+G4int NNBAROutput::fManifestRunID = -1;
+
+namespace {
+  G4Mutex outputMutex = G4MUTEX_INITIALIZER;
+}
 //G4ThreadLocal G4int NNBAROutput::fCurrentNtupleId = 0;
 //G4ThreadLocal G4int NNBAROutput::fCurrentID = 0; 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-NNBAROutput::NNBAROutput() : fFileNameWithRunNo( false ) {
+NNBAROutput::NNBAROutput() : fFileNameWithRunNo( false ), fNtuplesCreated( false ),
+  fHistogramsCreated( false ), fBookingTime( 0 ), fSaveTime( 0 ), fSavedEvents( 0 ),
+  fAsyncWriter( true ), fWriterMemoryLimit( 256 * 1024 * 1024 ), fWriter( nullptr ),
+  fFormat( eRootFormat ), fColumnarWriter( nullptr ), fCompressionLevel( 1 ), fBasketSize( 0 ),
+  fBasketEntries( 0 ), fRootWriteTime( 0 ), fRootWrittenSize( 0 ), fRejectedEvents( 0 ), fHistogramsOnly( false ),
+  fLayout( eVectorLayout ), fBookedLayout( eVectorLayout ), fEventsNtupleId( -1 ),
+  fWriteSummary( true ), fSummaryNtupleId( -1 ), fShardEvents( 0 ), fShardSize( 0 ),
+  fSharded( false ), fMergedNtuples( true ), fRunID( 0 ), fShard( 0 ), fShardWrittenEvents( 0 ),
+  fShardFirstEvent( -1 ), fShardLastEvent( -1 ), fShardRootSize( 0 ) {
   fFileName = "NNBARFastOutput.root";
+  fEvent = &fBoundEvent;
+  // Typical event sizes, the records grow further if needed
+  fBoundEvent.fMC.Reserve( 256 );
+  fBoundEvent.fTracker.Reserve( 64 );
+  fBoundEvent.fEMCal.Reserve( 256 );
+  fBoundEvent.fHCal.Reserve( 64 );
+  fBoundEvent.ForEachRecord( [this]( const char* aName, const char*, const auto& ) {
+    fRecordNames.push_back( aName );
+  } );
+  fMessenger = new NNBAROutputMessenger( this );
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 NNBAROutput::~NNBAROutput() {
+  delete fWriter;
+  delete fColumnarWriter;
+  delete fMessenger;
+  if ( fNNBAROutput == this ) fNNBAROutput = 0;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -89,73 +132,723 @@ void NNBAROutput::StartAnalysis( G4int aRunID ) {
   }
   analysisManager->SetDefaultFileType("root");
   analysisManager->SetVerboseLevel( 1 );
-  analysisManager->SetFileName( fFileName );
-  analysisManager->OpenFile( fFileName );
+  analysisManager->SetCompressionLevel( fCompressionLevel );
+  if ( fBasketSize > 0 ) analysisManager->SetBasketSize( fBasketSize );
+  if ( fBasketEntries > 0 ) analysisManager->SetBasketEntries( fBasketEntries );
+  // The name of the output without the extension, the shards add their index
+  fBaseName = fFileName;
+  if ( fBaseName.size() > 5  &&  fBaseName.substr( fBaseName.size() - 5 ) == ".root" ) {
+    fBaseName.erase( fBaseName.size() - 5 );
+  }
+  fRunID = aRunID;
+  fShard = 0;
+  // The ntuples merged in the file of the master cannot be split
+  fSharded = ( fShardEvents > 0  ||  fShardSize > 0 )  &&  ! fHistogramsOnly  &&  
+             ! ( fNtuplesCreated  &&  fMergedNtuples  &&  G4Threading::IsMultithreadedApplication() );
+  OpenShard();
+
+  // The skim is compiled once for the run
+  fSkim.Compile( fBoundEvent );
+
+  // The ntuples written in the run (the columns are chosen at the booking)
+  fWrittenNtuples.clear();
+  fBoundEvent.ForEachRecord( [this]( const char* aName, const char*, const auto& ) {
+    fWrittenNtuples.push_back( ! fHistogramsOnly  &&  fDisabledNtuples.count( aName ) == 0 );
+  } );
+  fWriteSummary = ! fHistogramsOnly  &&  fDisabledNtuples.count( "Summary" ) == 0;
+
+  // The columnar file of the thread, opened at the first event (the threads
+  // without events, as the master, do not write it)
+  if ( fFormat != eRootFormat  &&  ! fHistogramsOnly ) {
+    fColumnarFileName = GetThreadFileName( ".nnbc" );
+    delete fColumnarWriter;
+    fColumnarWriter = new NNBARColumnarFileWriter;
+    fColumnarColumns.clear();
+    auto addColumn = [this]( const char* aColumnName, auto aValue ) {
+      using Value = decltype( aValue );
+      auto fixedPoint = fFixedPoint.find( aColumnName );
+      if ( fixedPoint == fFixedPoint.end() ) {
+        fColumnarWriter->AddColumn( aColumnName, NNBARColumnarFormat::TypeOf< Value >() );
+      } else {
+        fColumnarWriter->AddColumn( aColumnName, NNBARColumnarFormat::TypeOf< Value >(), 
+          fixedPoint->second.fMinimum, fixedPoint->second.fMaximum, fixedPoint->second.fScale );
+      }
+    };
+    std::size_t ntuple = 0;
+    fBoundEvent.ForEachRecord( [&]( const char* aName, const char*, const auto& aRecord ) {
+      G4bool written = fWrittenNtuples[ntuple++];
+      if ( written ) fColumnarWriter->AddNtuple( aName );
+      aRecord.ForEachColumn( [&]( const char* aColumnName, const auto& aColumn ) {
+        fColumnarColumns.push_back( written  &&  fDisabledColumns.count( aColumnName ) == 0 );
+        if ( fColumnarColumns.back() ) {
+          addColumn( aColumnName, typename std::decay< decltype( aColumn ) >::type::value_type() );
+        }
+      } );
+    } );
+    // The summary, with the event ID
+    if ( fWriteSummary ) {
+      fColumnarWriter->AddNtuple( "Summary" );
+      addColumn( "eventID", G4int() );
+    }
+    fBoundEvent.fSummary.ForEachColumn( [&]( const char* aColumnName, auto aValue ) {
+      fColumnarColumns.push_back( fWriteSummary  &&  fDisabledColumns.count( aColumnName ) == 0 );
+      if ( fColumnarColumns.back() ) addColumn( aColumnName, aValue );
+    } );
+  } else {
+    fColumnarFileName = "";
+  }
+
+  G4bool root = fFormat != eColumnarFormat;
+  G4bool columnar = fFormat != eRootFormat;
+  fWriteRows = [this, analysisManager, root, columnar]() {
+    // The histograms filled during an asynchronous event (none otherwise)
+    for ( const auto& fill : fBoundEvent.fHistogramFills ) {
+      analysisManager->FillH1( fill.first, fill.second );
+    }
+    if ( ! fBoundEvent.fWritten ) return;
+    if ( root ) {
+      // The baskets are compressed and written when full
+      Clock::time_point start = Clock::now();
+      if ( fBookedLayout == eFlatLayout ) {
+        WriteFlatRows( analysisManager );
+      } else {
+        for ( std::size_t i = 0; i < fNtupleIds.size(); i++ ) {
+          if ( fNtupleIds[i] >= 0  &&  fWrittenNtuples[i] ) analysisManager->AddNtupleRow( fNtupleIds[i] );
+        }
+      }
+      if ( fSummaryNtupleId >= 0  &&  fWriteSummary ) WriteSummaryRow( analysisManager );
+      fRootWriteTime += std::chrono::duration< G4double >( Clock::now() - start ).count();
+    }
+    if ( columnar ) WriteColumnar();
+  };
+
+  // The events are filled in the buffers of the writer thread, or directly in
+  // the event bound to the ntuples. The writer thread is then the only user of
+  // the analysis manager until the end of the run (see FillHistogram()).
+  if ( fAsyncWriter ) {
+    if ( ! fWriter ) {
+      fWriter = new NNBAROutputWriter( fBoundEvent, [this]() { fWriteRows(); } );
+    }
+    fWriter->SetMemoryLimit( fWriterMemoryLimit );
+    if ( fEvent == &fBoundEvent ) fEvent = fWriter->Acquire();
+  } else {
+    fEvent = &fBoundEvent;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutput::WriteColumnar() {
+  if ( fColumnarFileName.empty() ) return;
+  if ( ! fColumnarWriter->IsOpen()  &&  ! fColumnarWriter->Open( fColumnarFileName ) ) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open the columnar file " << fColumnarFileName 
+        << ", the ntuples of the run are not saved in it.";
+    G4Exception( "NNBAROutput::WriteColumnar()", "NNBAR003", JustWarning, msg );
+    fColumnarFileName = "";
+    return;
+  }
+  std::size_t index = 0;
+  std::size_t column = 0;
+  fBoundEvent.ForEachRecord( [&]( const char*, const char*, const auto& aRecord ) {
+    aRecord.ForEachColumn( [&]( const char*, const auto& aColumn ) {
+      if ( fColumnarColumns[index++] ) fColumnarWriter->Fill( column++, aColumn.data(), aColumn.size() );
+    } );
+  } );
+  if ( fWriteSummary ) fColumnarWriter->Fill( column++, &fBoundEvent.fEventID, 1 );
+  fBoundEvent.fSummary.ForEachColumn( [&]( const char*, const auto& aValue ) {
+    if ( fColumnarColumns[index++] ) fColumnarWriter->Fill( column++, &aValue, 1 );
+  } );
+  fColumnarWriter->EndEvent();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void NNBAROutput::EndAnalysis() {
+  // All the queued events are written before the files are closed
+  if ( fWriter ) fWriter->Stop();
+  CloseShard();
+  ReportRootWrite();
+  ReportSkim();
+
+  // Booking the ntuples for each event (as it used to be done) cost the
+  // booking time on top of the saving time of every event
+  if ( fSavedEvents > 0 ) {
+    NNBAR_INFO( NNBARLogger::eOutput, "Output of " << fSavedEvents << " events: "
+                << 1e6 * fSaveTime / fSavedEvents << " us/event to save, ntuples booked once in "
+                << 1e6 * fBookingTime << " us" );
+    if ( fWriter  &&  fEvent != &fBoundEvent ) {
+      NNBAR_INFO( NNBARLogger::eOutput, "Output writer thread: waited " 
+                  << 1e3 * fWriter->GetWaitTime() << " ms on the output, peak queue of "
+                  << fWriter->GetPeakMemory() / 1024. << " kB" );
+    }
+  }
+  if ( fWriter ) fWriter->ResetStatistics();
+  fSaveTime = 0;
+  fSavedEvents = 0;
+  fRejectedEvents = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String NNBAROutput::GetOutputName() const {
+  if ( ! fSharded  ||  
+       ( G4Threading::IsMasterThread()  &&  G4Threading::IsMultithreadedApplication() ) ) {
+    return fBaseName;
+  }
+  return fBaseName + "_shard" + G4UIcommand::ConvertToString( fShard );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String NNBAROutput::GetThreadFileName( const G4String& aExtension ) const {
+  G4String fileName = GetOutputName();
+  if ( G4Threading::IsWorkerThread() ) {
+    fileName += "_t" + G4UIcommand::ConvertToString( G4Threading::G4GetThreadId() );
+  }
+  return fileName + aExtension;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  /// Gets the size of a file (0 if it does not exist).
+  std::size_t GetFileSize( const G4String& aFileName ) {
+    struct stat status;
+    return stat( aFileName.c_str(), &status ) == 0 ? std::size_t( status.st_size ) : 0;
+  }
+}
+
+void NNBAROutput::OpenShard() {
+  // The analysis manager adds the thread ID to the files of the workers
+  G4String fileName = GetOutputName() + ".root";
+  G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+  analysisManager->SetFileName( fileName );
+  analysisManager->OpenFile( fileName );
+  // The offsets of the flat layout are rows of the file
+  for ( auto& table : fFlatTables ) table.fRows = 0;
+  fShardWrittenEvents = 0;
+  fShardRootSize = 0;
+  fShardFirstEvent = -1;
+  fShardLastEvent = -1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutput::CloseShard() {
+  if ( fColumnarWriter ) fColumnarWriter->Close();
+
+  Clock::time_point start = Clock::now();
   G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
   analysisManager->Write();
   analysisManager->CloseFile();
+  fRootWriteTime += std::chrono::duration< G4double >( Clock::now() - start ).count();
+  fRootWrittenSize += GetFileSize( GetThreadFileName( ".root" ) );
+  if ( fSharded ) AddToManifest();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NNBAROutput::IsShardFull() {
+  if ( fShardWrittenEvents == 0 ) return false;
+  if ( fShardEvents > 0  &&  fShardWrittenEvents >= fShardEvents ) return true;
+  if ( fShardSize == 0 ) return false;
+  // The columnar writer counts its bytes. The analysis manager does not: the
+  // Root file is looked up on disk every few events only, and its size lags
+  // behind by the baskets not yet written.
+  if ( fFormat != eColumnarFormat  &&  fShardWrittenEvents % fShardSizeCheckInterval == 0 ) {
+    fShardRootSize = GetFileSize( GetThreadFileName( ".root" ) );
+  }
+  std::size_t size = fShardRootSize;
+  if ( ! fColumnarFileName.empty() ) size += fColumnarWriter->GetSize();
+  return size >= fShardSize;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void NNBAROutput::AddToManifest() {
+  G4AutoLock lock( &outputMutex );
+  // A line per file: name, format, thread (-1 for the master), events, IDs of
+  // the first and last events, size in bytes
+  G4String manifestName = fBaseName + "_manifest.txt";
+  std::ofstream manifest;
+  if ( fManifestRunID != fRunID ) {
+    fManifestRunID = fRunID;
+    manifest.open( manifestName, std::ios::trunc );
+    manifest << "# file format thread events firstEvent lastEvent bytes" << std::endl;
+  } else {
+    manifest.open( manifestName, std::ios::app );
+  }
+  if ( ! manifest ) {
+    G4ExceptionDescription msg;
+    msg << "Cannot write the manifest " << manifestName << ".";
+    G4Exception( "NNBAROutput::AddToManifest()", "NNBAR003", JustWarning, msg );
+    return;
+  }
+  auto addFile = [&]( const G4String& aFileName, const char* aFormat ) {
+    manifest << aFileName << " " << aFormat << " " << G4Threading::G4GetThreadId() << " " 
+             << fShardWrittenEvents << " " << fShardFirstEvent << " " << fShardLastEvent << " " 
+             << GetFileSize( aFileName ) << std::endl;
+  };
+  addFile( GetThreadFileName( ".root" ), "root" );
+  if ( ! fColumnarFileName.empty()  &&  fShardWrittenEvents > 0 ) addFile( fColumnarFileName, "columnar" );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutput::ReportRootWrite() {
+  G4AutoLock lock( &outputMutex );
+  fTotalRootWriteTime += fRootWriteTime;
+  fTotalRootWrittenSize += fRootWrittenSize;
+  fRootWriteTime = 0;
+  fRootWrittenSize = 0;
+  // The workers end their runs before the master, which reports the files of
+  // all the threads (its own holds the merged histograms, and the ntuples
+  // unless they are written per thread)
+  if ( ! G4Threading::IsMasterThread() ) return;
+
+  if ( fTotalRootWrittenSize > 0 ) {
+    G4double size = fTotalRootWrittenSize / ( 1024. * 1024. );
+    G4cout << "NNBAROutput: Root files of " << fBaseName << ": compression level " << fCompressionLevel 
+           << ( fCompressionLevel > 0 ? " (zlib)" : " (none)" ) << ", basket size "
+           << ( fBasketSize > 0 ? G4UIcommand::ConvertToString( fBasketSize ) : G4String( "default" ) )
+           << ", basket entries " 
+           << ( fBasketEntries > 0 ? G4UIcommand::ConvertToString( fBasketEntries ) : G4String( "default" ) )
+           << ": " << size << " MB written in " << fTotalRootWriteTime << " s ("
+           << ( fTotalRootWriteTime > 0 ? size / fTotalRootWriteTime : 0. ) << " MB/s)" << G4endl;
+  }
+  fTotalRootWriteTime = 0;
+  fTotalRootWrittenSize = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutput::ReportSkim() {
+  G4AutoLock lock( &outputMutex );
+  fTotalAcceptedEvents += fSavedEvents;
+  fTotalRejectedEvents += fRejectedEvents;
+  if ( ! G4Threading::IsMasterThread() ) return;
+
+  if ( fSkim.IsActive() ) {
+    G4int events = fTotalAcceptedEvents + fTotalRejectedEvents;
+    G4cout << "NNBAROutput: skim \"" << fSkim.GetExpression() << "\": accepted " 
+           << fTotalAcceptedEvents << ", rejected " << fTotalRejectedEvents << " of " << events 
+           << " events (" << ( events > 0 ? 100. * fTotalAcceptedEvents / events : 0. ) << "% accepted)" 
+           << G4endl;
+  }
+  fTotalAcceptedEvents = 0;
+  fTotalRejectedEvents = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutput::SetCompression( const G4String& aCodec, G4int aLevel ) {
+  if ( aCodec == "none" ) {
+    fCompressionLevel = 0;
+    return;
+  }
+  if ( aCodec != "zlib" ) {
+    G4ExceptionDescription msg;
+    msg << "The Geant4 Root writer supports zlib compression only, " << aCodec 
+        << " is replaced by zlib.";
+    G4Exception( "NNBAROutput::SetCompression()", "NNBAR003", JustWarning, msg );
+  }
+  fCompressionLevel = aLevel;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutput::SetFixedPoint( const G4String& aColumn, G4double aMinimum, 
+                                 G4double aMaximum, G4double aScale ) {
+  G4bool found = false;
+  G4bool floating = false;
+  fBoundEvent.ForEachRecord( [&]( const char*, const char*, const auto& aRecord ) {
+    aRecord.ForEachColumn( [&]( const char* aName, const auto& aValues ) {
+      using Value = typename std::decay< decltype( aValues ) >::type::value_type;
+      if ( aColumn != aName ) return;
+      found = true;
+      floating = std::is_floating_point< Value >::value;
+    } );
+  } );
+  if ( ! found  ||  ! floating ) {
+    G4ExceptionDescription msg;
+    msg << "The column " << aColumn << ( found ? " is not a floating point column" : " does not exist" ) 
+        << ", it cannot be stored in fixed point.";
+    G4Exception( "NNBAROutput::SetFixedPoint()", "NNBAR003", JustWarning, msg );
+    return;
+  }
+  if ( aScale <= 0 ) {
+    fFixedPoint.erase( aColumn );
+    return;
+  }
+  if ( aMaximum <= aMinimum  ||  ( aMaximum - aMinimum ) / aScale > 4294967295. ) {
+    G4ExceptionDescription msg;
+    msg << "The range [" << aMinimum << ", " << aMaximum << "] with the scale " << aScale 
+        << " does not fit in 32 bits, the column " << aColumn << " is stored as is.";
+    G4Exception( "NNBAROutput::SetFixedPoint()", "NNBAR003", JustWarning, msg );
+    fFixedPoint.erase( aColumn );
+    return;
+  }
+  fFixedPoint[aColumn] = { aMinimum, aMaximum, aScale };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutput::SetNtupleEnabled( const G4String& aNtuple, G4bool aEnabled ) {
+  G4int ntuple = -1;
+  G4int index = 0;
+  fBoundEvent.ForEachRecord( [&]( const char* aName, const char*, const auto& ) {
+    if ( aNtuple == aName ) ntuple = index;
+    index++;
+  } );
+  if ( ntuple < 0  &&  aNtuple != "Summary" ) {
+    G4ExceptionDescription msg;
+    msg << "The ntuple " << aNtuple << " does not exist (MC, Tracker, EMCAL, HCAL, Summary).";
+    G4Exception( "NNBAROutput::SetNtupleEnabled()", "NNBAR003", JustWarning, msg );
+    return;
+  }
+  if ( aEnabled ) {
+    fDisabledNtuples.erase( aNtuple );
+    if ( fNtuplesCreated  &&  ( ntuple < 0 ? fSummaryNtupleId < 0 : ! IsBooked( ntuple ) ) ) {
+      WarnBooked( "the ntuple " + aNtuple + " is written to the columnar file only." );
+    }
+  } else {
+    fDisabledNtuples.insert( aNtuple );
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutput::SetColumnEnabled( const G4String& aColumn, G4bool aEnabled ) {
+  G4bool found = false;
+  fBoundEvent.ForEachRecord( [&]( const char*, const char*, const auto& aRecord ) {
+    aRecord.ForEachColumn( [&]( const char* aName, const auto& ) {
+      if ( aColumn == aName ) found = true;
+    } );
+  } );
+  fBoundEvent.fSummary.ForEachColumn( [&]( const char* aName, const auto& ) {
+    if ( aColumn == aName ) found = true;
+  } );
+  if ( ! found ) {
+    G4ExceptionDescription msg;
+    msg << "The column " << aColumn << " does not exist.";
+    G4Exception( "NNBAROutput::SetColumnEnabled()", "NNBAR003", JustWarning, msg );
+    return;
+  }
+  if ( aEnabled ) {
+    fDisabledColumns.erase( aColumn );
+  } else {
+    fDisabledColumns.insert( aColumn );
+  }
+  if ( fNtuplesCreated ) {
+    WarnBooked( "the selection of the column " + aColumn + " applies to the columnar file only." );
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutput::SetHistogramsOnly( G4bool aHistogramsOnly ) {
+  fHistogramsOnly = aHistogramsOnly;
+  if ( ! fHistogramsOnly  &&  fNtuplesCreated ) {
+    for ( std::size_t i = 0; i <= fRecordNames.size(); i++ ) {
+      if ( i < fRecordNames.size() ? ! IsBooked( i ) : fSummaryNtupleId < 0 ) {
+        WarnBooked( "the ntuples not booked then are written to the columnar file only." );
+        return;
+      }
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutput::SetLayout( Layout aLayout ) {
+  fLayout = aLayout;
+  if ( fNtuplesCreated  &&  fLayout != fBookedLayout ) {
+    WarnBooked( "their layout is kept for all the runs." );
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutput::SetShardEvents( G4int aEvents ) {
+  fShardEvents = aEvents;
+  if ( fShardEvents > 0  &&  fNtuplesCreated  &&  fMergedNtuples  &&  
+       G4Threading::IsMultithreadedApplication() ) {
+    WarnBooked( "the ntuples of the threads are merged, the output is not split in shards." );
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutput::SetShardSize( std::size_t aSize ) {
+  fShardSize = aSize;
+  if ( fShardSize > 0  &&  fNtuplesCreated  &&  fMergedNtuples  &&  
+       G4Threading::IsMultithreadedApplication() ) {
+    WarnBooked( "the ntuples of the threads are merged, the output is not split in shards." );
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NNBAROutput::IsBooked( std::size_t aRecord ) const {
+  if ( fBookedLayout == eVectorLayout ) return fNtupleIds[aRecord] >= 0;
+  std::size_t table = 0;
+  G4bool booked = false;
+  fBoundEvent.ForEachTable( [&]( const char*, std::size_t aTableRecord, const auto&, std::size_t, std::size_t ) {
+    if ( aTableRecord == aRecord  &&  fFlatTables[table].fNtupleId >= 0 ) booked = true;
+    table++;
+  } );
+  return booked;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutput::WarnBooked( const G4String& aMessage ) const {
+  // The commands are broadcast to all the threads, the master warns once
+  if ( ! G4Threading::IsMasterThread() ) return;
+  G4ExceptionDescription msg;
+  msg << "The Root ntuples are booked at the first run: " << aMessage;
+  G4Exception( "NNBAROutput::WarnBooked()", "NNBAR003", JustWarning, msg );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutput::SetWriterMemoryLimit( std::size_t aLimit ) {
+  fWriterMemoryLimit = aLimit;
+  if ( fWriter ) fWriter->SetMemoryLimit( aLimit );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  /// Binds a column of an event record to a column of the current ntuple.
+  void CreateColumn( G4AnalysisManager* aManager, const G4String& aName, 
+                     std::vector< G4int >& aColumn ) {
+    aManager->CreateNtupleIColumn( aName, aColumn );
+  }
+  void CreateColumn( G4AnalysisManager* aManager, const G4String& aName, 
+                     std::vector< G4float >& aColumn ) {
+    aManager->CreateNtupleFColumn( aName, aColumn );
+  }
+  void CreateColumn( G4AnalysisManager* aManager, const G4String& aName, 
+                     std::vector< G4double >& aColumn ) {
+    aManager->CreateNtupleDColumn( aName, aColumn );
+  }
+}
+
 void NNBAROutput::CreateNtuples() {
+  if ( fNtuplesCreated ) return;
+  fNtuplesCreated = true;
+  Clock::time_point start = Clock::now();
+
+  G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+  // The offsets of the flat layout are rows of the file of the thread, and
+  // the shards are files of the thread
+  fMergedNtuples = fLayout != eFlatLayout  &&  fShardEvents == 0  &&  fShardSize == 0;
+  analysisManager->SetNtupleMerging( fMergedNtuples );
+  auto createColumn = [analysisManager]( const G4String& aName, auto& aColumn ) {
+    CreateColumn( analysisManager, aName, aColumn );
+  };
+
+  fBookedLayout = fLayout;
+  if ( fLayout == eFlatLayout ) {
+    CreateFlatNtuples();
+  } else {
+    // The ntuple IDs follow the booked ntuples
+    G4int ntupleId = 0;
+    fNtupleIds.clear();
+    fBoundEvent.ForEachRecord( [&]( const char* aName, const char* aTitle, auto& aRecord ) {
+      if ( fHistogramsOnly  ||  fDisabledNtuples.count( aName ) > 0 ) {
+        fNtupleIds.push_back( -1 );
+        return;
+      }
+      analysisManager->CreateNtuple( aName, aTitle );
+      aRecord.ForEachColumn( [&]( const char* aColumnName, auto& aColumn ) {
+        if ( fDisabledColumns.count( aColumnName ) == 0 ) createColumn( aColumnName, aColumn );
+      } );
+      analysisManager->FinishNtuple( ntupleId );
+      fNtupleIds.push_back( ntupleId++ );
+    } );
+  }
+
+  CreateSummaryNtuple();
+
+  fBookingTime = std::chrono::duration< G4double >( Clock::now() - start ).count();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  /// Creates a scalar column of the current ntuple.
+  G4int CreateFlatColumn( G4AnalysisManager* aManager, const G4String& aName, G4int ) {
+    return aManager->CreateNtupleIColumn( aName );
+  }
+  G4int CreateFlatColumn( G4AnalysisManager* aManager, const G4String& aName, G4float ) {
+    return aManager->CreateNtupleFColumn( aName );
+  }
+  G4int CreateFlatColumn( G4AnalysisManager* aManager, const G4String& aName, G4double ) {
+    return aManager->CreateNtupleDColumn( aName );
+  }
+
+  /// Fills a scalar column of an ntuple.
+  void FillFlatColumn( G4AnalysisManager* aManager, G4int aNtuple, G4int aColumn, G4int aValue ) {
+    aManager->FillNtupleIColumn( aNtuple, aColumn, aValue );
+  }
+  void FillFlatColumn( G4AnalysisManager* aManager, G4int aNtuple, G4int aColumn, G4float aValue ) {
+    aManager->FillNtupleFColumn( aNtuple, aColumn, aValue );
+  }
+  void FillFlatColumn( G4AnalysisManager* aManager, G4int aNtuple, G4int aColumn, G4double aValue ) {
+    aManager->FillNtupleDColumn( aNtuple, aColumn, aValue );
+  }
+}
+
+void NNBAROutput::CreateFlatNtuples() {
+  G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+  G4int ntupleId = 0;
+  fFlatTables.clear();
+  fBoundEvent.ForEachTable( [&]( const char* aName, std::size_t aRecord, const auto& aRecordData,
+                                 std::size_t aFirst, std::size_t aColumns ) {
+    FlatTable table = { -1, {}, -1, -1, 0 };
+    if ( fHistogramsOnly  ||  fDisabledNtuples.count( fRecordNames[aRecord] ) > 0 ) {
+      fFlatTables.push_back( table );
+      return;
+    }
+    analysisManager->CreateNtuple( aName, aName );
+    analysisManager->CreateNtupleIColumn( "eventID" );
+    std::size_t index = 0;
+    aRecordData.ForEachColumn( [&]( const char* aColumnName, const auto& aColumn ) {
+      std::size_t column = index++;
+      if ( column < aFirst  ||  column >= aFirst + aColumns ) return;
+      table.fColumnIds.push_back( fDisabledColumns.count( aColumnName ) > 0 ? -1 : 
+        CreateFlatColumn( analysisManager, aColumnName, typename std::decay< decltype( aColumn ) >::type::value_type() ) );
+    } );
+    analysisManager->FinishNtuple( ntupleId );
+    table.fNtupleId = ntupleId++;
+    fFlatTables.push_back( table );
+  } );
+
+  // The index of the events: the first row and the number of rows of each table
+  analysisManager->CreateNtuple( "Events", "Events" );
+  analysisManager->CreateNtupleIColumn( "eventID" );
+  std::size_t table = 0;
+  fBoundEvent.ForEachTable( [&]( const char* aName, std::size_t, const auto&, std::size_t, std::size_t ) {
+    FlatTable& flat = fFlatTables[table++];
+    if ( flat.fNtupleId < 0 ) return;
+    flat.fOffsetColumn = analysisManager->CreateNtupleIColumn( G4String( aName ) + "_offset" );
+    flat.fCountColumn = analysisManager->CreateNtupleIColumn( G4String( aName ) + "_count" );
+  } );
+  analysisManager->FinishNtuple( ntupleId );
+  fEventsNtupleId = ntupleId;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutput::WriteFlatRows( G4AnalysisManager* aManager ) {
+  G4int eventID = fBoundEvent.fEventID;
+  aManager->FillNtupleIColumn( fEventsNtupleId, 0, eventID );
+  std::size_t table = 0;
+  fBoundEvent.ForEachTable( [&]( const char*, std::size_t aRecord, const auto& aRecordData,
+                                 std::size_t aFirst, std::size_t aColumns ) {
+    FlatTable& flat = fFlatTables[table++];
+    if ( flat.fNtupleId < 0 ) return;
+    std::size_t rows = 0;
+    if ( fWrittenNtuples[aRecord] ) {
+      std::size_t index = 0;
+      aRecordData.ForEachColumn( [&]( const char*, const auto& aColumn ) {
+        if ( index++ == aFirst ) rows = aColumn.size();
+      } );
+    }
+    for ( std::size_t row = 0; row < rows; row++ ) {
+      aManager->FillNtupleIColumn( flat.fNtupleId, 0, eventID );
+      std::size_t index = 0;
+      aRecordData.ForEachColumn( [&]( const char*, const auto& aColumn ) {
+        std::size_t column = index++;
+        if ( column < aFirst  ||  column >= aFirst + aColumns ) return;
+        G4int id = flat.fColumnIds[column - aFirst];
+        if ( id >= 0 ) FillFlatColumn( aManager, flat.fNtupleId, id, row < aColumn.size() ? aColumn[row] : 0 );
+      } );
+      aManager->AddNtupleRow( flat.fNtupleId );
+    }
+    aManager->FillNtupleIColumn( fEventsNtupleId, flat.fOffsetColumn, flat.fRows );
+    aManager->FillNtupleIColumn( fEventsNtupleId, flat.fCountColumn, G4int( rows ) );
+    flat.fRows += rows;
+  } );
+  aManager->AddNtupleRow( fEventsNtupleId );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutput::CreateSummaryNtuple() {
+  fSummaryNtupleId = -1;
+  fSummaryColumnIds.clear();
+  if ( fHistogramsOnly  ||  fDisabledNtuples.count( "Summary" ) > 0 ) return;
   G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
-  analysisManager->SetNtupleMerging(true);
-
-  analysisManager->CreateNtuple("MC","MC Truth");
-  analysisManager->CreateNtupleIColumn("particleID", fParticleIDVec);  
-  analysisManager->CreateNtupleIColumn("PID", fPIDVec);
-  analysisManager->CreateNtupleDColumn("MC_KE",fMC_KEnergy);
-  analysisManager->CreateNtupleDColumn("MC_X", fMC_XVec);
-  analysisManager->CreateNtupleDColumn("MC_Y", fMC_YVec);
-  analysisManager->CreateNtupleDColumn("MC_Z", fMC_ZVec);
-  analysisManager->FinishNtuple(0);
-
-  //Uncomment for tracker. Be careful with the ntuple number in FinishNtuple()
-  //analysisManager->CreateNtuple("Tracker","Tracker");
-  //analysisManager->CreateNtupleDColumn("tracker_res", fTrackerResVec);
-  //analysisManager->CreateNtupleDColumn("tracker_eff", fTrackerEffVec);
-  //analysisManager->CreateNtupleDColumn("tracker_pX", fTracker_pXVec);
-  //analysisManager->CreateNtupleDColumn("tracker_pY", fTracker_pYVec);
-  //analysisManager->CreateNtupleDColumn("tracker_pZ", fTracker_pZVec);
-  //analysisManager->FinishNtuple(1);
-  
-  analysisManager->CreateNtuple("EMCAL","EMCAL");
-  analysisManager->CreateNtupleIColumn( "emcal_PDG" ,fEmcalPDGVec); 
-  analysisManager->CreateNtupleDColumn( "emcal_ETruth",fEmcalETruthVec);   
-  analysisManager->CreateNtupleDColumn( "emcal_res",fEmcalResVec );
-  analysisManager->CreateNtupleDColumn( "emcal_eff",fEmcalEffVec );
-  analysisManager->CreateNtupleDColumn( "emcal_X", fEmcalXVec );  
-  analysisManager->CreateNtupleDColumn( "emcal_Y" ,fEmcalYVec); 
-  analysisManager->CreateNtupleDColumn( "emcal_Z",fEmcalZVec ); 
-  analysisManager->CreateNtupleDColumn( "emcal_E", fEmcalEVec ); 
-  analysisManager->CreateNtupleDColumn( "emcal_Time" ,fEmcalTimeVec); 
-  analysisManager->FinishNtuple(1);
-  
-  //Uncomment for HCAL. Be careful with the ntuple number in FinishNtuple()
-  analysisManager->CreateNtuple("HCAL","HCAL");
-  analysisManager->CreateNtupleIColumn( "hcal_PDG",fHcalPDGVec);  
-  analysisManager->CreateNtupleDColumn( "hcal_ETruth",fHcalETruthVec);
-  analysisManager->CreateNtupleDColumn( "hcal_res",fHcalResVec); 
-  analysisManager->CreateNtupleDColumn( "hcal_eff",fHcalEffVec); 
-  analysisManager->CreateNtupleDColumn( "hcal_X",fHcalXVec);  
-  analysisManager->CreateNtupleDColumn( "hcal_Y",fHcalYVec); 
-  analysisManager->CreateNtupleDColumn( "hcal_Z",fHcalZVec); 
-  analysisManager->CreateNtupleDColumn( "hcal_E",fHcalEVec); 
-  analysisManager->CreateNtupleDColumn( "hcal_Time",fHcalTimeVec);
-  analysisManager->FinishNtuple(2);
-
- }
+  fSummaryNtupleId = analysisManager->CreateNtuple( "Summary", "Event summary" );
+  analysisManager->CreateNtupleIColumn( "eventID" );
+  fBoundEvent.fSummary.ForEachColumn( [&]( const char* aColumnName, auto aValue ) {
+    fSummaryColumnIds.push_back( fDisabledColumns.count( aColumnName ) > 0 ? -1 :
+                                 CreateFlatColumn( analysisManager, aColumnName, aValue ) );
+  } );
+  analysisManager->FinishNtuple( fSummaryNtupleId );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutput::WriteSummaryRow( G4AnalysisManager* aManager ) {
+  aManager->FillNtupleIColumn( fSummaryNtupleId, 0, fBoundEvent.fEventID );
+  std::size_t column = 0;
+  fBoundEvent.fSummary.ForEachColumn( [&]( const char*, auto aValue ) {
+    G4int id = fSummaryColumnIds[column++];
+    if ( id >= 0 ) FillFlatColumn( aManager, fSummaryNtupleId, id, aValue );
+  } );
+  aManager->AddNtupleRow( fSummaryNtupleId );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  /// The summary of a calorimeter record, in a single pass over the deposits.
+  template< typename R >
+  void SummariseCalorimeter( const R& aRecord, G4int& aN, G4double& aE, G4double& aX, G4double& aY,
+                             G4double& aZ, G4double& aTime ) {
+    G4double energy = 0, x = 0, y = 0, z = 0;
+    G4double time = std::numeric_limits< G4double >::max();
+    std::size_t deposits = 0;
+    for ( std::size_t i = 0; i < aRecord.fE.size(); i++ ) {
+      // The rows of the particles missed by the efficiency have no energy
+      G4double e = aRecord.fE[i];
+      if ( e <= 0 ) continue;
+      deposits++;
+      energy += e;
+      x += e * aRecord.fX[i];
+      y += e * aRecord.fY[i];
+      z += e * aRecord.fZ[i];
+      if ( aRecord.fTime[i] < time ) time = aRecord.fTime[i];
+    }
+    aN = G4int( deposits );
+    aE = energy;
+    aX = energy > 0 ? x / energy : 0;
+    aY = energy > 0 ? y / energy : 0;
+    aZ = energy > 0 ? z / energy : 0;
+    aTime = deposits > 0 ? time : 0;
+  }
+}
+
+void NNBAROutput::Summarise() {
+  NNBAREventSummary& summary = fEvent->fSummary;
+  SummariseCalorimeter( fEvent->fEMCal, summary.fEMCalN, summary.fEMCalE, summary.fEMCalX, 
+                        summary.fEMCalY, summary.fEMCalZ, summary.fEMCalTime );
+  SummariseCalorimeter( fEvent->fHCal, summary.fHCalN, summary.fHCalE, summary.fHCalX, 
+                        summary.fHCalY, summary.fHCalZ, summary.fHCalTime );
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void NNBAROutput::CreateHistograms()
 {
+  if ( fHistogramsCreated ) return;
+  fHistogramsCreated = true;
+
   G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
   analysisManager->CreateH1( "Pdiff", "momentum smeared in tracker", 100, 0.8, 1.2 );
   analysisManager->SetH1XAxisTitle( 0, "p_{smeared}/p_{true}" );
@@ -172,104 +865,195 @@ void NNBAROutput::CreateHistograms()
 
 void NNBAROutput::SaveTrack( SaveType aWhatToSave, G4int aPartID,  G4int aPDG, G4double aETruth,
                              G4ThreeVector aVector, G4double aResolution, 
-                             G4double aEfficiency, G4double aEnergy,  G4double aTime ) {
+                             G4double aEfficiency, G4double aEnergy,  G4double aTime,
+                             G4int aPhotoelectrons, G4double aVisibleEnergy,
+                             G4int aFace, G4double aCosTheta,
+                             G4int aParentID, G4int aPrimary ) {
  
-   switch (aWhatToSave) {
-   case NNBAROutput::eNoSave:
-   break;
-     
-     case NNBAROutput::eSaveMC: {
-      fParticleIDVec.push_back(aPartID);
-      fPIDVec.push_back(aPDG);
-      fMC_KEnergy.push_back(aETruth);
-      fMC_XVec.push_back(aVector.x());
-      fMC_YVec.push_back(aVector.y());
-      fMC_ZVec.push_back(aVector.z());
+  switch ( aWhatToSave ) {
+    case NNBAROutput::eNoSave:
+      break;
+
+    case NNBAROutput::eSaveMC: {
+      // The row is the particle ID, the index of the primary of the deposits
+      if ( aPartID < 0 ) break;
+      std::size_t row = aPartID;
+      if ( row >= fEvent->fMC.fParticleID.size() ) {
+        std::size_t rows = fEvent->fMC.fParticleID.size();
+        fEvent->fMC.Resize( row + 1 );
+        // The rows of the particles not (yet) saved
+        std::fill( fEvent->fMC.fParticleID.begin() + rows, fEvent->fMC.fParticleID.end(), -1 );
+      }
+      fEvent->fMC.fParticleID[row] = aPartID;
+      fEvent->fMC.fPID[row] = aPDG;
+      fEvent->fMC.fKE[row] = aETruth;
+      fEvent->fMC.fX[row] = aVector.x();
+      fEvent->fMC.fY[row] = aVector.y();
+      fEvent->fMC.fZ[row] = aVector.z();
       break;
     }
 
-    //case NNBAROutput::eSaveTracker: {
-    //  std::cout <<"here 2" << std::endl;
-    //  fTrackerResVec.push_back(aResolution);
-    //  fTrackerEffVec.push_back(aEfficiency);
-     // fTracker_pXVec.push_back(aVector.x());
-     // fTracker_pYVec.push_back(aVector.y());
-     // fTracker_pZVec.push_back(aVector.z());
-     // break;
-  //  }
-    
-    case NNBAROutput::eSaveEMCal : {
-     fEmcalPDGVec.push_back(aPDG);
-     fEmcalETruthVec.push_back(aETruth);
-     fEmcalResVec.push_back(aResolution);
-     fEmcalEffVec.push_back(aEfficiency);
-     fEmcalXVec.push_back(aVector.x() );
-     fEmcalYVec.push_back( aVector.y() );
-     fEmcalZVec.push_back( aVector.z() );
-     fEmcalEVec.push_back(aEnergy);
-     fEmcalTimeVec.push_back(aTime);
-     break;
-   }    
-    
-    case NNBAROutput::eSaveHCal : {
-    fHcalPDGVec.push_back(aPDG);
-    fHcalETruthVec.push_back(aETruth);
-    fHcalResVec.push_back(aResolution);
-    fHcalEffVec.push_back(aEfficiency);
-    fHcalXVec.push_back(aVector.x() );
-    fHcalYVec.push_back( aVector.y() );
-    fHcalZVec.push_back( aVector.z() );
-    fHcalEVec.push_back(aEnergy);
-    fHcalTimeVec.push_back(aTime);
-    break;
-   }
- }
-}
-//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
-
-void NNBAROutput::SaveEvent() {
-  G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+    case NNBAROutput::eSaveTracker: {
+      fEvent->fTracker.fRes.push_back( aResolution );
+      fEvent->fTracker.fEff.push_back( aEfficiency );
+      fEvent->fTracker.fPX.push_back( aVector.x() );
+      fEvent->fTracker.fPY.push_back( aVector.y() );
+      fEvent->fTracker.fPZ.push_back( aVector.z() );
+      break;
+    }
 
-  analysisManager->AddNtupleRow(0);
-  analysisManager->AddNtupleRow(1);
-  analysisManager->AddNtupleRow(2);
-  //analysisManager->AddNtupleRow(3);
+    case NNBAROutput::eSaveEMCal: {
+      fEvent->fEMCal.fPDG.push_back( aPDG );
+      fEvent->fEMCal.fTrackID.push_back( aPartID );
+      fEvent->fEMCal.fParentID.push_back( aParentID );
+      fEvent->fEMCal.fPrimary.push_back( aPrimary );
+      fEvent->fEMCal.fETruth.push_back( aETruth );
+      fEvent->fEMCal.fRes.push_back( aResolution );
+      fEvent->fEMCal.fEff.push_back( aEfficiency );
+      fEvent->fEMCal.fX.push_back( aVector.x() );
+      fEvent->fEMCal.fY.push_back( aVector.y() );
+      fEvent->fEMCal.fZ.push_back( aVector.z() );
+      fEvent->fEMCal.fE.push_back( aEnergy );
+      fEvent->fEMCal.fTime.push_back( aTime );
+      fEvent->fEMCal.fNpe.push_back( aPhotoelectrons );
+      fEvent->fEMCal.fFace.push_back( aFace );
+      fEvent->fEMCal.fCosTheta.push_back( aCosTheta );
+      break;
+    }
 
-  //Clear vectors for next event
- 
-  fParticleIDVec.clear();
-  fPIDVec.clear();
-  fMC_KEnergy.clear();
-  fMC_XVec.clear();
-  fMC_YVec.clear();
-  fMC_ZVec.clear();
- // fTrackerResVec.clear();
- // fTrackerEffVec.clear();
- // fTracker_pXVec.clear();
- // fTracker_pYVec.clear();
- // fTracker_pZVec.clear();
-  fEmcalPDGVec.clear();
-  fEmcalETruthVec.clear();
-  fEmcalResVec.clear();
-  fEmcalEffVec.clear();
-  fEmcalXVec.clear();
-  fEmcalYVec.clear();
-  fEmcalZVec.clear();
-  fEmcalEVec.clear();
-  fEmcalTimeVec.clear();
-  fHcalPDGVec.clear();
-  fHcalETruthVec.clear();
-  fHcalResVec.clear();
-  fHcalEffVec.clear();
-  fHcalXVec.clear();
-  fHcalYVec.clear();
-  fHcalZVec.clear();
-  fHcalEVec.clear();
-  fHcalTimeVec.clear();  
+    case NNBAROutput::eSaveEMCalSpot: {
+      // A spot of a library shower, linked to the last EMCal deposit
+      fEvent->fEMCal.fSpotIndex.push_back( G4int( fEvent->fEMCal.fE.size() ) - 1 );
+      fEvent->fEMCal.fSpotX.push_back( aVector.x() );
+      fEvent->fEMCal.fSpotY.push_back( aVector.y() );
+      fEvent->fEMCal.fSpotZ.push_back( aVector.z() );
+      fEvent->fEMCal.fSpotE.push_back( aEnergy );
+      break;
+    }
+
+    case NNBAROutput::eSaveHCal: {
+      fEvent->fHCal.fPDG.push_back( aPDG );
+      fEvent->fHCal.fTrackID.push_back( aPartID );
+      fEvent->fHCal.fParentID.push_back( aParentID );
+      fEvent->fHCal.fPrimary.push_back( aPrimary );
+      fEvent->fHCal.fETruth.push_back( aETruth );
+      fEvent->fHCal.fRes.push_back( aResolution );
+      fEvent->fHCal.fEff.push_back( aEfficiency );
+      fEvent->fHCal.fX.push_back( aVector.x() );
+      fEvent->fHCal.fY.push_back( aVector.y() );
+      fEvent->fHCal.fZ.push_back( aVector.z() );
+      fEvent->fHCal.fE.push_back( aEnergy );
+      fEvent->fHCal.fTime.push_back( aTime );
+      fEvent->fHCal.fNpe.push_back( aPhotoelectrons );
+      fEvent->fHCal.fEvis.push_back( aVisibleEnergy );
+      fEvent->fHCal.fFace.push_back( aFace );
+      fEvent->fHCal.fCosTheta.push_back( aCosTheta );
+      break;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int NNBAROutput::GetNumberOfDeposits( SaveType aWhatToSave ) const {
+  switch ( aWhatToSave ) {
+    case NNBAROutput::eSaveEMCal : return G4int( fEvent->fEMCal.fE.size() );
+    case NNBAROutput::eSaveHCal  : return G4int( fEvent->fHCal.fE.size() );
+    default : return 0;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutput::SetCalorimeterResponse( SaveType aWhatToSave, G4int aRow, 
+                                          G4double aResolution, G4double aEfficiency,
+                                          G4double aEnergy ) {
+  if ( aRow < 0  ||  aRow >= GetNumberOfDeposits( aWhatToSave ) ) return;
+  if ( aWhatToSave == NNBAROutput::eSaveEMCal ) {
+    fEvent->fEMCal.fRes[aRow] = aResolution;
+    fEvent->fEMCal.fEff[aRow] = aEfficiency;
+    fEvent->fEMCal.fE[aRow] = aEnergy;
+  } else if ( aWhatToSave == NNBAROutput::eSaveHCal ) {
+    fEvent->fHCal.fRes[aRow] = aResolution;
+    fEvent->fHCal.fEff[aRow] = aEfficiency;
+    fEvent->fHCal.fE[aRow] = aEnergy;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutput::SaveEvent( G4int aEventID ) {
+  Clock::time_point start = Clock::now();
+  fEvent->fEventID = aEventID;
+
+  // No rows are written in the histogram-only mode
+  if ( fHistogramsOnly ) {
+    SkipEvent();
+    return;
+  }
+
+  if ( fWriteSummary ) Summarise();
+
+  // A rejected event is cleared without being written
+  if ( fSkim.IsActive()  &&  ! fSkim.Accept( *fEvent ) ) {
+    SkipEvent();
+    fRejectedEvents++;
+    fSaveTime += std::chrono::duration< G4double >( Clock::now() - start ).count();
+    return;
+  }
+
+  // The output rolls over to the next shard once the current one is full
+  if ( fSharded ) {
+    if ( IsShardFull() ) {
+      // The queued events belong to the current shard
+      if ( fWriter ) fWriter->Stop();
+      CloseShard();
+      fShard++;
+      OpenShard();
+      if ( ! fColumnarFileName.empty() ) fColumnarFileName = GetThreadFileName( ".nnbc" );
+    }
+    if ( fShardWrittenEvents == 0 ) fShardFirstEvent = aEventID;
+    fShardLastEvent = aEventID;
+    fShardWrittenEvents++;
+  }
+
+  if ( fEvent == &fBoundEvent ) {
+    fWriteRows();
+
+    // Clear the records for the next event (the capacity is kept)
+    fBoundEvent.Reset();
+  } else {
+    // The writer thread writes the event, the next one is filled meanwhile
+    fWriter->Submit( fEvent );
+    fEvent = fWriter->Acquire();
+  }
+
+  fSaveTime += std::chrono::duration< G4double >( Clock::now() - start ).count();
+  fSavedEvents++;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+void NNBAROutput::SkipEvent() {
+  if ( fEvent == &fBoundEvent ) {
+    fEvent->Reset();
+    return;
+  }
+  // The writer thread fills the histograms of the event
+  fEvent->ResetRecords();
+  fEvent->fWritten = false;
+  fWriter->Submit( fEvent );
+  fEvent = fWriter->Acquire();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void NNBAROutput::FillHistogram( G4int aHistNo, G4double aValue ) const {
+  // The analysis manager is used by the writer thread during the run: the
+  // fill is replayed by it with the rows of the event
+  if ( fEvent != &fBoundEvent ) {
+    fEvent->fHistogramFills.emplace_back( aHistNo, aValue );
+    return;
+  }
   G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
   analysisManager->FillH1( aHistNo, aValue );
 }
@@ -0,0 +1,267 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBAROutputMessenger.cc
+/// \brief Implementation of the NNBAROutputMessenger class
+
+#include "NNBAROutputMessenger.hh"
+#include "NNBAROutput.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIparameter.hh"
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBAROutputMessenger::NNBAROutputMessenger( NNBAROutput* aOutput ) 
+  : G4UImessenger(), fOutput( aOutput ) {
+  fDirectory = new G4UIdirectory( "/NNBAR/output/" );
+  fDirectory->SetGuidance( "Output control." );
+
+  fAsyncWriterCmd = new G4UIcmdWithABool( "/NNBAR/output/asyncWriter", this );
+  fAsyncWriterCmd->SetGuidance( "Write the ntuple rows and fill the histograms in an output writer" );
+  fAsyncWriterCmd->SetGuidance( "thread (default), or in the simulation thread at the end of each event." );
+  fAsyncWriterCmd->SetGuidance( "Applied from the next run." );
+  fAsyncWriterCmd->SetParameterName( "async", true );
+  fAsyncWriterCmd->SetDefaultValue( true );
+  fAsyncWriterCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fWriterMemoryLimitCmd = new G4UIcmdWithADouble( "/NNBAR/output/writerMemoryLimit", this );
+  fWriterMemoryLimitCmd->SetGuidance( "Memory limit (in MB) of the events queued for the writer" );
+  fWriterMemoryLimitCmd->SetGuidance( "thread. Above it, the simulation waits (default 256 MB)." );
+  fWriterMemoryLimitCmd->SetParameterName( "limit", false );
+  fWriterMemoryLimitCmd->SetRange( "limit > 0" );
+  fWriterMemoryLimitCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fFormatCmd = new G4UIcmdWithAString( "/NNBAR/output/format", this );
+  fFormatCmd->SetGuidance( "Format of the ntuples: the Root file (default), the columnar file" );
+  fFormatCmd->SetGuidance( "(<output name>.nnbc, see nnbar_columnar.C) or both. The histograms" );
+  fFormatCmd->SetGuidance( "are always written to the Root file. Applied from the next run." );
+  fFormatCmd->SetParameterName( "format", false );
+  fFormatCmd->SetCandidates( "root columnar both" );
+  fFormatCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fCompressionCmd = new G4UIcommand( "/NNBAR/output/compression", this );
+  fCompressionCmd->SetGuidance( "Compression of the Root file: codec and level (default zlib 1)." );
+  fCompressionCmd->SetGuidance( "The Geant4 Root writer supports zlib only, lz4 and zstd fall back" );
+  fCompressionCmd->SetGuidance( "to zlib. Applied from the next run." );
+  G4UIparameter* codec = new G4UIparameter( "codec", 's', false );
+  codec->SetParameterCandidates( "none zlib lz4 zstd" );
+  fCompressionCmd->SetParameter( codec );
+  G4UIparameter* level = new G4UIparameter( "level", 'i', true );
+  level->SetDefaultValue( 1 );
+  level->SetParameterRange( "level >= 0 && level <= 9" );
+  fCompressionCmd->SetParameter( level );
+  fCompressionCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fBasketSizeCmd = new G4UIcmdWithAnInteger( "/NNBAR/output/basketSize", this );
+  fBasketSizeCmd->SetGuidance( "Basket size of the Root ntuples in bytes (0: Geant4 default)." );
+  fBasketSizeCmd->SetGuidance( "The same for all the ntuples. Applied from the next run." );
+  fBasketSizeCmd->SetParameterName( "size", false );
+  fBasketSizeCmd->SetRange( "size >= 0" );
+  fBasketSizeCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fBasketEntriesCmd = new G4UIcmdWithAnInteger( "/NNBAR/output/basketEntries", this );
+  fBasketEntriesCmd->SetGuidance( "Entries of the Root ntuple baskets, after which they are" );
+  fBasketEntriesCmd->SetGuidance( "compressed and written (0: Geant4 default). The same for all" );
+  fBasketEntriesCmd->SetGuidance( "the ntuples. Applied from the next run." );
+  fBasketEntriesCmd->SetParameterName( "entries", false );
+  fBasketEntriesCmd->SetRange( "entries >= 0" );
+  fBasketEntriesCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fFixedPointCmd = new G4UIcommand( "/NNBAR/output/fixedPoint", this );
+  fFixedPointCmd->SetGuidance( "Stores a floating point column of the columnar file in fixed point:" );
+  fFixedPointCmd->SetGuidance( "value = min + scale * n, n in 16 bits if the range fits, 32 bits" );
+  fFixedPointCmd->SetGuidance( "otherwise. The values are in the units of the output (mm, ns, MeV)," );
+  fFixedPointCmd->SetGuidance( "out of the range they are clamped. A scale of 0 stores the column as is." );
+  fFixedPointCmd->SetGuidance( "E.g. /NNBAR/output/fixedPoint emcal_X -3000 3000 0.1" );
+  fFixedPointCmd->SetGuidance( "Applied from the next run, the Root file is not affected." );
+  G4UIparameter* column = new G4UIparameter( "column", 's', false );
+  fFixedPointCmd->SetParameter( column );
+  G4UIparameter* minimum = new G4UIparameter( "min", 'd', false );
+  fFixedPointCmd->SetParameter( minimum );
+  G4UIparameter* maximum = new G4UIparameter( "max", 'd', false );
+  fFixedPointCmd->SetParameter( maximum );
+  G4UIparameter* scale = new G4UIparameter( "scale", 'd', false );
+  scale->SetParameterRange( "scale >= 0" );
+  fFixedPointCmd->SetParameter( scale );
+  fFixedPointCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fSkimCmd = new G4UIcmdWithAString( "/NNBAR/output/skim", this );
+  fSkimCmd->SetGuidance( "Writes only the events selected by an expression, e.g." );
+  fSkimCmd->SetGuidance( "  /NNBAR/output/skim nEMCal >= 2 && sum(emcal_E) > 150" );
+  fSkimCmd->SetGuidance( "Counts of rows: nMC, nTracker, nEMCal, nHCal (the calorimeters count" );
+  fSkimCmd->SetGuidance( "the deposits with E > 0, nMC the rows with particleID >= 0). Functions of a column:" );
+  fSkimCmd->SetGuidance( "sum, min, max, count. Operators: + - * / < <= > >= == != && || !" );
+  fSkimCmd->SetGuidance( "and parentheses. Values in mm, ns, MeV. No expression writes all" );
+  fSkimCmd->SetGuidance( "the events. Compiled at the beginning of the next run." );
+  fSkimCmd->SetParameterName( "expression", true );
+  fSkimCmd->SetDefaultValue( "" );
+  fSkimCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fNtupleCmd = new G4UIcommand( "/NNBAR/output/ntuple", this );
+  fNtupleCmd->SetGuidance( "Enables or disables an ntuple (all enabled by default). The Root" );
+  fNtupleCmd->SetGuidance( "ntuples are booked at the first run, with the IDs following the" );
+  fNtupleCmd->SetGuidance( "enabled ones. Applied from the next run." );
+  G4UIparameter* ntuple = new G4UIparameter( "ntuple", 's', false );
+  ntuple->SetParameterCandidates( "MC Tracker EMCAL HCAL Summary" );
+  fNtupleCmd->SetParameter( ntuple );
+  G4UIparameter* ntupleEnabled = new G4UIparameter( "enabled", 'b', true );
+  ntupleEnabled->SetDefaultValue( true );
+  fNtupleCmd->SetParameter( ntupleEnabled );
+  fNtupleCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fColumnCmd = new G4UIcommand( "/NNBAR/output/column", this );
+  fColumnCmd->SetGuidance( "Enables or disables a column (all enabled by default), e.g." );
+  fColumnCmd->SetGuidance( "  /NNBAR/output/column emcal_spot_X false" );
+  fColumnCmd->SetGuidance( "The Root ntuples get the columns enabled at the first run, the" );
+  fColumnCmd->SetGuidance( "columnar file at each run." );
+  G4UIparameter* columnName = new G4UIparameter( "column", 's', false );
+  fColumnCmd->SetParameter( columnName );
+  G4UIparameter* columnEnabled = new G4UIparameter( "enabled", 'b', true );
+  columnEnabled->SetDefaultValue( true );
+  fColumnCmd->SetParameter( columnEnabled );
+  fColumnCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fHistogramsOnlyCmd = new G4UIcmdWithABool( "/NNBAR/output/histogramsOnly", this );
+  fHistogramsOnlyCmd->SetGuidance( "Saves the histograms only: no ntuple is booked or written." );
+  fHistogramsOnlyCmd->SetGuidance( "Applied from the next run." );
+  fHistogramsOnlyCmd->SetParameterName( "histogramsOnly", true );
+  fHistogramsOnlyCmd->SetDefaultValue( true );
+  fHistogramsOnlyCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fLayoutCmd = new G4UIcmdWithAString( "/NNBAR/output/layout", this );
+  fLayoutCmd->SetGuidance( "Layout of the Root ntuples: a row per event with vector columns" );
+  fLayoutCmd->SetGuidance( "(default), or flat: a row per deposit with the event ID, and the" );
+  fLayoutCmd->SetGuidance( "Events ntuple with the first row and the number of rows of each" );
+  fLayoutCmd->SetGuidance( "ntuple per event (one file per thread, the ntuples are not merged)." );
+  fLayoutCmd->SetGuidance( "Fixed at the first run, when the ntuples are booked." );
+  fLayoutCmd->SetParameterName( "layout", false );
+  fLayoutCmd->SetCandidates( "vector flat" );
+  fLayoutCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fShardEventsCmd = new G4UIcmdWithAnInteger( "/NNBAR/output/shardEvents", this );
+  fShardEventsCmd->SetGuidance( "Rolls the output over to the next shard (<output name>_shard<n>)" );
+  fShardEventsCmd->SetGuidance( "after this number of written events per thread (0: no limit)." );
+  fShardEventsCmd->SetGuidance( "The shards are closed as they fill up and are listed in" );
+  fShardEventsCmd->SetGuidance( "<output name>_manifest.txt. With shards, the ntuples of the" );
+  fShardEventsCmd->SetGuidance( "threads are not merged (decided at the first run). Applied from" );
+  fShardEventsCmd->SetGuidance( "the next run." );
+  fShardEventsCmd->SetParameterName( "events", false );
+  fShardEventsCmd->SetRange( "events >= 0" );
+  fShardEventsCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fShardSizeCmd = new G4UIcmdWithADouble( "/NNBAR/output/shardSize", this );
+  fShardSizeCmd->SetGuidance( "Rolls the output over to the next shard once the files of the" );
+  fShardSizeCmd->SetGuidance( "shard of a thread reach this size in MB (0: no limit). The columnar" );
+  fShardSizeCmd->SetGuidance( "file counts its bytes (the chunk in memory unencoded), the Root file" );
+  fShardSizeCmd->SetGuidance( "is checked on disk every 100 events, without the baskets not yet" );
+  fShardSizeCmd->SetGuidance( "written. See /NNBAR/output/shardEvents. Applied from the next run." );
+  fShardSizeCmd->SetParameterName( "size", false );
+  fShardSizeCmd->SetRange( "size >= 0" );
+  fShardSizeCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBAROutputMessenger::~NNBAROutputMessenger() {
+  delete fShardSizeCmd;
+  delete fShardEventsCmd;
+  delete fLayoutCmd;
+  delete fHistogramsOnlyCmd;
+  delete fColumnCmd;
+  delete fNtupleCmd;
+  delete fSkimCmd;
+  delete fFixedPointCmd;
+  delete fBasketEntriesCmd;
+  delete fBasketSizeCmd;
+  delete fCompressionCmd;
+  delete fFormatCmd;
+  delete fWriterMemoryLimitCmd;
+  delete fAsyncWriterCmd;
+  delete fDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutputMessenger::SetNewValue( G4UIcommand* aCommand, G4String aNewValue ) {
+  if ( aCommand == fAsyncWriterCmd ) {
+    fOutput->SetAsyncWriter( fAsyncWriterCmd->GetNewBoolValue( aNewValue ) );
+  } else if ( aCommand == fWriterMemoryLimitCmd ) {
+    fOutput->SetWriterMemoryLimit( 
+      std::size_t( fWriterMemoryLimitCmd->GetNewDoubleValue( aNewValue ) * 1024 * 1024 ) );
+  } else if ( aCommand == fFormatCmd ) {
+    if ( aNewValue == "columnar" ) {
+      fOutput->SetFormat( NNBAROutput::eColumnarFormat );
+    } else if ( aNewValue == "both" ) {
+      fOutput->SetFormat( NNBAROutput::eBothFormats );
+    } else {
+      fOutput->SetFormat( NNBAROutput::eRootFormat );
+    }
+  } else if ( aCommand == fCompressionCmd ) {
+    G4String codec;
+    G4int level = 1;
+    std::istringstream is( aNewValue );
+    is >> codec >> level;
+    fOutput->SetCompression( codec, level );
+  } else if ( aCommand == fBasketSizeCmd ) {
+    fOutput->SetBasketSize( fBasketSizeCmd->GetNewIntValue( aNewValue ) );
+  } else if ( aCommand == fBasketEntriesCmd ) {
+    fOutput->SetBasketEntries( fBasketEntriesCmd->GetNewIntValue( aNewValue ) );
+  } else if ( aCommand == fFixedPointCmd ) {
+    G4String column;
+    G4double minimum = 0, maximum = 0, scale = 0;
+    std::istringstream is( aNewValue );
+    is >> column >> minimum >> maximum >> scale;
+    fOutput->SetFixedPoint( column, minimum, maximum, scale );
+  } else if ( aCommand == fSkimCmd ) {
+    fOutput->SetSkim( aNewValue );
+  } else if ( aCommand == fNtupleCmd  ||  aCommand == fColumnCmd ) {
+    G4String name, enabled = "true";
+    std::istringstream is( aNewValue );
+    is >> name >> enabled;
+    if ( aCommand == fNtupleCmd ) {
+      fOutput->SetNtupleEnabled( name, G4UIcommand::ConvertToBool( enabled ) );
+    } else {
+      fOutput->SetColumnEnabled( name, G4UIcommand::ConvertToBool( enabled ) );
+    }
+  } else if ( aCommand == fHistogramsOnlyCmd ) {
+    fOutput->SetHistogramsOnly( fHistogramsOnlyCmd->GetNewBoolValue( aNewValue ) );
+  } else if ( aCommand == fLayoutCmd ) {
+    fOutput->SetLayout( aNewValue == "flat" ? NNBAROutput::eFlatLayout : NNBAROutput::eVectorLayout );
+  } else if ( aCommand == fShardEventsCmd ) {
+    fOutput->SetShardEvents( fShardEventsCmd->GetNewIntValue( aNewValue ) );
+  } else if ( aCommand == fShardSizeCmd ) {
+    fOutput->SetShardSize( 
+      std::size_t( fShardSizeCmd->GetNewDoubleValue( aNewValue ) * 1024 * 1024 ) );
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,145 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBAROutputWriter.cc
+/// \brief Implementation of the NNBAROutputWriter class
+
+#include "NNBAROutputWriter.hh"
+
+#include "G4Threading.hh"
+#include <utility>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBAROutputWriter::NNBAROutputWriter( NNBAROutputEvent& aBoundEvent, 
+                                      std::function< void() > aWriteRow ) :
+  fBoundEvent( aBoundEvent ), fWriteRow( aWriteRow ), fEvents(), fQueue( fCapacity ), 
+  fFreeEvents( fCapacity ), fQueuedMemory( 0 ), fMemoryLimit( 256 * 1024 * 1024 ), 
+  fStop( false ), fThread(), fThreadId( -1 ), fWaitTime( 0 ), fPeakMemory( 0 ) {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBAROutputWriter::~NNBAROutputWriter() {
+  Stop();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBAROutputEvent* NNBAROutputWriter::Acquire() {
+  NNBAROutputEvent* event = nullptr;
+  if ( fFreeEvents.TryPop( event ) ) return event;
+  if ( fEvents.size() < fCapacity ) {
+    fEvents.emplace_back( new NNBAROutputEvent );
+    return fEvents.back().get();
+  }
+  // All the events are in flight
+  Clock::time_point start = Clock::now();
+  while ( ! fFreeEvents.TryPop( event ) ) {
+    std::unique_lock< std::mutex > lock( fMutex );
+    fWritten.wait( lock, [this]() { return ! fFreeEvents.IsEmpty(); } );
+  }
+  fWaitTime += std::chrono::duration< G4double >( Clock::now() - start ).count();
+  return event;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutputWriter::Submit( NNBAROutputEvent* aEvent ) {
+  if ( ! fThread.joinable() ) {
+    fStop.store( false, std::memory_order_release );
+    fThreadId = G4Threading::G4GetThreadId();
+    fThread = std::thread( &NNBAROutputWriter::Run, this );
+  }
+  std::size_t memory = aEvent->GetMemorySize();
+  // An event larger than the limit passes when the queue is empty
+  auto fits = [this, memory]() {
+    std::size_t queued = fQueuedMemory.load( std::memory_order_acquire );
+    return queued == 0  ||  queued + memory <= fMemoryLimit;
+  };
+  Clock::time_point start;
+  G4bool waited = ! fits();
+  if ( waited ) {
+    start = Clock::now();
+    std::unique_lock< std::mutex > lock( fMutex );
+    fWritten.wait( lock, fits );
+  }
+  // Only the writer frees memory meanwhile; the queue holds all the events
+  std::size_t queued = fQueuedMemory.fetch_add( memory, std::memory_order_acq_rel );
+  fQueue.TryPush( aEvent );
+  if ( queued + memory > fPeakMemory ) fPeakMemory = queued + memory;
+  Notify( fQueued );
+  if ( waited ) fWaitTime += std::chrono::duration< G4double >( Clock::now() - start ).count();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutputWriter::Stop() {
+  if ( ! fThread.joinable() ) return;
+  Clock::time_point start = Clock::now();
+  fStop.store( true, std::memory_order_release );
+  Notify( fQueued );
+  fThread.join();
+  fWaitTime += std::chrono::duration< G4double >( Clock::now() - start ).count();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutputWriter::Run() {
+  // The analysis manager of the simulation thread checks the thread ID
+  G4Threading::G4SetThreadId( fThreadId );
+  NNBAROutputEvent* event = nullptr;
+  while ( true ) {
+    if ( fQueue.TryPop( event ) ) {
+      std::size_t memory = event->GetMemorySize();
+      // The bound event takes the content (and the capacity) of the queued one,
+      // which gets the buffers of the previously written event back
+      std::swap( fBoundEvent, *event );
+      fWriteRow();
+      event->Reset();
+      fFreeEvents.TryPush( event );
+      fQueuedMemory.fetch_sub( memory, std::memory_order_acq_rel );
+      Notify( fWritten );
+    } else {
+      std::unique_lock< std::mutex > lock( fMutex );
+      // Events submitted before the stop are visible now
+      if ( fStop.load( std::memory_order_acquire )  &&  fQueue.IsEmpty() ) break;
+      fQueued.wait( lock, [this]() { 
+        return ! fQueue.IsEmpty()  ||  fStop.load( std::memory_order_acquire ); } );
+    }
+  }
+  fBoundEvent.Reset();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBAROutputWriter::Notify( std::condition_variable& aCondition ) {
+  // Taking the lock orders the notification after the check of a waiting
+  // thread, which then cannot miss it
+  { std::lock_guard< std::mutex > lock( fMutex ); }
+  aCondition.notify_all();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
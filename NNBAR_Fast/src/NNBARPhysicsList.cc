@@ -28,10 +28,17 @@
 /// \brief Implementation of the NNBARPhysicsList class
 
 #include "NNBARPhysicsList.hh"
+#include "NNBARPhysicsListMessenger.hh"
+#include "NNBARProcessTimer.hh"
+#include "NNBARFastSimModelTracker.hh"
+#include "NNBARFastSimModelEMCal.hh"
+#include "NNBARFastSimModelHCal.hh"
+#include "NNBARFastSimModelTarget.hh"
 #include "globals.hh"
 #include "G4ParticleDefinition.hh"
 #include "G4ProcessManager.hh"
 #include "G4ProcessVector.hh"
+#include "G4VProcess.hh"
 #include "G4ParticleTypes.hh"
 #include "G4ParticleTable.hh"
 #include "G4Material.hh"
@@ -39,7 +46,9 @@
 #include "G4ios.hh"
 #include "G4SystemOfUnits.hh"
 #include <iomanip>
+#include <sstream>
 #include "G4FastSimulationManagerProcess.hh"
+#include "G4Threading.hh"
 
 #include "G4Decay.hh"
 #include "G4LeptonConstructor.hh"
@@ -67,14 +76,19 @@
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-NNBARPhysicsList::NNBARPhysicsList() :  G4VUserPhysicsList() {
+NNBARPhysicsList::NNBARPhysicsList( G4bool aHybrid ) :  G4VUserPhysicsList(), 
+  fHybrid( aHybrid ), fFastSimRegistration( eGeneralRegistration ), 
+  fFastSimApplicableOnly( false ), fFastSimTiming( false ) {
   SetVerboseLevel( 1 );
   defaultCutValue = 0.1*m;
+  fMessenger = new NNBARPhysicsListMessenger( this );
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-NNBARPhysicsList::~NNBARPhysicsList() {}
+NNBARPhysicsList::~NNBARPhysicsList() {
+  delete fMessenger;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -132,6 +146,9 @@ void NNBARPhysicsList::ConstructProcess() {
   AddTransportation();
   AddParameterisation();
   ConstructGeneral();
+  if ( fHybrid ) {
+    ConstructEM();
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -161,22 +178,106 @@ void NNBARPhysicsList::ConstructGeneral() {
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void NNBARPhysicsList::ConstructEM() {
+  // The fast simulation process is registered first, so the models keep the
+  // priority in the regions that are not fully simulated.
+  auto particleIterator=GetParticleIterator();
+  particleIterator->reset();
+  while ( (*particleIterator)() ) {
+    G4ParticleDefinition* particle = particleIterator->value();
+    G4ProcessManager* pmanager = particle->GetProcessManager();
+    G4String particleName = particle->GetParticleName();
+    if ( particleName == "gamma" ) {
+      pmanager->AddDiscreteProcess( new G4ComptonScattering );
+      pmanager->AddDiscreteProcess( new G4GammaConversion );
+      pmanager->AddDiscreteProcess( new G4PhotoElectricEffect );
+    } else if ( particleName == "e-" ) {
+      pmanager->AddProcess( new G4eMultipleScattering, -1, 1, 1 );
+      pmanager->AddProcess( new G4eIonisation,         -1, 2, 2 );
+      pmanager->AddProcess( new G4eBremsstrahlung,     -1,-1, 3 );
+    } else if ( particleName == "e+" ) {
+      pmanager->AddProcess( new G4eMultipleScattering, -1, 1, 1 );
+      pmanager->AddProcess( new G4eIonisation,         -1, 2, 2 );
+      pmanager->AddProcess( new G4eBremsstrahlung,     -1,-1, 3 );
+      pmanager->AddProcess( new G4eplusAnnihilation,    0,-1, 4 );
+    } else if ( particleName == "mu+" || particleName == "mu-" ) {
+      pmanager->AddProcess( new G4MuMultipleScattering, -1, 1, 1 );
+      pmanager->AddProcess( new G4MuIonisation,         -1, 2, 2 );
+      pmanager->AddProcess( new G4MuBremsstrahlung,     -1,-1, 3 );
+      pmanager->AddProcess( new G4MuPairProduction,     -1,-1, 4 );
+    } else if ( particle->GetPDGCharge() != 0  &&  ! particle->IsShortLived()
+                &&  particleName != "chargedgeantino" ) {
+      pmanager->AddProcess( new G4hMultipleScattering, -1, 1, 1 );
+      pmanager->AddProcess( new G4hIonisation,         -1, 2, 2 );
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void NNBARPhysicsList::AddParameterisation() {
   G4FastSimulationManagerProcess* fastSimProcess = 
     new G4FastSimulationManagerProcess( "G4FSMP" );
+  G4VProcess* process = fastSimProcess;
+  if ( fFastSimTiming ) {
+    process = new NNBARProcessTimer( fastSimProcess );
+  }
 
-  // Registers the fastSimProcess with all the particles as a discrete and
-  // continuous process (this works in all cases; in the case that parallel
-  // geometries are not used, as in this example, it would be enough to
-  // add it as a discrete process).
+  // Registers the fastSimProcess with the particles as a discrete and
+  // continuous process (general: this works in all cases) or as a discrete
+  // process only, which is enough as the models are placed in the mass
+  // geometry (no parallel geometry is used).
+  G4int registered = 0, particles = 0;
   auto particleIterator=GetParticleIterator();
   particleIterator->reset();
   while ( (*particleIterator)() ) {
     G4ParticleDefinition* particle = particleIterator->value();
+    particles++;
+    if ( fFastSimApplicableOnly  &&  ! IsParametrised( *particle ) ) continue;
     G4ProcessManager* pmanager = particle->GetProcessManager();
-    //pmanager->AddDiscreteProcess( fastSimProcess );    // No parallel geometry
-    pmanager->AddProcess( fastSimProcess, -1, 0, 0 );  // General
+    if ( fFastSimRegistration == eDiscreteRegistration ) {
+      pmanager->AddDiscreteProcess( process );         // No parallel geometry
+    } else {
+      pmanager->AddProcess( process, -1, 0, 0 );       // General
+    }
+    registered++;
+  }
+
+  std::ostringstream registration;
+  registration << ( fFastSimRegistration == eDiscreteRegistration ? "discrete" : "general" )
+               << ", " << registered << " of " << particles << " particle types";
+  if ( G4Threading::IsMasterThread() ) {
+    NNBARProcessTimer::SetRegistration( registration.str() );
+    if ( verboseLevel > 0 ) {
+      G4cout << "NNBARPhysicsList: fast simulation process registration: " 
+             << registration.str() << G4endl;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NNBARPhysicsList::HasHadronicProcesses() {
+  G4ParticleTable* particleTable = G4ParticleTable::GetParticleTable();
+  for ( const char* name : { "neutron", "proton", "pi+", "pi-" } ) {
+    G4ParticleDefinition* particle = particleTable->FindParticle( name );
+    G4ProcessManager* processManager = particle ? particle->GetProcessManager() : nullptr;
+    if ( ! processManager ) continue;
+    G4ProcessVector* processes = processManager->GetProcessList();
+    for ( std::size_t i = 0; i < processes->size(); i++ ) {
+      if ( ( *processes )[i]->GetProcessType() == fHadronic ) return true;
+    }
   }
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NNBARPhysicsList::IsParametrised( const G4ParticleDefinition& aParticle ) {
+  return NNBARFastSimModelTracker::AppliesTo( aParticle )  ||
+         NNBARFastSimModelEMCal::AppliesTo( aParticle )    ||
+         NNBARFastSimModelHCal::AppliesTo( aParticle )     ||
+         NNBARFastSimModelTarget::AppliesTo( aParticle );
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,168 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARPhysicsListMessenger.cc
+/// \brief Implementation of the NNBARPhysicsListMessenger class
+
+#include "NNBARPhysicsListMessenger.hh"
+#include "NNBARPhysicsList.hh"
+#include "NNBARRegionInformation.hh"
+#include "NNBARRegionTimer.hh"
+#include "NNBARFullSimScorer.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4RegionStore.hh"
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARPhysicsListMessenger::NNBARPhysicsListMessenger( NNBARPhysicsList* aPhysicsList ) 
+  : G4UImessenger(), fPhysicsList( aPhysicsList ) {
+  fDirectory = new G4UIdirectory( "/NNBAR/physics/" );
+  fDirectory->SetGuidance( "Hybrid fast/full simulation control." );
+
+  fHybridCmd = new G4UIcmdWithABool( "/NNBAR/physics/hybrid", this );
+  fHybridCmd->SetGuidance( "Register the electromagnetic processes, so that regions can be" );
+  fHybridCmd->SetGuidance( "switched to the full simulation (/NNBAR/physics/fullSimRegion)." );
+  fHybridCmd->SetGuidance( "Available before the initialisation only (nnbar_main -p <macro>)." );
+  fHybridCmd->SetParameterName( "hybrid", true );
+  fHybridCmd->SetDefaultValue( true );
+  fHybridCmd->AvailableForStates( G4State_PreInit );
+  fHybridCmd->SetToBeBroadcasted( false );
+
+  fFullSimRegionCmd = new G4UIcommand( "/NNBAR/physics/fullSimRegion", this );
+  fFullSimRegionCmd->SetGuidance( "Switch a region to the full simulation (or back to the fast one)." );
+  fFullSimRegionCmd->SetGuidance( "The fast simulation models of the region do not trigger and the" );
+  fFullSimRegionCmd->SetGuidance( "energy deposited in the calorimeter regions is saved as their records." );
+  fFullSimRegionCmd->SetGuidance( "HAD_calo_region requires hadronic processes, not registered by the" );
+  fFullSimRegionCmd->SetGuidance( "hybrid mode (the command is rejected without them)." );
+  fFullSimRegionCmd->SetGuidance( "Regions: Tracker_region Target_region EM_calo_region HAD_calo_region" );
+  G4UIparameter* region = new G4UIparameter( "region", 's', false );
+  fFullSimRegionCmd->SetParameter( region );
+  G4UIparameter* full = new G4UIparameter( "full", 'b', true );
+  full->SetDefaultValue( "true" );
+  fFullSimRegionCmd->SetParameter( full );
+  fFullSimRegionCmd->AvailableForStates( G4State_Idle );
+  fFullSimRegionCmd->SetToBeBroadcasted( false );
+
+  fRegionTimingCmd = new G4UIcmdWithABool( "/NNBAR/physics/regionTiming", this );
+  fRegionTimingCmd->SetGuidance( "Account the processing time per region (printed at the end of" );
+  fRegionTimingCmd->SetGuidance( "the run). It reads the clock at every step." );
+  fRegionTimingCmd->SetParameterName( "timing", true );
+  fRegionTimingCmd->SetDefaultValue( true );
+  fRegionTimingCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+  fRegionTimingCmd->SetToBeBroadcasted( false );
+
+  fRegistrationCmd = new G4UIcmdWithAString( "/NNBAR/physics/fastSimRegistration", this );
+  fRegistrationCmd->SetGuidance( "Register the fast simulation process as a general (along and" );
+  fRegistrationCmd->SetGuidance( "post step) or as a discrete (post step only) process. The" );
+  fRegistrationCmd->SetGuidance( "discrete registration is enough without parallel geometries." );
+  fRegistrationCmd->SetGuidance( "Available before the initialisation only (nnbar_main -p <macro>)." );
+  fRegistrationCmd->SetParameterName( "registration", false );
+  fRegistrationCmd->SetCandidates( "general discrete" );
+  fRegistrationCmd->AvailableForStates( G4State_PreInit );
+  fRegistrationCmd->SetToBeBroadcasted( false );
+
+  fApplicableOnlyCmd = new G4UIcmdWithABool( "/NNBAR/physics/fastSimApplicableOnly", this );
+  fApplicableOnlyCmd->SetGuidance( "Register the fast simulation process only for the particle" );
+  fApplicableOnlyCmd->SetGuidance( "types of the models (not for neutrinos, geantinos, ...)." );
+  fApplicableOnlyCmd->SetGuidance( "Available before the initialisation only (nnbar_main -p <macro>)." );
+  fApplicableOnlyCmd->SetParameterName( "applicableOnly", true );
+  fApplicableOnlyCmd->SetDefaultValue( true );
+  fApplicableOnlyCmd->AvailableForStates( G4State_PreInit );
+  fApplicableOnlyCmd->SetToBeBroadcasted( false );
+
+  fFastSimTimingCmd = new G4UIcmdWithABool( "/NNBAR/physics/fastSimTiming", this );
+  fFastSimTimingCmd->SetGuidance( "Measure the overhead per step of the fast simulation process" );
+  fFastSimTimingCmd->SetGuidance( "(printed at the end of each run)." );
+  fFastSimTimingCmd->SetGuidance( "Available before the initialisation only (nnbar_main -p <macro>)." );
+  fFastSimTimingCmd->SetParameterName( "timing", true );
+  fFastSimTimingCmd->SetDefaultValue( true );
+  fFastSimTimingCmd->AvailableForStates( G4State_PreInit );
+  fFastSimTimingCmd->SetToBeBroadcasted( false );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARPhysicsListMessenger::~NNBARPhysicsListMessenger() {
+  delete fFastSimTimingCmd;
+  delete fApplicableOnlyCmd;
+  delete fRegistrationCmd;
+  delete fRegionTimingCmd;
+  delete fFullSimRegionCmd;
+  delete fHybridCmd;
+  delete fDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARPhysicsListMessenger::SetNewValue( G4UIcommand* aCommand, G4String aNewValue ) {
+  if ( aCommand == fHybridCmd ) {
+    fPhysicsList->SetHybrid( fHybridCmd->GetNewBoolValue( aNewValue ) );
+  } else if ( aCommand == fFullSimRegionCmd ) {
+    G4String regionName, fullValue;
+    std::istringstream is( aNewValue );
+    is >> regionName >> fullValue;
+    G4Region* region = G4RegionStore::GetInstance()->GetRegion( regionName, false );
+    auto info = region ? 
+      dynamic_cast< NNBARRegionInformation* >( region->GetUserInformation() ) : nullptr;
+    if ( ! info ) {
+      G4cout << "NNBARPhysicsListMessenger: region " << regionName 
+             << " is not a detector region, command ignored." << G4endl;
+      return;
+    }
+    G4bool full = G4UIcommand::ConvertToBool( fullValue );
+    // Without the hadronic processes the hadron showers are not simulated and
+    // the deposit of the hadronic calorimeter would be meaningless
+    if ( full  &&  info->GetSaveType() == NNBAROutput::eSaveHCal  &&  
+         ! NNBARPhysicsList::HasHadronicProcesses() ) {
+      G4cout << "NNBARPhysicsListMessenger: no hadronic processes are registered, "
+             << regionName << " cannot be fully simulated, command ignored." << G4endl;
+      return;
+    }
+    if ( full  &&  ! fPhysicsList->IsHybrid() ) {
+      G4cout << "NNBARPhysicsListMessenger: the physics list is not in the hybrid mode, "
+             << "particles in " << regionName << " are only transported." << G4endl;
+    }
+    info->SetFullSimulation( full );
+    if ( full ) NNBARFullSimScorer::SetEnabled( true );
+  } else if ( aCommand == fRegionTimingCmd ) {
+    NNBARRegionTimer::SetEnabled( fRegionTimingCmd->GetNewBoolValue( aNewValue ) );
+  } else if ( aCommand == fRegistrationCmd ) {
+    fPhysicsList->SetFastSimRegistration( aNewValue == "discrete" ? 
+      NNBARPhysicsList::eDiscreteRegistration : NNBARPhysicsList::eGeneralRegistration );
+  } else if ( aCommand == fApplicableOnlyCmd ) {
+    fPhysicsList->SetFastSimApplicableOnly( fApplicableOnlyCmd->GetNewBoolValue( aNewValue ) );
+  } else if ( aCommand == fFastSimTimingCmd ) {
+    fPhysicsList->SetFastSimTiming( fFastSimTimingCmd->GetNewBoolValue( aNewValue ) );
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,148 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARProcessTimer.cc
+/// \brief Implementation of the NNBARProcessTimer class
+
+#include "NNBARProcessTimer.hh"
+
+#include "G4AutoLock.hh"
+#include <algorithm>
+#include <iomanip>
+
+namespace {
+  G4Mutex processTimerMutex = G4MUTEX_INITIALIZER;
+}
+
+G4bool NNBARProcessTimer::fEnabled = false;
+G4String NNBARProcessTimer::fRegistration;
+G4ThreadLocal G4double NNBARProcessTimer::fTime = 0;
+G4ThreadLocal G4long NNBARProcessTimer::fCalls = 0;
+G4ThreadLocal G4long NNBARProcessTimer::fSteps = 0;
+G4double NNBARProcessTimer::fMergedTime = 0;
+G4long NNBARProcessTimer::fMergedCalls = 0;
+G4long NNBARProcessTimer::fMergedSteps = 0;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARProcessTimer::NNBARProcessTimer( G4VProcess* aProcess ) : 
+  G4WrapperProcess( aProcess->GetProcessName(), aProcess->GetProcessType() ) {
+  RegisterProcess( aProcess );
+  SetEnabled( true );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARProcessTimer::~NNBARProcessTimer() {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double NNBARProcessTimer::PostStepGetPhysicalInteractionLength( const G4Track& aTrack,
+                                                                  G4double aPreviousStepSize,
+                                                                  G4ForceCondition* aCondition ) {
+  Clock::time_point start = Clock::now();
+  G4double length = 
+    G4WrapperProcess::PostStepGetPhysicalInteractionLength( aTrack, aPreviousStepSize, aCondition );
+  Account( start );
+  return length;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double NNBARProcessTimer::AlongStepGetPhysicalInteractionLength( const G4Track& aTrack,
+                                                                   G4double aPreviousStepSize,
+                                                                   G4double aCurrentMinimumStep,
+                                                                   G4double& aCurrentSafety,
+                                                                   G4GPILSelection* aSelection ) {
+  Clock::time_point start = Clock::now();
+  G4double length = G4WrapperProcess::AlongStepGetPhysicalInteractionLength( aTrack, 
+    aPreviousStepSize, aCurrentMinimumStep, aCurrentSafety, aSelection );
+  Account( start );
+  return length;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4VParticleChange* NNBARProcessTimer::PostStepDoIt( const G4Track& aTrack, const G4Step& aStep ) {
+  Clock::time_point start = Clock::now();
+  G4VParticleChange* change = G4WrapperProcess::PostStepDoIt( aTrack, aStep );
+  Account( start );
+  return change;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4VParticleChange* NNBARProcessTimer::AlongStepDoIt( const G4Track& aTrack, const G4Step& aStep ) {
+  Clock::time_point start = Clock::now();
+  G4VParticleChange* change = G4WrapperProcess::AlongStepDoIt( aTrack, aStep );
+  Account( start );
+  return change;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double NNBARProcessTimer::MeasureClockOverhead() {
+  const G4int readings = 100000;
+  G4double time = 0;
+  for ( G4int i = 0; i < readings; i++ ) {
+    // The same accounting as a call, around nothing
+    Clock::time_point start = Clock::now();
+    time += std::chrono::duration< G4double >( Clock::now() - start ).count();
+  }
+  return time / readings;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARProcessTimer::EndOfRun( G4bool aIsMaster ) {
+  if ( ! fEnabled ) return;
+  G4AutoLock lock( &processTimerMutex );
+  fMergedTime += fTime;
+  fMergedCalls += fCalls;
+  fMergedSteps += fSteps;
+  fTime = 0;
+  fCalls = 0;
+  fSteps = 0;
+  if ( ! aIsMaster  ||  fMergedSteps == 0 ) return;
+
+  G4double clockOverhead = MeasureClockOverhead();
+  G4double time = std::max( 0., fMergedTime - fMergedCalls * clockOverhead );
+  G4cout << G4endl << "------------ Fast simulation process overhead ------------" << G4endl
+         << "registration  : " << fRegistration << G4endl
+         << "steps         : " << fMergedSteps << G4endl
+         << "process calls : " << fMergedCalls << " (" << std::setprecision( 3 ) 
+         << G4double( fMergedCalls ) / fMergedSteps << " per step)" << G4endl
+         << "time          : " << std::setprecision( 4 ) << time << " s (clock reading of "
+         << std::setprecision( 3 ) << 1e9 * clockOverhead << " ns per call subtracted)" << G4endl
+         << "overhead      : " << std::setprecision( 4 ) << 1e9 * time / fMergedSteps 
+         << " ns/step" << G4endl
+         << "----------------------------------------------------------" << G4endl;
+  fMergedTime = 0;
+  fMergedCalls = 0;
+  fMergedSteps = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
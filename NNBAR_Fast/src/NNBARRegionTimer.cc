@@ -0,0 +1,85 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARRegionTimer.cc
+/// \brief Implementation of the NNBARRegionTimer class
+
+#include "NNBARRegionTimer.hh"
+
+#include "G4Region.hh"
+#include "G4AutoLock.hh"
+#include <iomanip>
+
+namespace {
+  G4Mutex regionTimerMutex = G4MUTEX_INITIALIZER;
+}
+
+G4bool NNBARRegionTimer::fEnabled = false;
+std::map< G4String, NNBARRegionTimer::Account > NNBARRegionTimer::fMergedAccounts;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARRegionTimer* NNBARRegionTimer::Instance() {
+  static G4ThreadLocal NNBARRegionTimer* regionTimer = nullptr;
+  if ( ! regionTimer ) regionTimer = new NNBARRegionTimer;
+  return regionTimer;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARRegionTimer::NNBARRegionTimer() : fAccounts(), fLastStamp( Clock::now() ) {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARRegionTimer::EndOfRun( G4bool aIsMaster ) {
+  G4AutoLock lock( &regionTimerMutex );
+  for ( const auto& account : fAccounts ) {
+    Account& merged = fMergedAccounts[ account.first->GetName() ];
+    merged.fTime += account.second.fTime;
+    merged.fSteps += account.second.fSteps;
+  }
+  fAccounts.clear();
+  if ( ! aIsMaster  ||  fMergedAccounts.empty() ) return;
+
+  G4double totalTime = 0;
+  for ( const auto& account : fMergedAccounts ) totalTime += account.second.fTime;
+  G4cout << G4endl << "---------------- Processing time per region ----------------" << G4endl
+         << std::setw( 26 ) << std::left << "region" << std::right 
+         << std::setw( 12 ) << "steps" << std::setw( 12 ) << "time [s]" 
+         << std::setw( 8 ) << "[%]" << std::setw( 12 ) << "ns/step" << G4endl;
+  for ( const auto& account : fMergedAccounts ) {
+    const Account& a = account.second;
+    G4cout << std::setw( 26 ) << std::left << account.first << std::right 
+           << std::setw( 12 ) << a.fSteps << std::setw( 12 ) << std::setprecision( 4 ) << a.fTime
+           << std::setw( 8 ) << std::setprecision( 3 ) << 100. * a.fTime / totalTime
+           << std::setw( 12 ) << std::setprecision( 4 ) 
+           << ( a.fSteps > 0 ? 1e9 * a.fTime / a.fSteps : 0. ) << G4endl;
+  }
+  G4cout << "-------------------------------------------------------------" << G4endl;
+  fMergedAccounts.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -29,6 +29,9 @@
 
 #include "NNBAROutput.hh"
 #include "NNBARRunAction.hh"
+#include "NNBARLogger.hh"
+#include "NNBARRegionTimer.hh"
+#include "NNBARProcessTimer.hh"
 #include "G4Run.hh"
 #include "G4UnitsTable.hh"
 #include "G4SystemOfUnits.hh"
@@ -43,11 +46,8 @@ NNBARRunAction::NNBARRunAction( const G4String aOutName ) :
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 NNBARRunAction::~NNBARRunAction() {
-  #ifdef G4MULTITHREADED
-  if ( isMaster ) delete NNBAROutput::Instance();
-  #else
+  // Each thread has its own NNBAROutput
   delete NNBAROutput::Instance();
-  #endif
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -55,12 +55,16 @@ NNBARRunAction::~NNBARRunAction() {
 void NNBARRunAction::BeginOfRunAction( const G4Run* aRun ) {
   NNBAROutput::Instance()->StartAnalysis( aRun->GetRunID() );
   NNBAROutput::Instance()->CreateHistograms();
+  NNBAROutput::Instance()->CreateNtuples();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void NNBARRunAction::EndOfRunAction( const G4Run* /*aRun*/ ) {
   NNBAROutput::Instance()->EndAnalysis();
+  NNBARRegionTimer::Instance()->EndOfRun( isMaster );
+  NNBARProcessTimer::EndOfRun( isMaster );
+  NNBARLogger::Flush();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
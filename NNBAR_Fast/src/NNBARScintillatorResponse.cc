@@ -0,0 +1,139 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARScintillatorResponse.cc
+/// \brief Implementation of the NNBARScintillatorResponse class
+
+#include "NNBARScintillatorResponse.hh"
+#include "NNBARLogger.hh"
+
+#include "G4Material.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+
+#include <cmath>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARScintillatorResponse::NNBARScintillatorResponse() : fBirksConstant( 0 ),
+  fElectronDensity( 0 ), fMeanExcitationEnergy( 0 ) {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARScintillatorResponse::~NNBARScintillatorResponse() {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARScintillatorResponse::Build( const G4Material* aMaterial, G4double aBirksConstant ) {
+  fBirksConstant = aBirksConstant;
+  fElectronDensity = aMaterial->GetElectronDensity();
+  fMeanExcitationEnergy = aMaterial->GetIonisation()->GetMeanExcitationEnergy();
+
+  // Mass of the particle that produces the light, per species (neutral
+  // hadrons are seen through recoil protons)
+  const G4double kaonMass = 493.677 * MeV;
+  const G4double pionMass = 139.570 * MeV;
+  G4double masses[NNBARDetectorParametrisation::eNumberOfHadronSpecies];
+  masses[NNBARDetectorParametrisation::eProton]      = proton_mass_c2;
+  masses[NNBARDetectorParametrisation::eNeutron]     = proton_mass_c2;
+  masses[NNBARDetectorParametrisation::eChargedKaon] = kaonMass;
+  masses[NNBARDetectorParametrisation::eNeutralKaon] = proton_mass_c2;
+  masses[NNBARDetectorParametrisation::eChargedPion] = pionMass;
+
+  // F(T) = integral from 0 to T of dE / ( 1 + kB dE/dx ), integrated with
+  // the trapezoidal rule on a fine logarithmic grid
+  const G4int subSteps = 20;
+  G4double logStep = std::log( fMaxEnergy / fMinEnergy ) / ( fNumberOfNodes - 1 );
+  for ( G4int species = 0; species < NNBARDetectorParametrisation::eNumberOfHadronSpecies; 
+        species++ ) {
+    std::vector< G4double >& table = fTable[species];
+    table.resize( fNumberOfNodes );
+    G4double energy = fMinEnergy * MeV;
+    G4double light = energy / ( 1. + fBirksConstant * GetStoppingPower( masses[species], energy ) );
+    table[0] = light;
+    for ( G4int i = 1; i < fNumberOfNodes; i++ ) {
+      for ( G4int j = 0; j < subSteps; j++ ) {
+        G4double nextEnergy = energy * std::exp( logStep / subSteps );
+        G4double dLdE = 1. / ( 1. + fBirksConstant * GetStoppingPower( masses[species], energy ) );
+        G4double nextdLdE = 
+          1. / ( 1. + fBirksConstant * GetStoppingPower( masses[species], nextEnergy ) );
+        light += 0.5 * ( dLdE + nextdLdE ) * ( nextEnergy - energy );
+        energy = nextEnergy;
+      }
+      table[i] = light;
+    }
+  }
+  NNBAR_INFO( NNBARLogger::eHCal, "Birks tables for " << aMaterial->GetName() << ": kB = " 
+              << fBirksConstant / ( mm/MeV ) << " mm/MeV, visible fraction of a stopping 100 MeV "
+              << "proton " << GetVisibleEnergy( NNBARDetectorParametrisation::eProton, 
+                                                100*MeV, 100*MeV ) / ( 100*MeV ) );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double NNBARScintillatorResponse::GetCumulativeLight( G4int aTable, G4double aKenergy ) const {
+  const std::vector< G4double >& table = fTable[aTable];
+  if ( aKenergy <= 0. ) return 0.;
+  if ( aKenergy <= fMinEnergy * MeV ) return table[0] * aKenergy / ( fMinEnergy * MeV );
+  G4double x = std::log( aKenergy / ( fMinEnergy * MeV ) ) / std::log( fMaxEnergy / fMinEnergy )
+               * ( fNumberOfNodes - 1 );
+  if ( x >= fNumberOfNodes - 1 ) {
+    // Above the table the particle is minimum ionising: the light grows linearly
+    G4double lastEnergy = fMaxEnergy * MeV;
+    G4double slope = ( table[fNumberOfNodes - 1] - table[fNumberOfNodes - 2] ) 
+                     / ( lastEnergy * ( 1. - std::exp( -std::log( fMaxEnergy / fMinEnergy ) 
+                                                        / ( fNumberOfNodes - 1 ) ) ) );
+    return table[fNumberOfNodes - 1] + slope * ( aKenergy - lastEnergy );
+  }
+  G4int i = G4int( x );
+  G4double f = x - i;
+  return ( 1. - f ) * table[i] + f * table[i + 1];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double NNBARScintillatorResponse::GetVisibleEnergy( G4int aSpecies, G4double aKenergy,
+                                                      G4double aDeposit ) const {
+  if ( ! IsBuilt()  ||  aDeposit <= 0. ) return 0.;
+  aDeposit = std::min( aDeposit, aKenergy );
+  switch ( aSpecies ) {
+    case NNBARDetectorParametrisation::eProton :
+    case NNBARDetectorParametrisation::eChargedKaon :
+    case NNBARDetectorParametrisation::eChargedPion :
+      return GetCumulativeLight( aSpecies, aKenergy ) 
+             - GetCumulativeLight( aSpecies, aKenergy - aDeposit );
+    case NNBARDetectorParametrisation::eNeutron :
+    case NNBARDetectorParametrisation::eNeutralKaon :
+      return GetCumulativeLight( aSpecies, aDeposit );
+    default :
+      // Other hadrons: light particles are treated as pions
+      return GetCumulativeLight( NNBARDetectorParametrisation::eChargedPion, aKenergy ) 
+             - GetCumulativeLight( NNBARDetectorParametrisation::eChargedPion, 
+                                   aKenergy - aDeposit );
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
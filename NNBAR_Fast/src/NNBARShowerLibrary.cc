@@ -0,0 +1,244 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARShowerLibrary.cc
+/// \brief Implementation of the NNBARShowerLibrary class
+
+#include "NNBARShowerLibrary.hh"
+#include "NNBARLogger.hh"
+
+#include "G4AutoLock.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+  G4Mutex libraryMutex = G4MUTEX_INITIALIZER;
+
+  /// The header of the library file.
+  struct LibraryHeader {
+    char fMagic[8];
+    std::uint32_t fVersion;
+    std::uint32_t fNumberOfShowers;
+    std::uint64_t fNumberOfSpots;
+  };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARShowerLibrary::NNBARShowerLibrary() : fFileName( "" ), fMapping( nullptr ),
+  fMappingSize( 0 ), fShowers( nullptr ), fSpots( nullptr ), fNumberOfShowers( 0 ),
+  fLogEnergyMin( 0 ), fLogEnergyMax( 1 ) {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARShowerLibrary::~NNBARShowerLibrary() {
+  Unload();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARShowerLibrary* NNBARShowerLibrary::Instance() {
+  // Called for each shower: the initialisation of the static is thread-safe,
+  // the lock is taken only to load and unload the library
+  static NNBARShowerLibrary* showerLibrary = new NNBARShowerLibrary();
+  return showerLibrary;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NNBARShowerLibrary::Load( const G4String& aFileName ) {
+  G4AutoLock lock( &libraryMutex );
+  if ( IsLoaded()  &&  aFileName == fFileName ) return true;
+  Unload();
+
+  G4int fd = open( aFileName.c_str(), O_RDONLY );
+  if ( fd < 0 ) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open the shower library " << aFileName;
+    G4Exception( "NNBARShowerLibrary::Load()", "NNBAR001", JustWarning, msg );
+    return false;
+  }
+  struct stat fileStat;
+  if ( fstat( fd, &fileStat ) != 0  ||  
+       static_cast< std::size_t >( fileStat.st_size ) < sizeof( LibraryHeader ) ) {
+    close( fd );
+    G4ExceptionDescription msg;
+    msg << "The shower library " << aFileName << " is too short.";
+    G4Exception( "NNBARShowerLibrary::Load()", "NNBAR001", JustWarning, msg );
+    return false;
+  }
+  fMappingSize = fileStat.st_size;
+  fMapping = mmap( nullptr, fMappingSize, PROT_READ, MAP_SHARED, fd, 0 );
+  close( fd );  // The mapping stays valid after closing the file
+  if ( fMapping == MAP_FAILED ) {
+    fMapping = nullptr;
+    fMappingSize = 0;
+    G4ExceptionDescription msg;
+    msg << "Cannot map the shower library " << aFileName;
+    G4Exception( "NNBARShowerLibrary::Load()", "NNBAR001", JustWarning, msg );
+    return false;
+  }
+
+  // Check the header and that all the records lie inside the file
+  const LibraryHeader* header = static_cast< const LibraryHeader* >( fMapping );
+  std::size_t showersSize = std::size_t( header->fNumberOfShowers ) * sizeof( Shower );
+  std::size_t spotsSize = std::size_t( header->fNumberOfSpots ) * sizeof( Spot );
+  if ( std::strncmp( header->fMagic, "NNBARSL1", 8 ) != 0  ||  header->fVersion != 1  ||
+       sizeof( LibraryHeader ) + showersSize + spotsSize > fMappingSize ) {
+    Unload();
+    G4ExceptionDescription msg;
+    msg << "The file " << aFileName << " is not a valid shower library.";
+    G4Exception( "NNBARShowerLibrary::Load()", "NNBAR001", JustWarning, msg );
+    return false;
+  }
+  const char* data = static_cast< const char* >( fMapping ) + sizeof( LibraryHeader );
+  fShowers = reinterpret_cast< const Shower* >( data );
+  fSpots = reinterpret_cast< const Spot* >( data + showersSize );
+  fNumberOfShowers = header->fNumberOfShowers;
+  for ( std::uint32_t i = 0; i < fNumberOfShowers; i++ ) {
+    if ( std::uint64_t( fShowers[i].fFirstSpot ) + fShowers[i].fNumberOfSpots 
+         > header->fNumberOfSpots  ||  ! ( fShowers[i].fEnergy > 0 ) ) {
+      Unload();
+      G4ExceptionDescription msg;
+      msg << "Shower " << i << " of the library " << aFileName << " is corrupted.";
+      G4Exception( "NNBARShowerLibrary::Load()", "NNBAR001", JustWarning, msg );
+      return false;
+    }
+  }
+  fFileName = aFileName;
+  BuildIndex();
+
+  NNBAR_INFO( NNBARLogger::eEMCal, "Shower library " << aFileName << " loaded: " 
+              << fNumberOfShowers << " showers, " << header->fNumberOfSpots << " spots" );
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARShowerLibrary::Unload() {
+  if ( fMapping ) {
+    munmap( fMapping, fMappingSize );
+  }
+  fMapping = nullptr;
+  fMappingSize = 0;
+  fShowers = nullptr;
+  fSpots = nullptr;
+  fNumberOfShowers = 0;
+  fFileName = "";
+  fIndex.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARShowerLibrary::BuildIndex() {
+  fLogEnergyMin = DBL_MAX;
+  fLogEnergyMax = -DBL_MAX;
+  for ( std::uint32_t i = 0; i < fNumberOfShowers; i++ ) {
+    G4double logEnergy = std::log10( fShowers[i].fEnergy );
+    fLogEnergyMin = std::min( fLogEnergyMin, logEnergy );
+    fLogEnergyMax = std::max( fLogEnergyMax, logEnergy );
+  }
+  if ( fLogEnergyMax - fLogEnergyMin < 1e-6 ) fLogEnergyMax = fLogEnergyMin + 1e-6;
+
+  for ( std::uint32_t i = 0; i < fNumberOfShowers; i++ ) {
+    std::vector< std::vector< std::uint32_t > >& bins = fIndex[fShowers[i].fPDG];
+    if ( bins.empty() ) bins.resize( fNumberOfEnergyBins * fNumberOfAngleBins );
+    G4int bin = GetEnergyBin( std::log10( fShowers[i].fEnergy ) ) * fNumberOfAngleBins
+              + GetAngleBin( fShowers[i].fCosTheta );
+    bins[bin].push_back( i );
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int NNBARShowerLibrary::GetEnergyBin( G4double aLogEnergy ) const {
+  G4int bin = G4int( ( aLogEnergy - fLogEnergyMin ) / ( fLogEnergyMax - fLogEnergyMin ) 
+                     * fNumberOfEnergyBins );
+  return std::max( 0, std::min( fNumberOfEnergyBins - 1, bin ) );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int NNBARShowerLibrary::GetAngleBin( G4double aCosTheta ) const {
+  G4int bin = G4int( aCosTheta * fNumberOfAngleBins );
+  return std::max( 0, std::min( fNumberOfAngleBins - 1, bin ) );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const NNBARShowerLibrary::Shower* NNBARShowerLibrary::FindShower( G4double aEnergy, 
+                                                                  G4double aCosTheta,
+                                                                  G4int aPDG ) const {
+  if ( ! IsLoaded()  ||  aEnergy <= 0 ) return nullptr;
+  auto it = fIndex.find( aPDG );
+  if ( it == fIndex.end() ) it = fIndex.find( -aPDG );
+  if ( it == fIndex.end() ) return nullptr;
+  const std::vector< std::vector< std::uint32_t > >& bins = it->second;
+
+  // Distances are measured in units of the bin widths, so that both
+  // coordinates have the same weight
+  G4double energyWidth = ( fLogEnergyMax - fLogEnergyMin ) / fNumberOfEnergyBins;
+  G4double angleWidth = 1. / fNumberOfAngleBins;
+  G4double logEnergy = std::log10( aEnergy / MeV );
+  G4int energyBin = GetEnergyBin( logEnergy );
+  G4int angleBin = GetAngleBin( aCosTheta );
+
+  // Search the rings of bins around the bin of the query. A bin in ring r+1 is
+  // at least r bin widths away, so the search stops once the best candidate is
+  // closer than that.
+  const Shower* best = nullptr;
+  G4double bestDistance2 = DBL_MAX;
+  G4int maxRing = std::max( fNumberOfEnergyBins, fNumberOfAngleBins );
+  for ( G4int ring = 0; ring <= maxRing; ring++ ) {
+    for ( G4int i = energyBin - ring; i <= energyBin + ring; i++ ) {
+      if ( i < 0  ||  i >= fNumberOfEnergyBins ) continue;
+      for ( G4int j = angleBin - ring; j <= angleBin + ring; j++ ) {
+        if ( j < 0  ||  j >= fNumberOfAngleBins ) continue;
+        if ( std::abs( i - energyBin ) != ring  &&  std::abs( j - angleBin ) != ring ) continue;
+        for ( std::uint32_t index : bins[i * fNumberOfAngleBins + j] ) {
+          G4double dE = ( std::log10( fShowers[index].fEnergy ) - logEnergy ) / energyWidth;
+          G4double dA = ( fShowers[index].fCosTheta - aCosTheta ) / angleWidth;
+          G4double distance2 = dE * dE + dA * dA;
+          if ( distance2 < bestDistance2 ) {
+            bestDistance2 = distance2;
+            best = fShowers + index;
+          }
+        }
+      }
+    }
+    if ( best  &&  bestDistance2 <= G4double( ring * ring ) ) break;
+  }
+  return best;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,377 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARSkimFilter.cc
+/// \brief Implementation of the NNBARSkimFilter class
+
+#include "NNBARSkimFilter.hh"
+#include "G4Exception.hh"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <type_traits>
+
+namespace {
+  /// A name in lower case (the counts of rows are not case sensitive).
+  G4String ToLower( G4String aName ) {
+    std::transform( aName.begin(), aName.end(), aName.begin(), 
+                    []( unsigned char aChar ) { return std::tolower( aChar ); } );
+    return aName;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARSkimFilter::NNBARSkimFilter() : fPosition( 0 ) {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NNBARSkimFilter::Compile( const NNBAROutputEvent& aEvent ) {
+  fProgram.clear();
+  fColumns.clear();
+  fNtuples.clear();
+  fCounts.clear();
+  aEvent.ForEachRecord( [this]( const char* aName, const char*, const auto& aRecord ) {
+    fNtuples.push_back( ToLower( aName ) );
+    fCounts.push_back( { eCount, 0, fColumns.size() } );
+    aRecord.ForEachColumn( [this]( const char* aColumnName, const auto& ) {
+      fColumns.push_back( aColumnName );
+    } );
+  } );
+  // The calorimeters count the deposits with energy (not the rows of the
+  // particles missed by the efficiency), the MC the particles (not the rows
+  // added up to the ID of a particle)
+  for ( std::size_t i = 0; i < fNtuples.size(); i++ ) {
+    const char* column = fNtuples[i] == "emcal" ? "emcal_E" : fNtuples[i] == "hcal" ? "hcal_E" 
+                       : fNtuples[i] == "mc" ? "particleID" : nullptr;
+    if ( column  &&  FindColumn( column ) >= 0 ) {
+      fCounts[i] = { eCountAbove, fNtuples[i] == "mc" ? -1. : 0., std::size_t( FindColumn( column ) ) };
+    }
+  }
+
+  fPosition = 0;
+  fError = "";
+  Next( "" );
+  if ( fPosition == fExpression.size() ) return true;
+  G4bool valid = ParseOr();
+  if ( valid ) {
+    Next( "" );
+    if ( fPosition != fExpression.size() ) {
+      fError = "unexpected characters";
+      valid = false;
+    }
+  }
+  if ( ! valid ) {
+    G4ExceptionDescription msg;
+    msg << "The skim expression \"" << fExpression << "\" is not valid: " << fError 
+        << " at the position " << fPosition << ". All the events are saved.";
+    G4Exception( "NNBARSkimFilter::Compile()", "NNBAR003", JustWarning, msg );
+    fProgram.clear();
+  }
+  return valid;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NNBARSkimFilter::Accept( const NNBAROutputEvent& aEvent ) {
+  if ( fProgram.empty() ) return true;
+  Collect( aEvent );
+  // The capacity of the stack is kept between the events
+  fStack.clear();
+  for ( const auto& instruction : fProgram ) {
+    switch ( instruction.fOperation ) {
+      case eNumber :
+        fStack.push_back( instruction.fNumber );
+        continue;
+      case eSum : case eMin : case eMax : case eCount : case eCountAbove :
+        fStack.push_back( Aggregate( instruction.fOperation, fValues[instruction.fColumn],
+                                     instruction.fNumber ) );
+        continue;
+      case eNegate :
+        fStack.back() = - fStack.back();
+        continue;
+      case eNot :
+        fStack.back() = fStack.back() == 0;
+        continue;
+      default :
+        break;
+    }
+    G4double right = fStack.back();
+    fStack.pop_back();
+    G4double& left = fStack.back();
+    switch ( instruction.fOperation ) {
+      case eAdd          : left = left + right;  break;
+      case eSubtract     : left = left - right;  break;
+      case eMultiply     : left = left * right;  break;
+      case eDivide       : left = left / right;  break;
+      case eLess         : left = left < right;  break;
+      case eLessEqual    : left = left <= right; break;
+      case eGreater      : left = left > right;  break;
+      case eGreaterEqual : left = left >= right; break;
+      case eEqual        : left = left == right; break;
+      case eNotEqual     : left = left != right; break;
+      case eAnd          : left = left != 0  &&  right != 0; break;
+      case eOr           : left = left != 0  ||  right != 0; break;
+      default : break;
+    }
+  }
+  return fStack.back() != 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARSkimFilter::Collect( const NNBAROutputEvent& aEvent ) {
+  fValues.clear();
+  aEvent.ForEachRecord( [this]( const char*, const char*, const auto& aRecord ) {
+    aRecord.ForEachColumn( [this]( const char*, const auto& aColumn ) {
+      using Value = typename std::decay< decltype( aColumn ) >::type::value_type;
+      G4int type = std::is_same< Value, G4int >::value ? 0 : std::is_same< Value, G4float >::value ? 1 : 2;
+      fValues.push_back( { aColumn.data(), aColumn.size(), type } );
+    } );
+  } );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  template< typename T > 
+  G4double AggregateValues( G4int aOperation, const T* aData, std::size_t aSize, 
+                            G4double aThreshold ) {
+    if ( aOperation == 3 ) {
+      return G4double( std::count_if( aData, aData + aSize, 
+                                      [aThreshold]( T aValue ) { return aValue > aThreshold; } ) );
+    }
+    if ( aSize == 0 ) return 0;
+    G4double result = aData[0];
+    for ( std::size_t i = 1; i < aSize; i++ ) {
+      switch ( aOperation ) {
+        case 0 : result += aData[i]; break;
+        case 1 : result = std::min( result, G4double( aData[i] ) ); break;
+        default : result = std::max( result, G4double( aData[i] ) ); break;
+      }
+    }
+    return result;
+  }
+}
+
+G4double NNBARSkimFilter::Aggregate( Operation aOperation, const Values& aValues, 
+                                     G4double aThreshold ) const {
+  if ( aOperation == eCount ) return aValues.fSize;
+  G4int operation = aOperation == eSum ? 0 : aOperation == eMin ? 1 : aOperation == eMax ? 2 : 3;
+  switch ( aValues.fType ) {
+    case 0  : return AggregateValues( operation, static_cast< const G4int* >( aValues.fData ), 
+                                      aValues.fSize, aThreshold );
+    case 1  : return AggregateValues( operation, static_cast< const G4float* >( aValues.fData ), 
+                                      aValues.fSize, aThreshold );
+    default : return AggregateValues( operation, static_cast< const G4double* >( aValues.fData ), 
+                                      aValues.fSize, aThreshold );
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NNBARSkimFilter::Next( const char* aToken ) {
+  while ( fPosition < fExpression.size()  &&  std::isspace( (unsigned char) fExpression[fPosition] ) ) fPosition++;
+  std::size_t length = std::char_traits< char >::length( aToken );
+  if ( fExpression.compare( fPosition, length, aToken ) != 0 ) return false;
+  fPosition += length;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String NNBARSkimFilter::ReadName() {
+  Next( "" );
+  std::size_t start = fPosition;
+  while ( fPosition < fExpression.size()  &&  
+          ( std::isalnum( (unsigned char) fExpression[fPosition] )  ||  fExpression[fPosition] == '_' ) ) {
+    fPosition++;
+  }
+  return fExpression.substr( start, fPosition - start );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int NNBARSkimFilter::FindColumn( const G4String& aName ) const {
+  for ( std::size_t i = 0; i < fColumns.size(); i++ ) {
+    if ( fColumns[i] == aName ) return i;
+  }
+  return -1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NNBARSkimFilter::ParseOr() {
+  if ( ! ParseAnd() ) return false;
+  while ( Next( "||" ) ) {
+    if ( ! ParseAnd() ) return false;
+    fProgram.push_back( { eOr, 0, 0 } );
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NNBARSkimFilter::ParseAnd() {
+  if ( ! ParseNot() ) return false;
+  while ( Next( "&&" ) ) {
+    if ( ! ParseNot() ) return false;
+    fProgram.push_back( { eAnd, 0, 0 } );
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NNBARSkimFilter::ParseNot() {
+  if ( Next( "!" ) ) {
+    if ( ! ParseNot() ) return false;
+    fProgram.push_back( { eNot, 0, 0 } );
+    return true;
+  }
+  return ParseComparison();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NNBARSkimFilter::ParseComparison() {
+  if ( ! ParseSum() ) return false;
+  Operation operation;
+  if      ( Next( "<=" ) ) operation = eLessEqual;
+  else if ( Next( ">=" ) ) operation = eGreaterEqual;
+  else if ( Next( "==" ) ) operation = eEqual;
+  else if ( Next( "!=" ) ) operation = eNotEqual;
+  else if ( Next( "<" ) )  operation = eLess;
+  else if ( Next( ">" ) )  operation = eGreater;
+  else return true;
+  if ( ! ParseSum() ) return false;
+  fProgram.push_back( { operation, 0, 0 } );
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NNBARSkimFilter::ParseSum() {
+  if ( ! ParseProduct() ) return false;
+  while ( true ) {
+    Operation operation;
+    if      ( Next( "+" ) ) operation = eAdd;
+    else if ( Next( "-" ) ) operation = eSubtract;
+    else return true;
+    if ( ! ParseProduct() ) return false;
+    fProgram.push_back( { operation, 0, 0 } );
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NNBARSkimFilter::ParseProduct() {
+  if ( ! ParseUnary() ) return false;
+  while ( true ) {
+    Operation operation;
+    if      ( Next( "*" ) ) operation = eMultiply;
+    else if ( Next( "/" ) ) operation = eDivide;
+    else return true;
+    if ( ! ParseUnary() ) return false;
+    fProgram.push_back( { operation, 0, 0 } );
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NNBARSkimFilter::ParseUnary() {
+  if ( Next( "-" ) ) {
+    if ( ! ParseUnary() ) return false;
+    fProgram.push_back( { eNegate, 0, 0 } );
+    return true;
+  }
+  return ParsePrimary();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NNBARSkimFilter::ParsePrimary() {
+  if ( Next( "(" ) ) {
+    if ( ! ParseOr() ) return false;
+    if ( ! Next( ")" ) ) {
+      fError = "missing )";
+      return false;
+    }
+    return true;
+  }
+
+  const char* start = fExpression.c_str() + fPosition;
+  if ( std::isdigit( (unsigned char) *start )  ||  *start == '.' ) {
+    char* end = nullptr;
+    G4double number = std::strtod( start, &end );
+    if ( end == start ) {
+      fError = "invalid number";
+      return false;
+    }
+    fPosition += end - start;
+    fProgram.push_back( { eNumber, number, 0 } );
+    return true;
+  }
+
+  G4String name = ReadName();
+  if ( name.empty() ) {
+    fError = fPosition < fExpression.size() ? "unexpected character" : "unexpected end";
+    return false;
+  }
+  if ( Next( "(" ) ) {
+    Operation operation;
+    if      ( name == "sum" )   operation = eSum;
+    else if ( name == "min" )   operation = eMin;
+    else if ( name == "max" )   operation = eMax;
+    else if ( name == "count" ) operation = eCount;
+    else {
+      fError = "unknown function " + name;
+      return false;
+    }
+    G4String column = ReadName();
+    G4int index = FindColumn( column );
+    if ( index < 0 ) {
+      fError = "unknown column " + column;
+      return false;
+    }
+    if ( ! Next( ")" ) ) {
+      fError = "missing )";
+      return false;
+    }
+    fProgram.push_back( { operation, 0, std::size_t( index ) } );
+    return true;
+  }
+  // The number of rows of an ntuple
+  for ( std::size_t i = 0; i < fNtuples.size(); i++ ) {
+    if ( ToLower( name ) == "n" + fNtuples[i] ) {
+      fProgram.push_back( fCounts[i] );
+      return true;
+    }
+  }
+  fError = FindColumn( name ) >= 0 ? "the column " + name + " needs a function (sum, min, max, count)" 
+                                   : "unknown name " + name;
+  return false;
+}
@@ -36,6 +36,7 @@
 #include "G4FieldManager.hh"
 #include "G4UniformMagField.hh"
 #include <ctime>
+#include <cmath>
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -47,6 +48,10 @@ NNBARSmearer::NNBARSmearer() {
   time_t seed = time( NULL );
   fRandomEngine = new CLHEP::HepJamesRandom( static_cast< long >( seed ) );
   fRandomGauss = new CLHEP::RandGauss( fRandomEngine );
+  fLogFactorial[0] = 0.;
+  for ( G4int k = 1; k < fLogFactorialTableSize; k++ ) {
+    fLogFactorial[k] = fLogFactorial[k - 1] + std::log( G4double( k ) );
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -105,3 +110,44 @@ G4double NNBARSmearer::Gauss( G4double aMean, G4double aStandardDeviation ) {
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+G4long NNBARSmearer::Poisson( G4double aMean ) {
+  if ( aMean <= 0. ) return 0;
+
+  if ( aMean < fPoissonInversionLimit ) {
+    // Inversion: walk up the cumulative distribution
+    G4double u = fRandomEngine->flat();
+    G4double p = std::exp( -aMean );
+    G4double cdf = p;
+    G4long k = 0;
+    while ( u > cdf  &&  k < 1000 ) {
+      k++;
+      p *= aMean / k;
+      cdf += p;
+    }
+    return k;
+  }
+
+  // PTRS (transformed rejection with squeeze)
+  G4double sqrtMean = std::sqrt( aMean );
+  G4double logMean = std::log( aMean );
+  G4double b = 0.931 + 2.53 * sqrtMean;
+  G4double a = -0.059 + 0.02483 * b;
+  G4double logInvAlpha = std::log( 1.1239 + 1.1328 / ( b - 3.4 ) );
+  G4double vr = 0.9277 - 3.6224 / ( b - 2. );
+  while ( true ) {
+    G4double u = fRandomEngine->flat() - 0.5;
+    G4double v = fRandomEngine->flat();
+    G4double us = 0.5 - std::abs( u );
+    G4long k = G4long( std::floor( ( 2. * a / us + b ) * u + aMean + 0.43 ) );
+    if ( us >= 0.07  &&  v <= vr ) return k;
+    if ( k < 0  ||  ( us < 0.013  &&  v > us ) ) continue;
+    G4double logFactorial = k < fLogFactorialTableSize ? 
+                            fLogFactorial[k] : std::lgamma( k + 1. );
+    if ( std::log( v ) + logInvAlpha - std::log( a / ( us * us ) + b ) 
+         <= -aMean + k * logMean - logFactorial ) {
+      return k;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
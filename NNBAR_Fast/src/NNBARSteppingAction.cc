@@ -0,0 +1,59 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARSteppingAction.cc
+/// \brief Implementation of the NNBARSteppingAction class
+
+#include "NNBARSteppingAction.hh"
+#include "NNBARRegionTimer.hh"
+#include "NNBARProcessTimer.hh"
+#include "NNBARFullSimScorer.hh"
+
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARSteppingAction::NNBARSteppingAction() : G4UserSteppingAction() {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARSteppingAction::~NNBARSteppingAction() {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARSteppingAction::UserSteppingAction( const G4Step* aStep ) {
+  if ( NNBARRegionTimer::IsEnabled() ) {
+    NNBARRegionTimer::Instance()->Stamp( 
+      aStep->GetPreStepPoint()->GetPhysicalVolume()->GetLogicalVolume()->GetRegion() );
+  }
+  if ( NNBARProcessTimer::IsEnabled() ) NNBARProcessTimer::CountStep();
+  if ( NNBARFullSimScorer::IsEnabled() ) NNBARFullSimScorer::Instance()->AddStep( aStep );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,289 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARSurrogateModel.cc
+/// \brief Implementation of the NNBARSurrogateModel class
+
+#include "NNBARSurrogateModel.hh"
+#include "NNBARSmearer.hh"
+#include "NNBARLogger.hh"
+
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+
+namespace {
+  /// The surrogate models of the thread, flushed at the end of each event.
+  G4ThreadLocal std::vector< NNBARSurrogateModel* >* surrogateModels = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARSurrogateModel::NNBARSurrogateModel( NNBAROutput::SaveType aSaveType, G4int aHistogram ) :
+  fSaveType( aSaveType ), fHistogram( aHistogram ), fFeatureMean(), fFeatureStd(),
+  fLayers(), fEntries(), fInputBuffer(), fOutputBuffer() {
+  if ( ! surrogateModels ) surrogateModels = new std::vector< NNBARSurrogateModel* >;
+  surrogateModels->push_back( this );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARSurrogateModel::~NNBARSurrogateModel() {
+  surrogateModels->erase( std::remove( surrogateModels->begin(), surrogateModels->end(), this ),
+                          surrogateModels->end() );
+  if ( surrogateModels->empty() ) {
+    delete surrogateModels;
+    surrogateModels = nullptr;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool NNBARSurrogateModel::Load( const G4String& aFileName ) {
+  fLayers.clear();
+  std::ifstream file( aFileName );
+  G4String word;
+  G4int version = 0;
+  G4int features = 0;
+  file >> word >> version;
+  G4bool valid = file  &&  word == "NNBARMLP"  &&  version == 1;
+  if ( valid ) {
+    file >> word >> features;
+    valid = file  &&  word == "features"  &&  features == kNumberOfFeatures;
+  }
+  if ( valid ) {
+    fFeatureMean.resize( features );
+    fFeatureStd.resize( features );
+    file >> word;
+    valid = word == "normalisation";
+    for ( G4int i = 0; i < features; i++ ) file >> fFeatureMean[i];
+    for ( G4int i = 0; i < features; i++ ) {
+      file >> fFeatureStd[i];
+      valid = valid  &&  fFeatureStd[i] > 0;
+    }
+    valid = valid  &&  file;
+  }
+  G4int numberOfLayers = 0;
+  if ( valid ) {
+    file >> word >> numberOfLayers;
+    valid = file  &&  word == "layers"  &&  numberOfLayers > 0;
+  }
+  std::vector< Layer > layers;
+  G4int width = features;
+  G4int maxWidth = features;
+  for ( G4int l = 0; valid  &&  l < numberOfLayers; l++ ) {
+    Layer layer;
+    G4String activation;
+    file >> layer.fInputs >> layer.fOutputs >> activation;
+    valid = file  &&  layer.fInputs == width  &&  layer.fOutputs > 0;
+    if ( activation == "relu" ) layer.fActivation = eReLU;
+    else if ( activation == "tanh" ) layer.fActivation = eTanh;
+    else if ( activation == "linear" ) layer.fActivation = eLinear;
+    else valid = false;
+    if ( ! valid ) break;
+    layer.fWeights.resize( std::size_t( layer.fInputs ) * layer.fOutputs );
+    layer.fBiases.resize( layer.fOutputs );
+    for ( auto& weight : layer.fWeights ) file >> weight;
+    for ( auto& bias : layer.fBiases ) file >> bias;
+    valid = bool( file );
+    width = layer.fOutputs;
+    maxWidth = std::max( maxWidth, width );
+    layers.push_back( std::move( layer ) );
+  }
+  valid = valid  &&  ( width == 2  ||  width == 3 );
+  if ( ! valid ) {
+    G4ExceptionDescription msg;
+    msg << "The file " << aFileName << " is not a valid surrogate network.";
+    G4Exception( "NNBARSurrogateModel::Load()", "NNBAR002", JustWarning, msg );
+    return false;
+  }
+  fLayers = std::move( layers );
+  fInputBuffer.assign( kBatchSize * maxWidth, 0.f );
+  fOutputBuffer.assign( kBatchSize * maxWidth, 0.f );
+  NNBAR_INFO( NNBARLogger::eGeneral, "Surrogate network " << aFileName << " loaded ("
+              << fLayers.size() << " layers)" );
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARSurrogateModel::Add( G4int aPDG, G4double aKenergy, G4double aCosTheta, 
+                               const G4ThreeVector& aPosition, G4int aRow ) {
+  fEntries.push_back( { aPDG, aKenergy, aCosTheta, aPosition, aRow } );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARSurrogateModel::FillFeatures( const Entry& aEntry, float* aFeatures, 
+                                        std::size_t aStride ) const {
+  G4double features[kNumberOfFeatures] = { 0 };
+  G4int particleClass;
+  switch ( std::abs( aEntry.fPDG ) ) {
+    case 22 : particleClass = 0; break;
+    case 11 : particleClass = 1; break;
+    case 13 : particleClass = 2; break;
+    default : {
+      G4int species = NNBARDetectorParametrisation::GetHadronSpecies( aEntry.fPDG );
+      particleClass = species >= 0 ? 3 + species : 3 + NNBARDetectorParametrisation::eNumberOfHadronSpecies;
+    }
+  }
+  features[particleClass] = 1.;
+  features[9] = std::log10( std::max( aEntry.fKenergy / MeV, 1e-3 ) );
+  features[10] = aEntry.fCosTheta;
+  features[11] = aEntry.fPosition.x() / m;
+  features[12] = aEntry.fPosition.y() / m;
+  features[13] = aEntry.fPosition.z() / m;
+  for ( G4int j = 0; j < kNumberOfFeatures; j++ ) {
+    aFeatures[j * aStride] = float( ( features[j] - fFeatureMean[j] ) / fFeatureStd[j] );
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARSurrogateModel::Evaluate( std::size_t aEntries ) {
+  for ( const Layer& layer : fLayers ) {
+    const float* in = fInputBuffer.data();
+    float* out = fOutputBuffer.data();
+    for ( G4int o = 0; o < layer.fOutputs; o++ ) {
+      float* y = out + o * aEntries;
+      const float bias = layer.fBiases[o];
+      for ( std::size_t k = 0; k < aEntries; k++ ) y[k] = bias;
+      const float* weights = layer.fWeights.data() + std::size_t( o ) * layer.fInputs;
+      for ( G4int i = 0; i < layer.fInputs; i++ ) {
+        const float weight = weights[i];
+        const float* x = in + i * aEntries;
+        for ( std::size_t k = 0; k < aEntries; k++ ) y[k] += weight * x[k];
+      }
+      if ( layer.fActivation == eReLU ) {
+        for ( std::size_t k = 0; k < aEntries; k++ ) y[k] = std::max( y[k], 0.f );
+      } else if ( layer.fActivation == eTanh ) {
+        for ( std::size_t k = 0; k < aEntries; k++ ) y[k] = std::tanh( y[k] );
+      }
+    }
+    // The outputs are the inputs of the next layer
+    fInputBuffer.swap( fOutputBuffer );
+  }
+  fInputBuffer.swap( fOutputBuffer );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARSurrogateModel::Flush() {
+  if ( ! IsLoaded() ) {
+    fEntries.clear();
+    return;
+  }
+  NNBAROutput* output = NNBAROutput::Instance();
+  const G4bool hasEfficiency = fLayers.back().fOutputs > 2;
+  for ( std::size_t first = 0; first < fEntries.size(); first += kBatchSize ) {
+    std::size_t n = std::min( kBatchSize, fEntries.size() - first );
+    for ( std::size_t k = 0; k < n; k++ ) {
+      FillFeatures( fEntries[first + k], fInputBuffer.data() + k, n );
+    }
+    Evaluate( n );
+    for ( std::size_t k = 0; k < n; k++ ) {
+      const Entry& entry = fEntries[first + k];
+      G4double med = fOutputBuffer[k];
+      G4double res = std::exp( fOutputBuffer[n + k] );
+      G4double eff = hasEfficiency ? 1. / ( 1. + std::exp( -fOutputBuffer[2 * n + k] ) ) : 1.;
+      G4double Esm = 0.0;
+      if ( med > 0  &&  G4UniformRand() < eff ) {
+        Esm = std::abs( NNBARSmearer::Instance()->SmearEnergy( nullptr, res, med, entry.fKenergy ) );
+        output->FillHistogram( fHistogram, Esm / entry.fKenergy );
+      }
+      NNBAR_TRACE( NNBARLogger::eGeneral, "surrogate response of " << entry.fPDG << ": median " 
+                   << med << ", resolution " << res << ", efficiency " << eff );
+      output->SetCalorimeterResponse( fSaveType, entry.fRow, res, eff, Esm/MeV );
+    }
+  }
+  fEntries.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARSurrogateModel::FlushAll() {
+  if ( ! surrogateModels ) return;
+  for ( auto model : *surrogateModels ) model->Flush();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARSurrogateModel::Benchmark( NNBARDetectorParametrisation* aParametrisation,
+                                     NNBARDetectorParametrisation::Detector aDetector,
+                                     G4int aEntries ) {
+  // Random entries on the +x face: 10 MeV - 2 GeV, cos(theta) 0.1 - 1
+  std::vector< G4int > species = aDetector == NNBARDetectorParametrisation::eEMCAL ?
+    std::vector< G4int >{ 22, 11, -11 } : std::vector< G4int >{ 2212, 2112, 211, -211, 321, 130 };
+  std::vector< Entry > entries( aEntries );
+  for ( auto& entry : entries ) {
+    entry.fPDG = species[ G4int( G4UniformRand() * species.size() ) % species.size() ];
+    entry.fKenergy = 10. * MeV * std::pow( 200., G4UniformRand() );
+    entry.fCosTheta = 0.1 + 0.9 * G4UniformRand();
+    entry.fPosition = G4ThreeVector( 2.3 * m, ( 2. * G4UniformRand() - 1. ) * 2.3 * m,
+                                     ( 2. * G4UniformRand() - 1. ) * 3. * m );
+    entry.fRow = -1;
+  }
+
+  // The sum of the results keeps the compiler from skipping the evaluation
+  G4double sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for ( const auto& entry : entries ) {
+    sum += aParametrisation->GetResolution( aDetector, NNBARDetectorParametrisation::eNNBAR,
+                                            entry.fKenergy, entry.fPDG, entry.fCosTheta )
+         + aParametrisation->GetMedian( aDetector, NNBARDetectorParametrisation::eNNBAR,
+                                        entry.fKenergy, entry.fPDG, entry.fCosTheta )
+         + aParametrisation->GetEfficiency( aDetector, NNBARDetectorParametrisation::eNNBAR,
+                                            entry.fKenergy, entry.fPDG, entry.fCosTheta );
+  }
+  G4double tableTime = std::chrono::duration< G4double, std::nano >( 
+    std::chrono::steady_clock::now() - start ).count();
+  G4cout << "Tables:    " << tableTime / aEntries << " ns per entry" << G4endl;
+  if ( ! IsLoaded() ) {
+    G4cout << "Surrogate: no network loaded" << G4endl;
+    return;
+  }
+
+  start = std::chrono::steady_clock::now();
+  for ( std::size_t first = 0; first < entries.size(); first += kBatchSize ) {
+    std::size_t n = std::min( kBatchSize, entries.size() - first );
+    for ( std::size_t k = 0; k < n; k++ ) {
+      FillFeatures( entries[first + k], fInputBuffer.data() + k, n );
+    }
+    Evaluate( n );
+    sum += fOutputBuffer[0];
+  }
+  G4double networkTime = std::chrono::duration< G4double, std::nano >( 
+    std::chrono::steady_clock::now() - start ).count();
+  G4cout << "Surrogate: " << networkTime / aEntries << " ns per entry (batches of " 
+         << kBatchSize << "), " << networkTime / tableTime << " x the tables" 
+         << " [checksum " << sum << "]" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
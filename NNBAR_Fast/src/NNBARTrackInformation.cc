@@ -0,0 +1,61 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARTrackInformation.cc
+/// \brief Implementation of the NNBARTrackInformation class
+
+#include "NNBARTrackInformation.hh"
+#include "NNBARPrimaryParticleInformation.hh"
+#include "G4PrimaryParticle.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARTrackInformation::NNBARTrackInformation( G4int aPrimaryIndex ) : 
+  G4VUserTrackInformation(), fPrimaryIndex( aPrimaryIndex ) {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARTrackInformation::~NNBARTrackInformation() {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARTrackInformation::Print() const {
+  G4cout << "primary " << fPrimaryIndex << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int NNBARTrackInformation::GetPrimaryIndex( const G4Track* aTrack ) {
+  auto info = static_cast< const NNBARTrackInformation* >( aTrack->GetUserInformation() );
+  if ( info ) return info->fPrimaryIndex;
+  // A primary before its information is attached
+  const G4PrimaryParticle* primary = aTrack->GetDynamicParticle()->GetPrimaryParticle();
+  if ( aTrack->GetParentID() == 0  &&  primary  &&  primary->GetUserInformation() ) {
+    return static_cast< const NNBARPrimaryParticleInformation* >( 
+      primary->GetUserInformation() )->GetPartID();
+  }
+  return -1;
+}
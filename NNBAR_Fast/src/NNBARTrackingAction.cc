@@ -30,7 +30,9 @@
 #include "NNBARTrackingAction.hh"
 #include "NNBAREventInformation.hh"
 #include "NNBARPrimaryParticleInformation.hh"
+#include "NNBARTrackInformation.hh"
 #include "NNBAROutput.hh"
+#include "NNBARRegionTimer.hh"
 
 #include "G4ThreeVector.hh"
 #include "G4EventManager.hh"
@@ -53,13 +55,23 @@ NNBARTrackingAction::~NNBARTrackingAction() {}
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void NNBARTrackingAction::PreUserTrackingAction( const G4Track* aTrack ) {
+  if ( NNBARRegionTimer::IsEnabled() ) NNBARRegionTimer::Instance()->StartTrack();
+
+  // The primaries carry their index, passed on to the secondaries
+  if ( ! aTrack->GetUserInformation() ) {
+    aTrack->SetUserInformation( 
+      new NNBARTrackInformation( NNBARTrackInformation::GetPrimaryIndex( aTrack ) ) );
+  }
+
   // Kill the tracks that have a small transverse momentum or that are not
   // in the central region.
 //  if ( aTrack->GetMomentum().perp() < 1.0*MeV  ||
 //       std::abs( aTrack->GetMomentum().pseudoRapidity() ) > 5.5 ) {
 //    ( (G4Track*) aTrack )->SetTrackStatus( fStopAndKill );
 //  }
-  if ( aTrack->GetMomentum().perp() < 1.0*MeV )
+  // The cut is on the total momentum: a cut on the transverse momentum would
+  // also kill energetic particles emitted along the beam axis
+  if ( aTrack->GetMomentum().mag() < 1.0*MeV )
  {
      ( (G4Track*) aTrack )->SetTrackStatus( fStopAndKill );
   }
@@ -69,6 +81,16 @@ void NNBARTrackingAction::PreUserTrackingAction( const G4Track* aTrack ) {
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void NNBARTrackingAction::PostUserTrackingAction( const G4Track* aTrack ) {
+  G4TrackVector* secondaries = fpTrackingManager->GimmeSecondaries();
+  if ( secondaries  &&  ! secondaries->empty() ) {
+    G4int primary = NNBARTrackInformation::GetPrimaryIndex( aTrack );
+    for ( G4Track* secondary : *secondaries ) {
+      if ( ! secondary->GetUserInformation() ) {
+        secondary->SetUserInformation( new NNBARTrackInformation( primary ) );
+      }
+    }
+  }
+
   if ( aTrack->GetTrackStatus() == fStopAndKill  &&  aTrack->GetParentID() == 0 ) {
     NNBARPrimaryParticleInformation* info = (NNBARPrimaryParticleInformation*) 
        aTrack->GetDynamicParticle()->GetPrimaryParticle()->GetUserInformation();
@@ -0,0 +1,136 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARTriggerPolicy.cc
+/// \brief Implementation of the NNBARTriggerPolicy class
+
+#include "NNBARTriggerPolicy.hh"
+#include "NNBARTriggerPolicyMessenger.hh"
+#include "NNBARLogger.hh"
+#include "NNBARTrackInformation.hh"
+
+#include "G4ParticleTable.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4FastTrack.hh"
+#include "G4FastStep.hh"
+#include "G4Track.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4UnitsTable.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARTriggerPolicy::NNBARTriggerPolicy( const G4String& aDirectory ) :
+  fThreshold( 0 ), fDirectDeposit( false ), fSpeciesRules(), fCompiledRules(),
+  fNeedsCompilation( true ), fLastDefinition( nullptr ), fLastRule{ 0, false },
+  fMessenger( nullptr ) {
+  fMessenger = new NNBARTriggerPolicyMessenger( this, aDirectory );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARTriggerPolicy::~NNBARTriggerPolicy() {
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARTriggerPolicy::DepositDirectly( const G4FastTrack& aFastTrack, G4FastStep& aFastStep,
+                                          NNBAROutput::SaveType aWhatToSave ) {
+  const G4Track* track = aFastTrack.GetPrimaryTrack();
+  G4double KE = track->GetKineticEnergy();
+  aFastStep.KillPrimaryTrack();
+  aFastStep.ProposePrimaryTrackPathLength( 0.0 );
+  aFastStep.ProposeTotalEnergyDeposited( KE );
+  if ( aWhatToSave == NNBAROutput::eNoSave ) return;
+  NNBAROutput::Instance()->SaveTrack( aWhatToSave, track->GetTrackID(), 
+                                      track->GetDefinition()->GetPDGEncoding(), KE/MeV, 
+                                      track->GetPosition()/mm, 0, 1, KE/MeV, 
+                                      track->GetGlobalTime()/ns, 0, 0, -1, 0, track->GetParentID(),
+                                      NNBARTrackInformation::GetPrimaryIndex( track ) );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARTriggerPolicy::SetThreshold( G4double aThreshold ) {
+  fThreshold = aThreshold;
+  fNeedsCompilation = true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARTriggerPolicy::SetSpeciesThreshold( G4int aPDG, G4double aThreshold ) {
+  fSpeciesRules[aPDG] = { aThreshold, false };
+  fNeedsCompilation = true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARTriggerPolicy::ExcludeSpecies( G4int aPDG ) {
+  fSpeciesRules[aPDG] = { 0, true };
+  fNeedsCompilation = true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARTriggerPolicy::ClearSpeciesRules() {
+  fSpeciesRules.clear();
+  fNeedsCompilation = true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARTriggerPolicy::Compile() {
+  fCompiledRules.clear();
+  G4ParticleTable* particleTable = G4ParticleTable::GetParticleTable();
+  for ( const auto& rule : fSpeciesRules ) {
+    const G4ParticleDefinition* definition = particleTable->FindParticle( rule.first );
+    if ( ! definition ) {
+      NNBAR_WARNING( NNBARLogger::eGeneral, "trigger rule for unknown PDG code " 
+                     << rule.first << " ignored" );
+      continue;
+    }
+    fCompiledRules[definition] = rule.second;
+  }
+  fLastDefinition = nullptr;
+  fNeedsCompilation = false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARTriggerPolicy::Print() const {
+  G4cout << "Trigger threshold: " << G4BestUnit( fThreshold, "Energy" ) 
+         << ( fDirectDeposit ? " (direct deposit below)" : " (tracking below)" ) << G4endl;
+  for ( const auto& rule : fSpeciesRules ) {
+    G4cout << "  PDG " << rule.first << ": ";
+    if ( rule.second.fExcluded ) {
+      G4cout << "excluded (tracked)" << G4endl;
+    } else {
+      G4cout << G4BestUnit( rule.second.fThreshold, "Energy" ) << G4endl;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
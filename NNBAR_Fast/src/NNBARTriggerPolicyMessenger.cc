@@ -0,0 +1,130 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NNBARTriggerPolicyMessenger.cc
+/// \brief Implementation of the NNBARTriggerPolicyMessenger class
+
+#include "NNBARTriggerPolicyMessenger.hh"
+#include "NNBARTriggerPolicy.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARTriggerPolicyMessenger::NNBARTriggerPolicyMessenger( NNBARTriggerPolicy* aPolicy,
+                                                          const G4String& aDirectory )
+  : G4UImessenger(), fPolicy( aPolicy ) {
+  fDirectory = new G4UIdirectory( aDirectory );
+  fDirectory->SetGuidance( "Kinematic trigger of the fast simulation model." );
+
+  fThresholdCmd = new G4UIcmdWithADoubleAndUnit( ( aDirectory + "threshold" ).c_str(), this );
+  fThresholdCmd->SetGuidance( "Kinetic energy above which particles are parametrised" );
+  fThresholdCmd->SetGuidance( "(species without their own rule)." );
+  fThresholdCmd->SetParameterName( "threshold", false );
+  fThresholdCmd->SetRange( "threshold >= 0" );
+  fThresholdCmd->SetDefaultUnit( "MeV" );
+  fThresholdCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fSpeciesCmd = new G4UIcommand( ( aDirectory + "species" ).c_str(), this );
+  fSpeciesCmd->SetGuidance( "Kinetic energy threshold of one species (PDG code)." );
+  fSpeciesCmd->SetGuidance( "Antiparticles need their own rule." );
+  auto pdgParameter = new G4UIparameter( "pdg", 'i', false );
+  fSpeciesCmd->SetParameter( pdgParameter );
+  auto thresholdParameter = new G4UIparameter( "threshold", 'd', false );
+  thresholdParameter->SetParameterRange( "threshold >= 0" );
+  fSpeciesCmd->SetParameter( thresholdParameter );
+  auto unitParameter = new G4UIparameter( "unit", 's', true );
+  unitParameter->SetDefaultUnit( "MeV" );
+  fSpeciesCmd->SetParameter( unitParameter );
+  fSpeciesCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fExcludeCmd = new G4UIcmdWithAnInteger( ( aDirectory + "exclude" ).c_str(), this );
+  fExcludeCmd->SetGuidance( "Never parametrise one species (PDG code): it is always tracked," );
+  fExcludeCmd->SetGuidance( "also in the direct deposit mode." );
+  fExcludeCmd->SetParameterName( "pdg", false );
+  fExcludeCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fClearSpeciesCmd = new G4UIcmdWithoutParameter( ( aDirectory + "clearSpecies" ).c_str(), this );
+  fClearSpeciesCmd->SetGuidance( "Remove all the per-species rules." );
+  fClearSpeciesCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fDirectDepositCmd = new G4UIcmdWithABool( ( aDirectory + "directDeposit" ).c_str(), this );
+  fDirectDepositCmd->SetGuidance( "Particles below the threshold deposit their kinetic energy" );
+  fDirectDepositCmd->SetGuidance( "on the spot instead of being tracked (no parametrisation)." );
+  fDirectDepositCmd->SetGuidance( "In the calorimeters the unsmeared kinetic energy is saved as a" );
+  fDirectDepositCmd->SetGuidance( "row of the EMCAL or HCAL ntuple; in the tracker it is not saved." );
+  fDirectDepositCmd->SetParameterName( "direct", true );
+  fDirectDepositCmd->SetDefaultValue( true );
+  fDirectDepositCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+
+  fPrintCmd = new G4UIcmdWithoutParameter( ( aDirectory + "print" ).c_str(), this );
+  fPrintCmd->SetGuidance( "Print the trigger rules." );
+  fPrintCmd->AvailableForStates( G4State_PreInit, G4State_Idle );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NNBARTriggerPolicyMessenger::~NNBARTriggerPolicyMessenger() {
+  delete fPrintCmd;
+  delete fDirectDepositCmd;
+  delete fClearSpeciesCmd;
+  delete fExcludeCmd;
+  delete fSpeciesCmd;
+  delete fThresholdCmd;
+  delete fDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NNBARTriggerPolicyMessenger::SetNewValue( G4UIcommand* aCommand, G4String aNewValue ) {
+  if ( aCommand == fThresholdCmd ) {
+    fPolicy->SetThreshold( fThresholdCmd->GetNewDoubleValue( aNewValue ) );
+  } else if ( aCommand == fSpeciesCmd ) {
+    G4int pdg = 0;
+    G4double threshold = 0;
+    G4String unit = "MeV";
+    std::istringstream is( aNewValue );
+    is >> pdg >> threshold >> unit;
+    fPolicy->SetSpeciesThreshold( pdg, threshold * G4UIcommand::ValueOf( unit.c_str() ) );
+  } else if ( aCommand == fExcludeCmd ) {
+    fPolicy->ExcludeSpecies( fExcludeCmd->GetNewIntValue( aNewValue ) );
+  } else if ( aCommand == fClearSpeciesCmd ) {
+    fPolicy->ClearSpeciesRules();
+  } else if ( aCommand == fDirectDepositCmd ) {
+    fPolicy->SetDirectDeposit( fDirectDepositCmd->GetNewBoolValue( aNewValue ) );
+  } else if ( aCommand == fPrintCmd ) {
+    fPolicy->Print();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......